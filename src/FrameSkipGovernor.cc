@@ -0,0 +1,118 @@
+#include "FrameSkipGovernor.hh"
+#include "TclObject.hh"
+#include "outer.hh"
+#include <algorithm>
+#include <cmath>
+
+using std::string;
+using std::vector;
+
+namespace openmsx {
+
+// Aim to use at most this fraction of the budget, leaves some room for
+// measurement noise and for catching up after a hiccup.
+static const double TARGET = 0.95;
+// Only lower the amount of frameskip when the result would still fit in a
+// somewhat lower target, avoids toggling between two values.
+static const double HYSTERESIS = 0.9;
+static const double ALPHA = 0.1; // weight of a new sample in the averages
+static const unsigned MAX_FRAMESKIP = 100; // same as the max of maxframeskip
+
+FrameSkipGovernor::FrameSkipGovernor(InfoCommand& machineInfoCommand)
+	: frameSkipInfo(machineInfoCommand)
+	, drawCost(0.0), skipCost(0.0), budget(0.0)
+	, frameSkip(0)
+	, haveDrawCost(false), haveSkipCost(false)
+{
+	std::fill(std::begin(drawHistogram), std::end(drawHistogram), 0);
+	std::fill(std::begin(skipHistogram), std::end(skipHistogram), 0);
+}
+
+void FrameSkipGovernor::frame(uint64_t cost, uint64_t budget_, bool drawn)
+{
+	auto bucket = std::min<uint64_t>(cost / 1000, NUM_BUCKETS - 1);
+	if (drawn) {
+		++drawHistogram[bucket];
+		drawCost = haveDrawCost ? (drawCost * (1 - ALPHA) + cost * ALPHA)
+		                        : cost;
+		haveDrawCost = true;
+	} else {
+		++skipHistogram[bucket];
+		skipCost = haveSkipCost ? (skipCost * (1 - ALPHA) + cost * ALPHA)
+		                        : cost;
+		haveSkipCost = true;
+	}
+	// Normally constant, but the emulated time between two reported frames
+	// varies a bit.
+	budget = (budget == 0.0) ? budget_ : (budget * (1 - ALPHA) + budget_ * ALPHA);
+	if (!haveDrawCost) return;
+
+	unsigned newFrameSkip = calcFrameSkip(budget * TARGET);
+	if (newFrameSkip < frameSkip) {
+		newFrameSkip = std::min(frameSkip,
+			calcFrameSkip(budget * TARGET * HYSTERESIS));
+	}
+	frameSkip = newFrameSkip;
+}
+
+unsigned FrameSkipGovernor::calcFrameSkip(double target) const
+{
+	if (drawCost <= target) return 0;
+	// As long as no frame was skipped yet, optimistically assume skipping
+	// is free. The first skipped frame will correct this.
+	double skip = haveSkipCost ? skipCost : 0.0;
+	if (skip >= target) return MAX_FRAMESKIP;
+	// smallest n for which: (drawCost + n * skip) / (n + 1) <= target
+	double n = std::ceil((drawCost - target) / (target - skip));
+	return unsigned(std::min(n, double(MAX_FRAMESKIP)));
+}
+
+
+// class FrameSkipInfo
+
+FrameSkipGovernor::FrameSkipInfo::FrameSkipInfo(InfoCommand& machineInfoCommand)
+	: InfoTopic(machineInfoCommand, "frameskip")
+{
+}
+
+void FrameSkipGovernor::FrameSkipInfo::execute(
+	array_ref<TclObject> /*tokens*/, TclObject& result) const
+{
+	auto& governor = OUTER(FrameSkipGovernor, frameSkipInfo);
+	result.addListElement("frameskip");
+	result.addListElement(int(governor.frameSkip));
+	result.addListElement("budget");
+	result.addListElement(int(governor.budget));
+	result.addListElement("draw_cost");
+	result.addListElement(int(governor.drawCost));
+	result.addListElement("skip_cost");
+	result.addListElement(int(governor.skipCost));
+	TclObject drawHist, skipHist;
+	for (auto count : governor.drawHistogram) {
+		drawHist.addListElement(int(count));
+	}
+	for (auto count : governor.skipHistogram) {
+		skipHist.addListElement(int(count));
+	}
+	result.addListElement("draw_histogram");
+	result.addListElement(drawHist);
+	result.addListElement("skip_histogram");
+	result.addListElement(skipHist);
+}
+
+string FrameSkipGovernor::FrameSkipInfo::help(const vector<string>& /*tokens*/) const
+{
+	return "Shows the state of the automatic frameskip. The result is a "
+	       "dictionary with:\n"
+	       "  frameskip       number of frames skipped after each drawn "
+	       "frame (still limited by the minframeskip and maxframeskip "
+	       "settings)\n"
+	       "  budget          real time (in us) an emulated frame may take\n"
+	       "  draw_cost       average host time (in us) of a drawn frame\n"
+	       "  skip_cost       average host time (in us) of a skipped frame\n"
+	       "  draw_histogram  number of drawn frames per 1ms cost interval "
+	       "(the last interval also counts all slower frames)\n"
+	       "  skip_histogram  same for skipped frames\n";
+}
+
+} // namespace openmsx
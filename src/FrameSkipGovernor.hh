@@ -0,0 +1,64 @@
+#ifndef FRAMESKIPGOVERNOR_HH
+#define FRAMESKIPGOVERNOR_HH
+
+#include "InfoTopic.hh"
+#include <cstdint>
+
+namespace openmsx {
+
+class InfoCommand;
+
+/** Decides how many frames the renderers should skip to keep emulating at
+  * the requested speed.
+  *
+  * For each emulated frame it gets the host time spent on that frame
+  * (emulation, and for drawn frames also rendering and presenting, but
+  * excluding the time RealTime slept) and the real time that frame may
+  * take at the current speed (the budget). It keeps a running average of
+  * the cost of drawn and of skipped frames and picks the smallest number
+  * of frames to skip between two drawn frames so that the average cost
+  * fits in the budget. Only drawing is skipped, emulation of the skipped
+  * frames (including the VDP) still happens completely.
+  *
+  * The renderers still respect the minframeskip and maxframeskip settings.
+  */
+class FrameSkipGovernor
+{
+public:
+	explicit FrameSkipGovernor(InfoCommand& machineInfoCommand);
+
+	/** Report a finished frame.
+	  * @param cost Host time spent on this frame (in us).
+	  * @param budget Real time this frame may take (in us).
+	  * @param drawn Was this frame drawn or skipped.
+	  */
+	void frame(uint64_t cost, uint64_t budget, bool drawn);
+
+	/** Number of frames to skip after each drawn frame. */
+	unsigned getFrameSkip() const { return frameSkip; }
+
+private:
+	unsigned calcFrameSkip(double target) const;
+
+	struct FrameSkipInfo final : InfoTopic {
+		explicit FrameSkipInfo(InfoCommand& machineInfoCommand);
+		void execute(array_ref<TclObject> tokens,
+		             TclObject& result) const override;
+		std::string help(const std::vector<std::string>& tokens) const override;
+	} frameSkipInfo;
+
+	static const unsigned NUM_BUCKETS = 50; // 1ms per bucket
+	uint32_t drawHistogram[NUM_BUCKETS];
+	uint32_t skipHistogram[NUM_BUCKETS];
+
+	double drawCost; // average, in us
+	double skipCost;
+	double budget;
+	unsigned frameSkip;
+	bool haveDrawCost;
+	bool haveSkipCost;
+};
+
+} // namespace openmsx
+
+#endif
@@ -43,6 +43,10 @@ GlobalSettings::GlobalSettings(GlobalCommandController& commandController_)
 			{"hq",   ResampledSoundDevice::RESAMPLE_HQ},
 			{"fast", ResampledSoundDevice::RESAMPLE_LQ},
 			{"blip", ResampledSoundDevice::RESAMPLE_BLIP}})
+	, saveStateFormatSetting(commandController, "savestate_format",
+		"file format for savestates and replays: compressed XML or a "
+		"binary format that's faster to save and load",
+		false, EnumSetting<bool>::Map{{"xml", false}, {"binary", true}})
 	, throttleManager(commandController)
 {
 	for (auto i : xrange(SDL_NumJoysticks())) {
@@ -28,6 +28,16 @@ public:
 		}
 	}
 
+	/** Time (in us) until the first RTSchedulable expires, or
+	  * uint64_t(-1) when there's none. */
+	uint64_t getTimeTillNext() const
+	{
+		if (queue.empty()) return uint64_t(-1);
+		auto now = Timer::getTime();
+		auto next = queue.front().time;
+		return (next > now) ? (next - now) : 0;
+	}
+
 private:
 	// These are called by RTSchedulable
 	friend class RTSchedulable;
@@ -9,6 +9,7 @@
 #include "DiskManipulator.hh"
 #include "DiskChanger.hh"
 #include "FilePool.hh"
+#include "RomStore.hh"
 #include "UserSettings.hh"
 #include "RomDatabase.hh"
 #include "TclCallbackMessages.hh"
@@ -23,6 +24,7 @@
 #include "Display.hh"
 #include "Mixer.hh"
 #include "AviRecorder.hh"
+#include "SharedMemoryExporter.hh"
 #include "GlobalSettings.hh"
 #include "BooleanSetting.hh"
 #include "EnumSetting.hh"
@@ -204,6 +206,7 @@ void Reactor::init()
 	virtualDrive = make_unique<DiskChanger>(
 		*this, "virtual_drive");
 	filePool = make_unique<FilePool>(*globalCommandController, *this);
+	romStore = make_unique<RomStore>();
 	userSettings = make_unique<UserSettings>(
 		*globalCommandController);
 	softwareDatabase = make_unique<RomDatabase>(
@@ -231,6 +234,7 @@ void Reactor::init()
 	restoreMachineCommand = make_unique<RestoreMachineCommand>(
 		*globalCommandController, *this);
 	aviRecordCommand = make_unique<AviRecorder>(*this);
+	shmExporter = make_unique<SharedMemoryExporter>(*this);
 	extensionInfo = make_unique<ConfigInfo>(
 		getOpenMSXInfoCommand(), "extensions");
 	machineInfo   = make_unique<ConfigInfo>(
@@ -531,13 +535,9 @@ void Reactor::run(CommandLineParser& parser)
 		bool blocked = (blockedCounter > 0) || !activeBoard;
 		if (!blocked) blocked = !activeBoard->execute();
 		if (blocked) {
-			// At first sight a better alternative is to use the
-			// SDL_WaitEvent() function. Though when inspecting
-			// the implementation of that function, it turns out
-			// to also use a sleep/poll loop, with even shorter
-			// sleep periods as we use here. Maybe in future
-			// SDL implementations this will be improved.
-			eventDistributor->sleep(20 * 1000);
+			// Note: SDL_WaitEvent() is not an alternative, it's
+			// implemented as a sleep/poll loop.
+			eventDistributor->waitForWork();
 		}
 	}
 }
@@ -890,7 +890,8 @@ void StoreMachineCommand::execute(array_ref<TclObject> tokens, TclObject& result
 
 	auto& board = reactor.getMachine(machineID);
 
-	XmlOutputArchive out(filename);
+	XmlOutputArchive out(filename, reactor.getGlobalSettings()
+		.getSaveStateFormatSetting().getEnum());
 	out.serialize("machine", board);
 	result.setString(filename);
 }
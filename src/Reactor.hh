@@ -28,6 +28,7 @@ class DiskFactory;
 class DiskManipulator;
 class DiskChanger;
 class FilePool;
+class RomStore;
 class UserSettings;
 class RomDatabase;
 class TclCallbackMessages;
@@ -46,6 +47,7 @@ class ActivateMachineCommand;
 class StoreMachineCommand;
 class RestoreMachineCommand;
 class AviRecorder;
+class SharedMemoryExporter;
 class ConfigInfo;
 class RealTimeInfo;
 template <typename T> class EnumSetting;
@@ -84,6 +86,7 @@ public:
 	EnumSetting<int>& getMachineSetting() { return *machineSetting; }
 	RomDatabase& getSoftwareDatabase() { return *softwareDatabase; }
 	FilePool& getFilePool() { return *filePool; }
+	RomStore& getRomStore() { return *romStore; }
 
 	void switchMachine(const std::string& machine);
 	MSXMotherBoard* getMotherBoard() const;
@@ -144,6 +147,7 @@ private:
 	std::unique_ptr<DiskManipulator> diskManipulator;
 	std::unique_ptr<DiskChanger> virtualDrive;
 	std::unique_ptr<FilePool> filePool;
+	std::unique_ptr<RomStore> romStore;
 
 	std::unique_ptr<EnumSetting<int>> machineSetting;
 	std::unique_ptr<UserSettings> userSettings;
@@ -161,6 +165,7 @@ private:
 	std::unique_ptr<StoreMachineCommand> storeMachineCommand;
 	std::unique_ptr<RestoreMachineCommand> restoreMachineCommand;
 	std::unique_ptr<AviRecorder> aviRecordCommand;
+	std::unique_ptr<SharedMemoryExporter> shmExporter;
 	std::unique_ptr<ConfigInfo> extensionInfo;
 	std::unique_ptr<ConfigInfo> machineInfo;
 	std::unique_ptr<RealTimeInfo> realTimeInfo;
@@ -17,6 +17,7 @@ namespace openmsx {
 const double   SYNC_INTERVAL = 0.08;  // s
 const int64_t  MAX_LAG       = 200000; // us
 const uint64_t ALLOWED_LAG   =  20000; // us
+const uint64_t MAX_FRAME_COST = 500000; // us, longer means paused or so
 
 RealTime::RealTime(
 		MSXMotherBoard& motherBoard_, GlobalSettings& globalSettings,
@@ -29,6 +30,11 @@ RealTime::RealTime(
 	, speedSetting   (globalSettings.getSpeedSetting())
 	, pauseSetting   (globalSettings.getPauseSetting())
 	, powerSetting   (globalSettings.getPowerSetting())
+	, frameSkipGovernor(motherBoard.getMachineInfoCommand())
+	, totalSleep(0)
+	, prevFrameRealTime(0)
+	, prevFrameSleep(0)
+	, prevFrameEmuTime(EmuTime::zero)
 	, emuTime(EmuTime::zero)
 	, enabled(true)
 {
@@ -73,6 +79,11 @@ bool RealTime::timeLeft(uint64_t us, EmuTime::param time)
 	           (idealRealTime + realDuration + ALLOWED_LAG);
 }
 
+unsigned RealTime::getFrameSkip() const
+{
+	return throttleManager.isThrottled() ? frameSkipGovernor.getFrameSkip() : 0;
+}
+
 void RealTime::sync(EmuTime::param time, bool allowSleep)
 {
 	if (allowSleep) {
@@ -100,6 +111,7 @@ void RealTime::internalSync(EmuTime::param time, bool allowSleep)
 				Timer::sleep(sleep); // request to sleep for 'sleep+sleepAdjust'
 				int64_t slept = Timer::getTime() - currentRealTime;
 				delta = sleep - slept; // actually slept for 'slept' us
+				totalSleep += slept;
 			}
 			const double ALPHA = 0.2;
 			sleepAdjust = sleepAdjust * (1 - ALPHA) + delta * ALPHA;
@@ -130,17 +142,43 @@ int RealTime::signalEvent(const std::shared_ptr<const Event>& event)
 	}
 	if (event->getType() == OPENMSX_FINISH_FRAME_EVENT) {
 		auto& ffe = checked_cast<const FinishFrameEvent&>(*event);
+		if (ffe.isSkipped() &&
+		    (ffe.getSource() == ffe.getSelectedSource())) {
+			frameFinished(false);
+		}
 		if (!ffe.needRender()) {
 			// sync but don't sleep
 			sync(getCurrentTime(), false);
 		}
 	} else if (event->getType() == OPENMSX_FRAME_DRAWN_EVENT) {
+		frameFinished(true);
 		// sync and possibly sleep
 		sync(getCurrentTime(), true);
 	}
 	return 0;
 }
 
+void RealTime::frameFinished(bool drawn)
+{
+	// The host time between two finished frames, minus the time we slept,
+	// is the cost of emulating (and for drawn frames also rendering and
+	// presenting) a frame. For drawn frames this is called on the
+	// FrameDrawnEvent, so after the Display presented the frame.
+	auto now = Timer::getTime();
+	auto time = getCurrentTime();
+	if (prevFrameRealTime != 0) {
+		auto cost = (now - prevFrameRealTime) - (totalSleep - prevFrameSleep);
+		auto budget = static_cast<uint64_t>(
+			getRealDuration(prevFrameEmuTime, time) * 1000000ULL);
+		if ((cost < MAX_FRAME_COST) && (budget != 0)) {
+			frameSkipGovernor.frame(cost, budget, drawn);
+		}
+	}
+	prevFrameRealTime = now;
+	prevFrameSleep = totalSleep;
+	prevFrameEmuTime = time;
+}
+
 void RealTime::update(const Setting& /*setting*/)
 {
 	resync();
@@ -5,6 +5,7 @@
 #include "EventListener.hh"
 #include "Observer.hh"
 #include "EmuTime.hh"
+#include "FrameSkipGovernor.hh"
 #include <cstdint>
 
 namespace openmsx {
@@ -43,6 +44,12 @@ public:
 	  */
 	bool timeLeft(uint64_t us, EmuTime::param time);
 
+	/** The number of frames the renderers should skip after each drawn
+	  * frame to keep up with real time, see FrameSkipGovernor. Only
+	  * meaningful when throttling, otherwise this returns 0.
+	  */
+	unsigned getFrameSkip() const;
+
 	void resync();
 
 	void enable();
@@ -68,6 +75,7 @@ private:
 	void update(const ThrottleManager& throttleManager) override;
 
 	void internalSync(EmuTime::param time, bool allowSleep);
+	void frameFinished(bool drawn);
 
 	MSXMotherBoard& motherBoard;
 	EventDistributor& eventDistributor;
@@ -76,8 +84,13 @@ private:
 	IntegerSetting& speedSetting;
 	BooleanSetting& pauseSetting;
 	BooleanSetting& powerSetting;
+	FrameSkipGovernor frameSkipGovernor;
 
 	uint64_t idealRealTime;
+	uint64_t totalSleep; // us
+	uint64_t prevFrameRealTime; // 0 -> no previous frame
+	uint64_t prevFrameSleep;
+	EmuTime prevFrameEmuTime;
 	EmuTime emuTime;
 	double sleepAdjust;
 	bool enabled;
@@ -16,6 +16,7 @@
 #include "CliComm.hh"
 #include "Display.hh"
 #include "Reactor.hh"
+#include "GlobalSettings.hh"
 #include "CommandException.hh"
 #include "MemBuffer.hh"
 #include "StringOp.hh"
@@ -650,7 +651,8 @@ void ReverseManager::saveReplay(
 			getCurrentTime()));
 	}
 	try {
-		XmlOutputArchive out(filename);
+		XmlOutputArchive out(filename, reactor.getGlobalSettings()
+			.getSaveStateFormatSetting().getEnum());
 		replay.events = &history.events;
 		out.serialize("replay", replay);
 	} catch (MSXException&) {
@@ -6,6 +6,7 @@
 #include "Clock.hh"
 #include "MSXException.hh"
 #include "xrange.hh"
+#include <algorithm>
 #include <cstring> // for memcmp
 
 namespace openmsx {
@@ -21,6 +22,9 @@ namespace openmsx {
 // for those as well (we don't understand why yet)
 static const unsigned BAUDRATE = 3744;
 static const unsigned OUTPUT_FREQUENCY = 4 * BAUDRATE; // 4 samples per bit
+static const unsigned BIT_SAMPLES = OUTPUT_FREQUENCY / BAUDRATE;
+// start bit, 8 data bits, 2 stop bits
+static const unsigned BYTE_SAMPLES = 11 * BIT_SAMPLES;
 // We oversample the audio signal for better sound quality (especially in
 // combination with the hq resampler). Without oversampling the audio output
 // could contain portions like this:
@@ -48,6 +52,19 @@ static const byte BINARY_HEADER[10] = { 0xD0,0xD0,0xD0,0xD0,0xD0,0xD0,0xD0,0xD0,
 static const byte BASIC_HEADER [10] = { 0xD3,0xD3,0xD3,0xD3,0xD3,0xD3,0xD3,0xD3,0xD3,0xD3 };
 
 
+static unsigned toSample(EmuTime::param time)
+{
+	static const Clock<OUTPUT_FREQUENCY> zero(EmuTime::zero);
+	return zero.getTicksTill(time);
+}
+
+static EmuTime toTime(unsigned sample)
+{
+	static const Clock<OUTPUT_FREQUENCY> zero(EmuTime::zero);
+	return zero + sample;
+}
+
+
 CasImage::CasImage(const Filename& filename, FilePool& filePool, CliComm& cliComm)
 {
 	setFirstFileType(CassetteImage::UNKNOWN);
@@ -56,8 +73,7 @@ CasImage::CasImage(const Filename& filename, FilePool& filePool, CliComm& cliCom
 
 int16_t CasImage::getSampleAt(EmuTime::param time)
 {
-	static const Clock<OUTPUT_FREQUENCY> zero(EmuTime::zero);
-	unsigned pos = zero.getTicksTill(time);
+	unsigned pos = toSample(time);
 	return pos < output.size() ? output[pos] * 256 : 0;
 }
 
@@ -88,6 +104,57 @@ void CasImage::fillBuffer(unsigned pos, int** bufs, unsigned num) const
 	}
 }
 
+EmuTime CasImage::skipLeader(EmuTime::param pos) const
+{
+	// first block of which the data didn't start yet
+	unsigned sample = toSample(pos);
+	auto it = std::upper_bound(begin(blocks), end(blocks), sample,
+		[](unsigned s, const Block& b) { return s < b.data; });
+	if ((it == end(blocks)) || (sample < it->silence)) {
+		// still in the data of the previous block
+		return pos;
+	}
+	// Keep the last part of the header, that's all any loader (also the
+	// BIOS for the blocks with a short header) needs to synchronize.
+	unsigned target = std::max(it->header, it->data - SHORT_HEADER * BIT_SAMPLES);
+	return (sample < target) ? toTime(target) : pos;
+}
+
+int CasImage::readByte(EmuTime::param pos, EmuTime& next) const
+{
+	// last block of which the header started
+	unsigned sample = toSample(pos);
+	auto it = std::upper_bound(begin(blocks), end(blocks), sample,
+		[](unsigned s, const Block& b) { return s < b.header; });
+	if (it == begin(blocks)) return -1; // before the first header
+	--it;
+
+	unsigned index = 0; // still in the header: the first byte
+	if (sample >= it->data) {
+		unsigned offset = sample - it->data;
+		index = offset / BYTE_SAMPLES;
+		unsigned bit = (offset % BYTE_SAMPLES) / BIT_SAMPLES;
+		if (bit >= 9) {
+			// in the stop bits, TAPIN waits for the next start bit
+			++index;
+		} else if (bit != 0) {
+			// start bit already passed, the BIOS would read garbage
+			return -1;
+		}
+	}
+	if (index >= getNumBytes(it - begin(blocks))) return -1;
+	next = toTime(it->data + (index + 1) * BYTE_SAMPLES);
+	return bytes[it->firstByte + index];
+}
+
+unsigned CasImage::getNumBytes(size_t block) const
+{
+	unsigned end = (block + 1) < blocks.size()
+	             ? blocks[block + 1].firstByte
+	             : unsigned(bytes.size());
+	return end - blocks[block].firstByte;
+}
+
 void CasImage::write0()
 {
 	output.insert(end(output), { 127, 127, -127, -127 } );
@@ -111,9 +178,23 @@ void CasImage::writeSilence(int s)
 	output.insert(end(output), s, 0);
 }
 
+// write the silence and header in front of a block
+void CasImage::writeLeader(unsigned silence, unsigned header)
+{
+	Block block;
+	block.silence = unsigned(output.size());
+	writeSilence(silence);
+	block.header = unsigned(output.size());
+	writeHeader(header);
+	block.data = unsigned(output.size());
+	block.firstByte = unsigned(bytes.size());
+	blocks.push_back(block);
+}
+
 // write a byte
 void CasImage::writeByte(byte b)
 {
+	bytes.push_back(b);
 	// one start bit
 	write0();
 	// eight data bits
@@ -167,8 +248,7 @@ void CasImage::convert(const Filename& filename, FilePool& filePool, CliComm& cl
 			// them, we do also (hence a lot of code).
 			headerFound = true;
 			pos += 8;
-			writeSilence(LONG_SILENCE);
-			writeHeader(LONG_HEADER);
+			writeLeader(LONG_SILENCE, LONG_HEADER);
 			if ((pos + 10) <= size) {
 				// determine file type
 				FileType type = CassetteImage::UNKNOWN;
@@ -186,16 +266,14 @@ void CasImage::convert(const Filename& filename, FilePool& filePool, CliComm& cl
 						bool eof;
 						do {
 							pos += 8;
-							writeSilence(SHORT_SILENCE);
-							writeHeader(SHORT_HEADER);
+							writeLeader(SHORT_SILENCE, SHORT_HEADER);
 							eof = writeData(buf, size, pos);
 						} while (!eof && ((pos + 8) <= size));
 						break;
 					case CassetteImage::BINARY:
 					case CassetteImage::BASIC:
 						writeData(buf, size, pos);
-						writeSilence(SHORT_SILENCE);
-						writeHeader(SHORT_HEADER);
+						writeLeader(SHORT_SILENCE, SHORT_HEADER);
 						pos += 8;
 						writeData(buf, size, pos);
 						break;
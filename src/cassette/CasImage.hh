@@ -24,17 +24,32 @@ public:
 	EmuTime getEndTime() const override;
 	unsigned getFrequency() const override;
 	void fillBuffer(unsigned pos, int** bufs, unsigned num) const override;
+	bool isFastLoadable() const override { return true; }
+	EmuTime skipLeader(EmuTime::param pos) const override;
+	int readByte(EmuTime::param pos, EmuTime& next) const override;
 
 private:
+	/** Layout of one block (silence, header and data) in 'output'. */
+	struct Block {
+		unsigned silence;   // start of the silence
+		unsigned header;    // start of the header
+		unsigned data;      // start of the first byte
+		unsigned firstByte; // index in 'bytes'
+	};
+
 	void write0();
 	void write1();
 	void writeHeader(int s);
 	void writeSilence(int s);
 	void writeByte(byte b);
+	void writeLeader(unsigned silence, unsigned header);
 	bool writeData(const byte* buf, size_t size, size_t& pos);
 	void convert(const Filename& filename, FilePool& filePool, CliComm& cliComm);
+	unsigned getNumBytes(size_t block) const;
 
 	std::vector<signed char> output;
+	std::vector<Block> blocks;
+	std::vector<byte> bytes; // data bytes of all blocks
 };
 
 } // namespace openmsx
@@ -19,6 +19,24 @@ public:
 	virtual unsigned getFrequency() const = 0;
 	virtual void fillBuffer(unsigned pos, int** bufs, unsigned num) const = 0;
 
+	/** Support for fast loading, see CassettePlayer. Images that can't
+	  * decode the bytes on the tape (e.g. WAV) don't support it, for those
+	  * the tape signal is always emulated.
+	  */
+	virtual bool isFastLoadable() const { return false; }
+	/** Position a loader that starts looking for a header at tape
+	  * position 'pos' can skip to without missing anything (so after the
+	  * silence and the first part of the next header). Returns 'pos' when
+	  * there's nothing to skip.
+	  */
+	virtual EmuTime skipLeader(EmuTime::param pos) const { return pos; }
+	/** The byte the BIOS TAPIN routine would read when it's called at
+	  * tape position 'pos', or -1 when that's not a simple byte read (e.g.
+	  * 'pos' is in the middle of a byte). On success 'next' is set to the
+	  * tape position right after that byte.
+	  */
+	virtual int readByte(EmuTime::param /*pos*/, EmuTime& /*next*/) const { return -1; }
+
 	FileType getFirstFileType() const { return firstFileType; }
 	std::string getFirstFileTypeAsString() const;
 
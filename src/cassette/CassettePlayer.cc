@@ -34,6 +34,9 @@
 #include "CasImage.hh"
 #include "CliComm.hh"
 #include "MSXMotherBoard.hh"
+#include "MSXCPU.hh"
+#include "MSXCPUInterface.hh"
+#include "CPURegs.hh"
 #include "Reactor.hh"
 #include "GlobalSettings.hh"
 #include "CommandException.hh"
@@ -58,6 +61,9 @@ namespace openmsx {
 static const unsigned RECORD_FREQ = 44100;
 static const double OUTPUT_AMP = 60.0;
 
+// BIOS entry point that reads one byte from tape
+static const word TAPIN = 0x00E4;
+
 static XMLElement createXML()
 {
 	XMLElement xml("cassetteplayer");
@@ -82,11 +88,16 @@ CassettePlayer::CassettePlayer(const HardwareConfig& hwConf)
 	, autoRunSetting(
 		motherBoard.getCommandController(),
 		"autoruncassettes", "automatically try to run cassettes", true)
+	, fastLoadSetting(
+		motherBoard.getCommandController(),
+		"fastloadcassettes", "load cassettes via the BIOS without "
+		"emulating the tape signal (only for CAS images)", false)
 	, sampcnt(0)
 	, state(STOP)
 	, lastOutput(false)
 	, motor(false), motorControl(true)
 	, syncScheduled(false)
+	, trapInstalled(false)
 {
 	setInputRate(44100); // Initialize with dummy value
 
@@ -106,6 +117,7 @@ CassettePlayer::~CassettePlayer()
 	if (auto* c = getConnector()) {
 		c->unplug(getCurrentTime());
 	}
+	assert(!trapInstalled); // only installed while plugged in
 	motherBoard.getReactor().getEventDistributor().unregisterEventListener(
 		OPENMSX_BOOT_EVENT, *this);
 	motherBoard.getMSXCliComm().update(CliComm::HARDWARE, getName(), "remove");
@@ -299,6 +311,62 @@ void CassettePlayer::updateLoadingState(EmuTime::param time)
 	if (isRolling() && (getState() == PLAY)) {
 		syncEndOfTape.setSyncPoint(time + (playImage->getEndTime() - tapePos));
 	}
+
+	// Only trap TAPIN while it can be used, it slows down the CPU. (So
+	// changing the setting takes effect the next time the motor starts.)
+	bool needTrap = fastLoadSetting.getBoolean() && getConnector() &&
+	                isRolling() && (getState() == PLAY) &&
+	                playImage->isFastLoadable();
+	if (needTrap != trapInstalled) {
+		auto& interface = motherBoard.getCPUInterface();
+		if (needTrap) {
+			interface.insertTrap(TAPIN, tapinTrap);
+		} else {
+			interface.removeTrap(tapinTrap);
+		}
+		trapInstalled = needTrap;
+	}
+}
+
+void CassettePlayer::fastTapin(EmuTime::param time)
+{
+	// Only replace the BIOS routine, not some other code that runs at
+	// this address. The BIOS has a jump table entry (JP) here.
+	auto& interface = motherBoard.getCPUInterface();
+	if (!fastLoadSetting.getBoolean() ||
+	    (interface.peekMem(TAPIN, time) != 0xC3)) {
+		return;
+	}
+
+	sync(time);
+	EmuTime next = tapePos;
+	int value = playImage->readByte(tapePos, next);
+	if (value < 0) {
+		// not at the start of a byte (e.g. a custom loader moved the
+		// tape), let the BIOS read the emulated signal
+		return;
+	}
+	jumpTo(next, time);
+
+	// return from TAPIN with the byte in A and carry reset (no error)
+	auto& regs = motherBoard.getCPU().getRegisters();
+	regs.setA(value);
+	regs.setF(regs.getF() & ~0x01);
+	word sp = regs.getSP();
+	regs.setPC(interface.peekMem(sp + 0, time) +
+	           interface.peekMem(sp + 1, time) * 256);
+	regs.setSP(sp + 2);
+}
+
+void CassettePlayer::jumpTo(EmuTime::param newPos, EmuTime::param time)
+{
+	assert(prevSyncTime == time); // sync() must be called
+	updateStream(time); // sound up to now still uses the old position
+	tapePos = newPos;
+	DynamicClock clk(EmuTime::zero);
+	clk.setFreq(playImage->getFrequency());
+	audioPos = clk.getTicksTill(tapePos);
+	updateLoadingState(time); // new end-of-tape syncpoint
 }
 
 void CassettePlayer::setImageName(const Filename& newImage)
@@ -400,6 +468,13 @@ void CassettePlayer::setMotor(bool status, EmuTime::param time)
 	if (status != motor) {
 		sync(time);
 		motor = status;
+		if (motor && fastLoadSetting.getBoolean() &&
+		    (getState() == PLAY) && playImage->isFastLoadable()) {
+			// Loaders turn on the motor and then wait for a header,
+			// skip the silence and most of the (long) header.
+			EmuTime newPos = playImage->skipLeader(tapePos);
+			if (newPos != tapePos) jumpTo(newPos, time);
+		}
 		updateLoadingState(time);
 	}
 }
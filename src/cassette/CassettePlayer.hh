@@ -6,6 +6,7 @@
 #include "ResampledSoundDevice.hh"
 #include "RecordedCommand.hh"
 #include "Schedulable.hh"
+#include "CPUTrap.hh"
 #include "ThrottleManager.hh"
 #include "Filename.hh"
 #include "EmuTime.hh"
@@ -87,11 +88,21 @@ private:
 	bool isRolling() const;
 
 	/** If motor, motorControl or state is changed, this method should
-	  * be called to update the end-of-tape syncpoint and the loading
-	  * indicator.
+	  * be called to update the end-of-tape syncpoint, the loading
+	  * indicator and the fast-load trap.
 	  */
 	void updateLoadingState(EmuTime::param time);
 
+	/** Called when the BIOS TAPIN routine is about to run. When the tape
+	  * is at a byte the image can decode, return that byte right away
+	  * instead of emulating the signal.
+	  */
+	void fastTapin(EmuTime::param time);
+	/** Move the tape to a new position without emulating the signal
+	  * in between.
+	  */
+	void jumpTo(EmuTime::param newPos, EmuTime::param time);
+
 	/** Returns the position of the tape, in seconds from the
 	  * beginning of the tape. */
 	double getTapePos(EmuTime::param time);
@@ -113,6 +124,13 @@ private:
 	// EventListener
 	int signalEvent(const std::shared_ptr<const Event>& event) override;
 
+	struct TapinTrap final : CPUTrap {
+		void trap(EmuTime::param time) override {
+			auto& cp = OUTER(CassettePlayer, tapinTrap);
+			cp.fastTapin(time);
+		}
+	} tapinTrap;
+
 	// Schedulable
 	struct SyncEndOfTape : Schedulable {
 		friend class CassettePlayer;
@@ -169,6 +187,7 @@ private:
 
 	LoadingIndicator loadingIndicator;
 	BooleanSetting autoRunSetting;
+	BooleanSetting fastLoadSetting;
 	std::unique_ptr<Wav8Writer> recordImage;
 	std::unique_ptr<CassetteImage> playImage;
 
@@ -177,6 +196,7 @@ private:
 	bool lastOutput;
 	bool motor, motorControl;
 	bool syncScheduled;
+	bool trapInstalled; // no need to serialize
 };
 SERIALIZE_CLASS_VERSION(CassettePlayer, 2);
 
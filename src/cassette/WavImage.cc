@@ -1,13 +1,35 @@
 #include "WavImage.hh"
+#include "WavData.hh"
 #include "LocalFileReference.hh"
 #include "File.hh"
 #include "FilePool.hh"
+#include "Filename.hh"
+#include "MSXException.hh"
 #include "Math.hh"
-#include "memory.hh"
+#include "endian.hh"
 #include "xrange.hh"
+#include <algorithm>
+#include <cstring>
 
 namespace openmsx {
 
+// index entry every this many runs
+static const size_t INDEX_STEP = 256;
+
+// amplitude of the reconstructed signal, same as for CAS images
+static const int16_t AMPLITUDE = 127 * 256;
+
+// Layout of the pulse cache file: this header followed by 'numRuns' bytes.
+static const char PULSE_MAGIC[8] = { 'o','M','S','X','p','l','s','1' };
+struct PulseCacheHeader {
+	char magic[8];
+	char sha1[40]; // sha1sum of the WAV file, as hex string
+	Endian::L32 frequency;
+	Endian::L32 length;
+	Endian::L32 numRuns;
+	Endian::L32 firstLevel;
+};
+
 // DC-removal filter
 //   y(n) = x(n) - x(n-1) + R * y(n-1)
 // see comments in MSXMixer.cc for more details
@@ -37,32 +59,146 @@ WavImage::WavImage(const Filename& filename, FilePool& filePool)
 		setSha1Sum(filePool.getSha1Sum(file));
 		localFile = LocalFileReference(file);
 	}
-	wav = WavData(localFile.getFilename(), 16, 0);
+
+	std::string cacheName = filename.getResolved() + ".pulses";
+	if (loadCache(cacheName)) return;
+
+	WavData wav(localFile.getFilename(), 16, 0);
 	clock.setFreq(wav.getFreq());
+	length = wav.getSize();
 
 	auto* buf = static_cast<int16_t*>(wav.getData());
 	auto* end = buf + wav.getSize();
 	filter(wav.getFreq(), buf, end);
+	convert(buf, length);
+	buildIndex();
+	saveCache(cacheName);
 }
 
-int16_t WavImage::getSample(unsigned pos) const
+void WavImage::convert(const int16_t* buf, unsigned size)
 {
-	if (pos < wav.getSize()) {
-		auto* buf = static_cast<const int16_t*>(wav.getData());
-		return buf[pos];
+	auto addRun = [&](unsigned run) {
+		while (run >= 255) {
+			runs.push_back(255);
+			run -= 255;
+		}
+		runs.push_back(run);
+	};
+
+	runs.clear();
+	// same comparator as in CassettePort::cassetteIn()
+	firstLevel = (size == 0) || (buf[0] >= 0);
+	bool level = firstLevel;
+	unsigned run = 0;
+	for (auto i : xrange(size)) {
+		bool newLevel = buf[i] >= 0;
+		if (newLevel != level) {
+			addRun(run);
+			level = newLevel;
+			run = 0;
+		}
+		++run;
 	}
-	return 0;
+	addRun(run);
+}
+
+bool WavImage::loadCache(const std::string& cacheName)
+{
+	try {
+		File file(cacheName);
+		size_t size;
+		const byte* data = file.mmap(size);
+		if (size < sizeof(PulseCacheHeader)) return false;
+		const auto& header = *reinterpret_cast<const PulseCacheHeader*>(data);
+		if (memcmp(header.magic, PULSE_MAGIC, sizeof(PULSE_MAGIC)) ||
+		    (std::string(header.sha1, sizeof(header.sha1)) !=
+		     getSha1Sum().toString()) ||
+		    (header.frequency == 0) ||
+		    (size != (sizeof(header) + header.numRuns))) {
+			// other image or corrupt cache, convert again
+			return false;
+		}
+		clock.setFreq(header.frequency);
+		length = header.length;
+		firstLevel = header.firstLevel != 0;
+		runs.assign(data + sizeof(header), data + size);
+	} catch (MSXException&) {
+		// no (readable) cache
+		return false;
+	}
+	// the runs should exactly cover the whole image
+	return buildIndex() == length;
+}
+
+void WavImage::saveCache(const std::string& cacheName) const
+{
+	PulseCacheHeader header;
+	memcpy(header.magic, PULSE_MAGIC, sizeof(PULSE_MAGIC));
+	std::string sha1 = getSha1Sum().toString();
+	memcpy(header.sha1, sha1.data(), sizeof(header.sha1));
+	header.frequency = clock.getFreq();
+	header.length = length;
+	header.numRuns = unsigned(runs.size());
+	header.firstLevel = firstLevel;
+	try {
+		File file(cacheName, File::TRUNCATE);
+		file.write(&header, sizeof(header));
+		file.write(runs.data(), runs.size());
+	} catch (MSXException&) {
+		// Ignore, e.g. the image is in a read-only directory. Then
+		// we simply convert again next time.
+	}
+}
+
+unsigned WavImage::buildIndex()
+{
+	index.clear();
+	Cursor c = { 0, 0, firstLevel };
+	for (auto i : xrange(runs.size())) {
+		if ((i % INDEX_STEP) == 0) index.push_back(c);
+		c.pos += runs[i];
+		if (runs[i] != 255) c.level = !c.level;
+		c.run = i + 1;
+	}
+	if (index.empty()) index.push_back(c);
+	cursor = index.front();
+	return c.pos;
+}
+
+const WavImage::Cursor& WavImage::findIndex(unsigned pos) const
+{
+	// index.front().pos == 0, so there's always a match
+	auto it = std::upper_bound(begin(index), end(index), pos,
+		[](unsigned p, const Cursor& c) { return p < c.pos; });
+	return *(it - 1);
+}
+
+WavImage::Cursor WavImage::seek(unsigned pos, Cursor c) const
+{
+	while ((c.run < runs.size()) && (pos >= (c.pos + runs[c.run]))) {
+		byte run = runs[c.run++];
+		c.pos += run;
+		if (run != 255) c.level = !c.level;
+	}
+	return c;
 }
 
 int16_t WavImage::getSampleAt(EmuTime::param time)
 {
-	return getSample(clock.getTicksTill(time));
+	unsigned pos = clock.getTicksTill(time);
+	if (pos >= length) return 0;
+	const auto& i = findIndex(pos);
+	if ((pos < cursor.pos) || (i.run > cursor.run)) {
+		cursor = i;
+	}
+	cursor = seek(pos, cursor);
+	return cursor.level ? AMPLITUDE : -AMPLITUDE;
 }
 
 EmuTime WavImage::getEndTime() const
 {
 	DynamicClock clk(clock);
-	clk += wav.getSize();
+	clk += length;
 	return clk.getTime();
 }
 
@@ -73,9 +209,15 @@ unsigned WavImage::getFrequency() const
 
 void WavImage::fillBuffer(unsigned pos, int** bufs, unsigned num) const
 {
-	if (pos < wav.getSize()) {
+	if (pos < length) {
+		Cursor c = findIndex(pos);
 		for (auto i : xrange(num)) {
-			bufs[0][i] = getSample(pos + i);
+			if ((pos + i) < length) {
+				c = seek(pos + i, c);
+				bufs[0][i] = c.level ? AMPLITUDE : -AMPLITUDE;
+			} else {
+				bufs[0][i] = 0;
+			}
 		}
 	} else {
 		bufs[0] = nullptr;
@@ -2,15 +2,30 @@
 #define WAVIMAGE_HH
 
 #include "CassetteImage.hh"
-#include "WavData.hh"
 #include "DynamicClock.hh"
+#include "openmsx.hh"
 #include <cstdint>
+#include <string>
+#include <vector>
 
 namespace openmsx {
 
 class Filename;
 class FilePool;
 
+/** The emulated machine only looks at the sign of the (DC-filtered) tape
+  * signal (see CassettePort::cassetteIn()), so instead of keeping all
+  * samples in memory the signal is stored as the lengths of the runs of
+  * samples with the same sign. Converting a (long) WAV file takes a while,
+  * so the result is cached in a file next to the image (<image>.pulses),
+  * which is only used when it was created from a file with the same sha1sum.
+  *
+  * Run lengths are stored as bytes: a value 'v' smaller than 255 means 'v'
+  * more samples with the current level followed by a level change, 255
+  * means 255 more samples without a level change. Every INDEX_STEP bytes
+  * the position and level are remembered, so that the level at a random
+  * position can be found with a binary search and a short scan.
+  */
 class WavImage final : public CassetteImage
 {
 public:
@@ -22,10 +37,27 @@ public:
 	void fillBuffer(unsigned pos, int** bufs, unsigned num) const override;
 
 private:
-	int16_t getSample(unsigned pos) const;
+	/** Level of the signal from sample 'pos' on, where 'pos' is the start
+	  * of the run in runs[run]. */
+	struct Cursor {
+		size_t run;
+		unsigned pos;
+		bool level;
+	};
 
-	WavData wav;
+	void convert(const int16_t* buf, unsigned size);
+	bool loadCache(const std::string& cacheName);
+	void saveCache(const std::string& cacheName) const;
+	unsigned buildIndex(); // returns the total length of the runs
+	const Cursor& findIndex(unsigned pos) const;
+	Cursor seek(unsigned pos, Cursor cursor) const;
+
+	std::vector<byte> runs;
+	std::vector<Cursor> index; // for every INDEX_STEP runs
+	Cursor cursor; // getSampleAt() is mostly called for increasing times
 	DynamicClock clock;
+	unsigned length; // in samples
+	bool firstLevel;
 };
 
 } // namespace openmsx
@@ -17,6 +17,7 @@
 #include "memory.hh"
 #include "outer.hh"
 #include "xrange.hh"
+#include <algorithm>
 #include <cassert>
 
 using std::string;
@@ -36,6 +37,7 @@ GlobalCommandController::GlobalCommandController(
 	, settingsConfig(*this, hotKey)
 	, helpCmd(*this)
 	, tabCompletionCmd(*this)
+	, callbackStatsCmd(*this)
 	, updateCmd(*this)
 	, platformInfo(getOpenMSXInfoCommand())
 	, versionInfo (getOpenMSXInfoCommand())
@@ -520,6 +522,66 @@ string GlobalCommandController::TabCompletionCmd::help(const vector<string>& /*t
 }
 
 
+// class CallbackStatsCmd
+
+GlobalCommandController::CallbackStatsCmd::CallbackStatsCmd(
+		GlobalCommandController& controller_)
+	: Command(controller_, "callback_stats")
+{
+}
+
+void GlobalCommandController::CallbackStatsCmd::execute(
+	array_ref<TclObject> tokens, TclObject& result)
+{
+	auto& interp = getInterpreter();
+	if (tokens.size() == 2) {
+		if (tokens[1].getString() != "reset") {
+			throw SyntaxError();
+		}
+		interp.resetCallbackStats();
+		return;
+	}
+	if (tokens.size() != 1) {
+		throw SyntaxError();
+	}
+	// Slowest (in total) first.
+	using Entry = std::pair<string_ref, const Interpreter::CallbackStats*>;
+	vector<Entry> entries;
+	for (auto& p : interp.getCallbackStats()) {
+		entries.emplace_back(p.first, &p.second);
+	}
+	sort(begin(entries), end(entries), [](const Entry& x, const Entry& y) {
+		return x.second->total > y.second->total; });
+	string res;
+	for (auto& e : entries) {
+		TclObject line;
+		line.addListElement(e.first);
+		line.addListElement(int(e.second->count));
+		line.addListElement(StringOp::toString(e.second->total));
+		line.addListElement(StringOp::toString(e.second->max));
+		res += line.getString() + '\n';
+	}
+	result.setString(res);
+}
+
+string GlobalCommandController::CallbackStatsCmd::help(const vector<string>& /*tokens*/) const
+{
+	return "callback_stats        list execution time statistics of callbacks\n"
+	       "callback_stats reset  clear the statistics\n"
+	       "Callbacks are 'after' commands and callback settings like "
+	       "'led_callback'. For each callback this shows the name, the "
+	       "number of executions and the total and maximum execution time "
+	       "in microseconds. The callbacks that took most time in total are "
+	       "listed first.";
+}
+
+void GlobalCommandController::CallbackStatsCmd::tabCompletion(vector<string>& tokens) const
+{
+	static const char* const options[] = { "reset" };
+	completeString(tokens, options);
+}
+
+
 // class UpdateCmd
 
 GlobalCommandController::UpdateCmd::UpdateCmd(CommandController& commandController_)
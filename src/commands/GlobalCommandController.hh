@@ -127,6 +127,13 @@ private:
 		std::string help(const std::vector<std::string>& tokens) const override;
 	} tabCompletionCmd;
 
+	struct CallbackStatsCmd final : Command {
+		explicit CallbackStatsCmd(GlobalCommandController& controller);
+		void execute(array_ref<TclObject> tokens, TclObject& result) override;
+		std::string help(const std::vector<std::string>& tokens) const override;
+		void tabCompletion(std::vector<std::string>& tokens) const override;
+	} callbackStatsCmd;
+
 	struct UpdateCmd final : Command {
 		explicit UpdateCmd(CommandController& commandController);
 		void execute(array_ref<TclObject> tokens, TclObject& result) override;
@@ -436,6 +436,19 @@ void Interpreter::poll()
 	Tcl_DoOneEvent(TCL_DONT_WAIT);
 }
 
+void Interpreter::addCallbackTime(string_ref name, uint64_t duration)
+{
+	auto it = callbackStats.find(name);
+	if (it == end(callbackStats)) {
+		it = callbackStats.emplace_noDuplicateCheck(
+			name.str(), CallbackStats());
+	}
+	auto& stats = it->second;
+	++stats.count;
+	stats.total += duration;
+	stats.max = std::max(stats.max, duration);
+}
+
 TclParser Interpreter::parse(string_ref command)
 {
 	return TclParser(interp, command);
@@ -4,7 +4,10 @@
 #include "TclParser.hh"
 #include "TclObject.hh"
 #include "string_ref.hh"
+#include "hash_map.hh"
+#include "xxhash.hh"
 #include <vector>
+#include <cstdint>
 #include <tcl.h>
 
 namespace openmsx {
@@ -52,6 +55,20 @@ public:
 
 	void poll();
 
+	/** Execution time statistics of callback scripts ('after' commands,
+	  * callback settings), see the 'callback_stats' command.
+	  */
+	struct CallbackStats {
+		CallbackStats() : count(0), total(0), max(0) {}
+		unsigned count;
+		uint64_t total; // in us
+		uint64_t max;   // in us
+	};
+	using CallbackStatsMap = hash_map<std::string, CallbackStats, XXHasher>;
+	void addCallbackTime(string_ref name, uint64_t duration);
+	const CallbackStatsMap& getCallbackStats() const { return callbackStats; }
+	void resetCallbackStats() { callbackStats.clear(); }
+
 private:
 	static int outputProc(ClientData clientData, const char* buf,
 	        int toWrite, int* errorCodePtr);
@@ -65,6 +82,7 @@ private:
 	static Tcl_ChannelType channelType;
 	Tcl_Interp* interp;
 	InterpreterOutput* output;
+	CallbackStatsMap callbackStats;
 
 	friend class TclObject;
 };
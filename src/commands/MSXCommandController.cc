@@ -174,6 +174,7 @@ void MSXCommandController::transferSettings(const MSXCommandController& from)
 {
 	const auto& fromPrefix = from.getPrefix();
 	auto& manager = globalCommandController.getSettingsManager();
+	SettingsManager::Batch batch(manager);
 	for (auto* s : settings) {
 		if (auto* fromSetting = manager.findSetting(fromPrefix, s->getBaseName())) {
 			if (!fromSetting->needTransfer()) continue;
@@ -3,6 +3,8 @@
 #include "CliComm.hh"
 #include "CommandException.hh"
 #include "StringSetting.hh"
+#include "Interpreter.hh"
+#include "Timer.hh"
 #include "memory.hh"
 #include <iostream>
 
@@ -96,9 +98,16 @@ TclObject TclCallback::execute(string_ref arg1, string_ref arg2)
 
 TclObject TclCallback::executeCommon(TclObject& command)
 {
+	auto& interp = callbackSetting.getInterpreter();
+	auto start = Timer::getTime();
 	try {
-		return command.executeCommand(callbackSetting.getInterpreter());
+		auto result = command.executeCommand(interp);
+		interp.addCallbackTime(getSetting().getFullName(),
+		                       Timer::getTime() - start);
+		return result;
 	} catch (CommandException& e) {
+		interp.addCallbackTime(getSetting().getFullName(),
+		                       Timer::getTime() - start);
 		string message =
 			"Error executing callback function \"" +
 			getSetting().getFullName() + "\": " + e.getMessage();
@@ -40,10 +40,14 @@ XMLElement load(string_ref filename, string_ref systemID)
 	} catch (FileException& e) {
 		throw XMLException(filename + ": failed to read: " + e.getMessage());
 	}
+	return parse(buf.data(), filename, systemID);
+}
 
+XMLElement parse(char* buf, string_ref filename, string_ref systemID)
+{
 	XMLElementParser handler;
 	try {
-		rapidsax::parse<rapidsax::trimWhitespace>(handler, buf.data());
+		rapidsax::parse<rapidsax::trimWhitespace>(handler, buf);
 	} catch (rapidsax::ParseError& e) {
 		throw XMLException(filename + ": Document parsing failed: " + e.what());
 	}
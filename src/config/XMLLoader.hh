@@ -8,6 +8,13 @@ namespace XMLLoader {
 
 	XMLElement load(string_ref filename, string_ref systemID);
 
+	/** Like load(), but for a document that's already in memory. The
+	  * buffer must be zero-terminated and must have (at least)
+	  * rapidsax::EXTRA_BUFFER_SPACE extra bytes. Its content gets modified
+	  * while parsing. 'name' is only used in error messages.
+	  */
+	XMLElement parse(char* buf, string_ref name, string_ref systemID);
+
 } // namespace XMLLoader
 } // namespace openmsx
 
@@ -2593,9 +2593,10 @@ template<class T> void CPUCore<T>::execute2(bool fastForward)
 	// Note: we call scheduler _after_ executing the instruction and before
 	// deciding between executeFast() and executeSlow() (because a
 	// SyncPoint could set an IRQ and then we must choose executeSlow())
-	if (fastForward ||
-	    (!interface->anyBreakPoints() && !tracingEnabled)) {
-		// fast path, no breakpoints, no tracing
+	if ((fastForward ||
+	     (!interface->anyBreakPoints() && !tracingEnabled)) &&
+	    !interface->anyTraps()) {
+		// fast path, no breakpoints, no tracing, no traps
 		while (!needExitCPULoop()) {
 			if (slowInstructions) {
 				--slowInstructions;
@@ -2617,17 +2618,23 @@ template<class T> void CPUCore<T>::execute2(bool fastForward)
 			}
 		}
 	} else {
+		// Traps are part of the emulation, unlike breakpoints and
+		// tracing they're also handled in fast-forward mode.
 		while (!needExitCPULoop()) {
-			if (interface->checkBreakPoints(getPC(), motherboard)) {
+			if (interface->anyTraps()) {
+				interface->checkTraps(getPC(), T::getTime());
+			}
+			if (!fastForward &&
+			    interface->checkBreakPoints(getPC(), motherboard)) {
 				assert(interface->isBreaked());
 				break;
 			}
 			if (slowInstructions == 0) {
-				cpuTracePre();
+				if (!fastForward) cpuTracePre();
 				assert(T::limitReached()); // only one instruction
 				executeInstructions();
 				endInstruction();
-				cpuTracePost();
+				if (!fastForward) cpuTracePost();
 			} else {
 				--slowInstructions;
 				executeSlow();
@@ -0,0 +1,26 @@
+#ifndef CPUTRAP_HH
+#define CPUTRAP_HH
+
+#include "EmuTime.hh"
+
+namespace openmsx {
+
+/** C++ code that wants to run when the CPU is about to execute the
+  * instruction at a certain address, see MSXCPUInterface::insertTrap().
+  */
+class CPUTrap
+{
+public:
+	/** Called right before the instruction at the trapped address is
+	  * executed. It may change the CPU registers, e.g. to emulate a BIOS
+	  * routine and return to the caller.
+	  */
+	virtual void trap(EmuTime::param time) = 0;
+
+protected:
+	~CPUTrap() {}
+};
+
+} // namespace openmsx
+
+#endif
@@ -712,6 +712,19 @@ void MSXCPUInterface::removeBreakPoint(const BreakPoint& bp)
 		[&](const BreakPoint& i) { return &i == &bp; }));
 }
 
+void MSXCPUInterface::insertTrap(word address, CPUTrap& trap)
+{
+	traps.emplace_back(address, &trap);
+	// the CPU only checks for traps in its slow loop
+	motherBoard.getCPU().exitCPULoopSync();
+}
+
+void MSXCPUInterface::removeTrap(CPUTrap& trap)
+{
+	traps.erase(find_if_unguarded(traps,
+		[&](const std::pair<word, CPUTrap*>& t) { return t.second == &trap; }));
+}
+
 void MSXCPUInterface::checkBreakPoints(
 	std::pair<BreakPoints::const_iterator,
 	          BreakPoints::const_iterator> range,
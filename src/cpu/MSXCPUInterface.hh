@@ -7,12 +7,14 @@
 #include "MSXDevice.hh"
 #include "BreakPoint.hh"
 #include "WatchPoint.hh"
+#include "CPUTrap.hh"
 #include "openmsx.hh"
 #include "likely.hh"
 #include <algorithm>
 #include <bitset>
 #include <vector>
 #include <memory>
+#include <utility>
 
 namespace openmsx {
 
@@ -218,6 +220,26 @@ public:
 	using WatchPoints = std::vector<std::shared_ptr<WatchPoint>>;
 	const WatchPoints& getWatchPoints() const { return watchPoints; }
 
+	/** Traps are like breakpoints, but for C++ code that's part of the
+	  * emulated machine (e.g. the cassette fast-loader). Unlike breakpoints
+	  * they also trigger in fast-forward mode, so they don't break replays.
+	  * While there are traps, the CPU executes instructions one by one, so
+	  * only keep them registered while they're needed.
+	  */
+	void insertTrap(word address, CPUTrap& trap);
+	void removeTrap(CPUTrap& trap);
+	bool anyTraps() const { return !traps.empty(); }
+	void checkTraps(word pc, EmuTime::param time)
+	{
+		for (auto& t : traps) {
+			if (t.first == pc) {
+				// the trap may (un)register traps, stop iterating
+				t.second->trap(time);
+				return;
+			}
+		}
+	}
+
 	static void setCondition(const DebugCondition& cond);
 	static void removeCondition(const DebugCondition& cond);
 	using Conditions = std::vector<DebugCondition>;
@@ -394,6 +416,9 @@ private:
 
 	bool fastForward; // no need to serialize
 
+	// owners register their traps again after loadstate
+	std::vector<std::pair<word, CPUTrap*>> traps;
+
 	//  All CPUs (Z80 and R800) of all MSX machines share this state.
 	static BreakPoints breakPoints; // sorted on address
 	WatchPoints watchPoints; // ordered in creation order,  TODO must also be static
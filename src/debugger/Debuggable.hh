@@ -6,6 +6,8 @@
 
 namespace openmsx {
 
+class DirtyTracker;
+
 class Debuggable
 {
 public:
@@ -14,6 +16,13 @@ public:
 	virtual byte read(unsigned address) = 0;
 	virtual void write(unsigned address, byte value) = 0;
 
+	/** Debuggables that know which parts of their content were written
+	  * can return a DirtyTracker here. This speeds up change notifications
+	  * (see 'debug subscribe'), without it the whole subscribed range is
+	  * compared with a copy.
+	  */
+	virtual DirtyTracker* getDirtyTracker() { return nullptr; }
+
 protected:
 	Debuggable() {}
 	~Debuggable() {}
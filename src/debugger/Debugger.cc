@@ -1,5 +1,6 @@
 #include "Debugger.hh"
 #include "Debuggable.hh"
+#include "DirtyTracker.hh"
 #include "ProbeBreakPoint.hh"
 #include "MSXMotherBoard.hh"
 #include "Reactor.hh"
@@ -8,6 +9,9 @@
 #include "BreakPoint.hh"
 #include "DebugCondition.hh"
 #include "MSXWatchIODevice.hh"
+#include "CliComm.hh"
+#include "EventDistributor.hh"
+#include "Event.hh"
 #include "TclObject.hh"
 #include "CommandException.hh"
 #include "MemBuffer.hh"
@@ -35,12 +39,20 @@ Debugger::Debugger(MSXMotherBoard& motherBoard_)
 	      motherBoard.getScheduler())
 	, cpu(nullptr)
 {
+	auto& distributor = motherBoard.getReactor().getEventDistributor();
+	distributor.registerEventListener(OPENMSX_FINISH_FRAME_EVENT, *this);
+	distributor.registerEventListener(OPENMSX_BREAK_EVENT, *this);
 }
 
 Debugger::~Debugger()
 {
 	assert(!cpu);
 	assert(debuggables.empty());
+	assert(subscriptions.empty());
+
+	auto& distributor = motherBoard.getReactor().getEventDistributor();
+	distributor.unregisterEventListener(OPENMSX_BREAK_EVENT, *this);
+	distributor.unregisterEventListener(OPENMSX_FINISH_FRAME_EVENT, *this);
 }
 
 void Debugger::registerDebuggable(string name, Debuggable& debuggable)
@@ -52,8 +64,19 @@ void Debugger::registerDebuggable(string name, Debuggable& debuggable)
 void Debugger::unregisterDebuggable(string_ref name, Debuggable& debuggable)
 {
 	assert(debuggables.contains(name));
-	assert(debuggables[name.str()] == &debuggable); (void)debuggable;
+	assert(debuggables[name.str()] == &debuggable);
 	debuggables.erase(name);
+
+	// Drop the subscriptions on this debuggable, a debuggable with the
+	// same name that is registered later is not necessarily the same.
+	for (auto it = begin(subscriptions); it != end(subscriptions); /**/) {
+		if (it->debuggable == &debuggable) {
+			if (it->tracker) it->tracker->removeUser();
+			it = subscriptions.erase(it);
+		} else {
+			++it;
+		}
+	}
 }
 
 Debuggable* Debugger::findDebuggable(string_ref name)
@@ -163,6 +186,117 @@ unsigned Debugger::setWatchPoint(TclObject command, TclObject condition,
 	return wp->getId();
 }
 
+static unsigned lastSubscriptionId = 0;
+
+unsigned Debugger::subscribe(string name, Debuggable& debuggable,
+                             unsigned beginAddr, unsigned size,
+                             unsigned newId /*= -1*/)
+{
+	Subscription s;
+	s.id = (newId == unsigned(-1)) ? ++lastSubscriptionId : newId;
+	s.name = std::move(name);
+	s.debuggable = &debuggable;
+	s.tracker = debuggable.getDirtyTracker();
+	s.begin = beginAddr;
+	s.shadow.resize(size);
+	for (unsigned i = 0; i < size; ++i) {
+		s.shadow[i] = debuggable.read(beginAddr + i);
+	}
+	s.fullCheck = false;
+	if (s.tracker) s.tracker->addUser();
+	subscriptions.push_back(std::move(s));
+	return subscriptions.back().id;
+}
+
+void Debugger::unsubscribe(unsigned id)
+{
+	auto it = find_if(begin(subscriptions), end(subscriptions),
+		[&](const Subscription& s) { return s.id == id; });
+	if (it == end(subscriptions)) {
+		throw CommandException(StringOp::Builder() <<
+			"No such subscription: sub#" << id);
+	}
+	if (it->tracker) it->tracker->removeUser();
+	subscriptions.erase(it);
+}
+
+static void addChange(TclObject& changes, unsigned addr,
+                      const byte* data, unsigned num)
+{
+	static const char* const digits = "0123456789abcdef";
+	string hex;
+	hex.reserve(2 * num);
+	for (unsigned i = 0; i < num; ++i) {
+		hex += digits[data[i] >> 4];
+		hex += digits[data[i] & 15];
+	}
+	changes.addListElement(int(addr));
+	changes.addListElement(hex);
+}
+
+void Debugger::checkSubscriptions()
+{
+	for (auto& s : subscriptions) {
+		// Compare with the previously reported content, but (when the
+		// debuggable supports it) only the pages that were written.
+		TclObject changes;
+		auto size = unsigned(s.shadow.size());
+		unsigned runStart = unsigned(-1);
+		unsigned offset = 0;
+		while (offset < size) {
+			unsigned addr = s.begin + offset;
+			unsigned page = addr >> DirtyTracker::PAGE_BITS;
+			unsigned pageEnd = std::min(size,
+				((page + 1) << DirtyTracker::PAGE_BITS) - s.begin);
+			if (s.tracker && !s.fullCheck && !s.tracker->isDirty(page)) {
+				if (runStart != unsigned(-1)) {
+					addChange(changes, s.begin + runStart,
+					          &s.shadow[runStart], offset - runStart);
+					runStart = unsigned(-1);
+				}
+				offset = pageEnd;
+				continue;
+			}
+			for (/**/; offset < pageEnd; ++offset) {
+				byte value = s.debuggable->read(s.begin + offset);
+				if (value != s.shadow[offset]) {
+					s.shadow[offset] = value;
+					if (runStart == unsigned(-1)) runStart = offset;
+				} else if (runStart != unsigned(-1)) {
+					addChange(changes, s.begin + runStart,
+					          &s.shadow[runStart], offset - runStart);
+					runStart = unsigned(-1);
+				}
+			}
+		}
+		if (runStart != unsigned(-1)) {
+			addChange(changes, s.begin + runStart,
+			          &s.shadow[runStart], size - runStart);
+		}
+		s.fullCheck = false;
+		if (!changes.empty()) {
+			motherBoard.getMSXCliComm().update(
+				CliComm::DEBUGGABLE,
+				StringOp::Builder() << "sub#" << s.id,
+				changes.getString());
+		}
+	}
+	// Only clear afterwards, several subscriptions can share a tracker.
+	for (auto& s : subscriptions) {
+		if (s.tracker) s.tracker->clear();
+	}
+}
+
+int Debugger::signalEvent(const std::shared_ptr<const Event>& /*event*/)
+{
+	// End of frame or CPU breaked. Only the active machine can change.
+	if (!subscriptions.empty() &&
+	    (motherBoard.getReactor().getMotherBoard() == &motherBoard)) {
+		checkSubscriptions();
+	}
+	return 0;
+}
+
 void Debugger::transfer(Debugger& other)
 {
 	// Copy watchpoints to new machine.
@@ -183,6 +317,17 @@ void Debugger::transfer(Debugger& other)
 		}
 	}
 
+	// Copy subscriptions to new machine. Keep the old content, so that
+	// the next check reports all differences with the new machine.
+	assert(subscriptions.empty());
+	for (auto& s : other.subscriptions) {
+		Debuggable* d = findDebuggable(s.name);
+		if (!d || ((s.begin + s.shadow.size()) > d->getSize())) continue;
+		subscribe(s.name, *d, s.begin, unsigned(s.shadow.size()), s.id);
+		subscriptions.back().shadow = s.shadow;
+		subscriptions.back().fullCheck = true;
+	}
+
 	// Breakpoints and conditions are (currently) global, so no need to
 	// copy those.
 }
@@ -272,6 +417,12 @@ void Debugger::Cmd::execute(
 		listConditions(tokens, result);
 	} else if (subCmd == "probe") {
 		probe(tokens, result);
+	} else if (subCmd == "subscribe") {
+		subscribe(tokens, result);
+	} else if (subCmd == "unsubscribe") {
+		unsubscribe(tokens, result);
+	} else if (subCmd == "list_subscriptions") {
+		listSubscriptions(tokens, result);
 	} else {
 		throw SyntaxError();
 	}
@@ -755,6 +906,74 @@ void Debugger::Cmd::probeListBreakPoints(
 	result.setString(res);
 }
 
+void Debugger::Cmd::subscribe(array_ref<TclObject> tokens, TclObject& result)
+{
+	if ((tokens.size() < 3) || (tokens.size() > 5)) {
+		throw SyntaxError();
+	}
+	auto& interp = getInterpreter();
+	string_ref debuggableName = tokens[2].getString();
+	Debuggable& device = debugger().getDebuggable(debuggableName);
+	unsigned devSize = device.getSize();
+	unsigned addr = 0;
+	if (tokens.size() >= 4) {
+		addr = tokens[3].getInt(interp);
+		if (addr >= devSize) {
+			throw CommandException("Invalid address");
+		}
+	}
+	unsigned num = devSize - addr;
+	if (tokens.size() == 5) {
+		num = tokens[4].getInt(interp);
+		if ((num == 0) || (num > (devSize - addr))) {
+			throw CommandException("Invalid size");
+		}
+	}
+	unsigned id = debugger().subscribe(debuggableName.str(), device, addr, num);
+	result.setString(StringOp::Builder() << "sub#" << id);
+}
+
+void Debugger::Cmd::unsubscribe(array_ref<TclObject> tokens, TclObject& /*result*/)
+{
+	if (tokens.size() != 3) {
+		throw SyntaxError();
+	}
+	string_ref tmp = tokens[2].getString();
+	try {
+		if (tmp.starts_with("sub#")) {
+			debugger().unsubscribe(fast_stou(tmp.substr(4)));
+			return;
+		}
+	} catch (std::invalid_argument&) {
+		// parse error in fast_stou()
+	}
+	throw CommandException("No such subscription: " + tmp);
+}
+
+void Debugger::Cmd::listSubscriptions(
+	array_ref<TclObject> /*tokens*/, TclObject& result)
+{
+	string res;
+	for (auto& s : debugger().subscriptions) {
+		TclObject line;
+		line.addListElement(StringOp::Builder() << "sub#" << s.id);
+		line.addListElement(s.name);
+		line.addListElement(int(s.begin));
+		line.addListElement(int(s.shadow.size()));
+		res += line.getString() + '\n';
+	}
+	result.setString(res);
+}
+
+vector<string> Debugger::Cmd::getSubscriptionIds() const
+{
+	vector<string> ids;
+	for (auto& s : debugger().subscriptions) {
+		ids.push_back(StringOp::Builder() << "sub#" << s.id);
+	}
+	return ids;
+}
+
 string Debugger::Cmd::help(const vector<string>& tokens) const
 {
 	static const string generalHelp =
@@ -777,6 +996,9 @@ string Debugger::Cmd::help(const vector<string>& tokens) const
 		"    remove_condition  remove a certain condition\n"
 		"    list_conditions   list the active conditions\n"
 		"    probe             probe related subcommands\n"
+		"    subscribe         get notified about changes in a debuggable\n"
+		"    unsubscribe       remove a certain subscription\n"
+		"    list_subscriptions list the active subscriptions\n"
 		"    cont              continue execution after break\n"
 		"    step              execute one instruction\n"
 		"    break             break CPU at current position\n"
@@ -915,6 +1137,22 @@ string Debugger::Cmd::help(const vector<string>& tokens) const
 		"    set_bp <probe> [<cond>] [<cmd>]  set a breakpoint on the given probe\n"
 		"    remove_bp <id>                   remove the given breakpoint\n"
 		"    list_bp                          returns a list of breakpoints that are set on probes\n";
+	static const string subscribeHelp =
+		"debug subscribe <name> [<addr> [<size>]]\n"
+		"  Get notified about changes in the given debuggable (or only in "
+		"the range of <size> bytes starting at <addr>). At the end of each "
+		"frame (and when the CPU breaks) the changed bytes are sent as an "
+		"update of type 'debuggable', see 'openmsx_update'. The update "
+		"name is the returned subscription ID, the value is a list of "
+		"address and hex-data pairs, one for each changed range.\n";
+	static const string unsubscribeHelp =
+		"debug unsubscribe <id>\n"
+		"  Remove the subscription with given ID again. You can use the "
+		"'list_subscriptions' subcommand to see all valid IDs.\n";
+	static const string listSubscriptionsHelp =
+		"debug list_subscriptions\n"
+		"  Lists all active subscriptions: ID, debuggable, address and "
+		"size.\n";
 	static const string contHelp =
 		"debug cont\n"
 		"  Continue execution after CPU was breaked.\n";
@@ -980,6 +1218,12 @@ string Debugger::Cmd::help(const vector<string>& tokens) const
 		return listCondHelp;
 	} else if (tokens[1] == "probe") {
 		return probeHelp;
+	} else if (tokens[1] == "subscribe") {
+		return subscribeHelp;
+	} else if (tokens[1] == "unsubscribe") {
+		return unsubscribeHelp;
+	} else if (tokens[1] == "list_subscriptions") {
+		return listSubscriptionsHelp;
 	} else if (tokens[1] == "cont") {
 		return contHelp;
 	} else if (tokens[1] == "step") {
@@ -1028,15 +1272,16 @@ void Debugger::Cmd::tabCompletion(vector<string>& tokens) const
 	static const char* const singleArgCmds[] = {
 		"list", "step", "cont", "break", "breaked",
 		"list_bp", "list_watchpoints", "list_conditions",
+		"list_subscriptions",
 	};
 	static const char* const debuggableArgCmds[] = {
 		"desc", "size", "read", "read_block",
-		"write", "write_block",
+		"write", "write_block", "subscribe",
 	};
 	static const char* const otherCmds[] = {
 		"disasm", "set_bp", "remove_bp", "set_watchpoint",
 		"remove_watchpoint", "set_condition", "remove_condition",
-		"probe",
+		"probe", "unsubscribe",
 	};
 	switch (tokens.size()) {
 	case 2: {
@@ -1062,6 +1307,8 @@ void Debugger::Cmd::tabCompletion(vector<string>& tokens) const
 			} else if (tokens[1] == "remove_condition") {
 				// this one takes a cond id
 				completeString(tokens, getConditionIds());
+			} else if (tokens[1] == "unsubscribe") {
+				completeString(tokens, getSubscriptionIds());
 			} else if (tokens[1] == "set_watchpoint") {
 				static const char* const types[] = {
 					"write_io", "write_mem",
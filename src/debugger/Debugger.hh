@@ -4,6 +4,8 @@
 #include "Probe.hh"
 #include "RecordedCommand.hh"
 #include "WatchPoint.hh"
+#include "EventListener.hh"
+#include "openmsx.hh"
 #include "hash_map.hh"
 #include "string_ref.hh"
 #include "outer.hh"
@@ -15,11 +17,12 @@ namespace openmsx {
 
 class MSXMotherBoard;
 class Debuggable;
+class DirtyTracker;
 class ProbeBase;
 class ProbeBreakPoint;
 class MSXCPU;
 
-class Debugger
+class Debugger final : private EventListener
 {
 public:
 	Debugger(const Debugger&) = delete;
@@ -44,6 +47,28 @@ public:
 	MSXMotherBoard& getMotherBoard() { return motherBoard; }
 
 private:
+	/** A client registered for changes in (part of) a debuggable. At the
+	  * end of each frame the changed byte ranges are sent as a CliComm
+	  * update.
+	  */
+	struct Subscription {
+		unsigned id;
+		std::string name; // of the debuggable
+		Debuggable* debuggable;
+		DirtyTracker* tracker; // can be nullptr
+		unsigned begin;
+		std::vector<byte> shadow; // content as last reported
+		bool fullCheck; // compare everything, ignore 'tracker' once
+	};
+
+	unsigned subscribe(std::string name, Debuggable& debuggable,
+	                   unsigned begin, unsigned size, unsigned newId = -1);
+	void unsubscribe(unsigned id);
+	void checkSubscriptions();
+
+	// EventListener
+	int signalEvent(const std::shared_ptr<const Event>& event) override;
+
 	Debuggable& getDebuggable(string_ref name);
 	ProbeBase& getProbe(string_ref name);
 
@@ -99,6 +124,10 @@ private:
 		void probeSetBreakPoint(array_ref<TclObject> tokens, TclObject& result);
 		void probeRemoveBreakPoint(array_ref<TclObject> tokens, TclObject& result);
 		void probeListBreakPoints(array_ref<TclObject> tokens, TclObject& result);
+		void subscribe(array_ref<TclObject> tokens, TclObject& result);
+		void unsubscribe(array_ref<TclObject> tokens, TclObject& result);
+		void listSubscriptions(array_ref<TclObject> tokens, TclObject& result);
+		std::vector<std::string> getSubscriptionIds() const;
 	} cmd;
 
 	struct NameFromProbe {
@@ -111,6 +140,7 @@ private:
 	hash_set<ProbeBase*, NameFromProbe, XXHasher>  probes;
 	using ProbeBreakPoints = std::vector<std::unique_ptr<ProbeBreakPoint>>;
 	ProbeBreakPoints probeBreakPoints; // unordered
+	std::vector<Subscription> subscriptions;
 	MSXCPU* cpu;
 };
 
@@ -0,0 +1,56 @@
+#ifndef DIRTYTRACKER_HH
+#define DIRTYTRACKER_HH
+
+#include "likely.hh"
+#include <vector>
+
+namespace openmsx {
+
+/** Remembers which pages (blocks of PAGE_SIZE bytes) of a memory block
+  * were written. Used by the debugger to only compare the written parts of
+  * a Debuggable when sending change notifications to subscribed clients,
+  * see 'debug subscribe'.
+  *
+  * Tracking is only active while there's at least one user, otherwise
+  * mark() is only a (well predicted) test.
+  */
+class DirtyTracker
+{
+public:
+	static const unsigned PAGE_BITS = 8;
+	static const unsigned PAGE_SIZE = 1 << PAGE_BITS;
+
+	explicit DirtyTracker(unsigned size)
+		: dirty((size + PAGE_SIZE - 1) >> PAGE_BITS)
+		, users(0)
+	{
+	}
+
+	/** Should be called for each write to the tracked memory. */
+	void mark(unsigned address) {
+		if (unlikely(users)) {
+			dirty[address >> PAGE_BITS] = true;
+		}
+	}
+
+	/** For when (potentially) the whole memory block changed. */
+	void markAll() {
+		if (users) dirty.assign(dirty.size(), true);
+	}
+
+	bool isDirty(unsigned page) const { return dirty[page]; }
+	void clear() { dirty.assign(dirty.size(), false); }
+
+	void addUser() {
+		if (users++ == 0) clear();
+	}
+	void removeUser() { --users; }
+
+private:
+	std::vector<bool> dirty;
+	unsigned users;
+};
+
+} // namespace openmsx
+
+#endif
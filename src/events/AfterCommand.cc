@@ -10,10 +10,13 @@
 #include "EmuTime.hh"
 #include "CommandException.hh"
 #include "TclObject.hh"
+#include "Interpreter.hh"
+#include "Timer.hh"
 #include "memory.hh"
 #include "stl.hh"
 #include "unreachable.hh"
 #include <algorithm>
+#include <cctype>
 #include <iterator>
 #include <sstream>
 
@@ -32,6 +35,7 @@ public:
 	string_ref getCommand() const;
 	const string& getId() const;
 	virtual string getType() const = 0;
+	void initStatsName();
 	void execute();
 protected:
 	AfterCmd(AfterCommand& afterCommand,
@@ -41,6 +45,7 @@ protected:
 	AfterCommand& afterCommand;
 	TclObject command;
 	string id;
+	string statsName; // key for Interpreter::addCallbackTime()
 	static unsigned lastAfterId;
 };
 
@@ -254,8 +259,7 @@ void AfterCommand::afterTime(array_ref<TclObject> tokens, TclObject& result)
 	double time = getTime(getInterpreter(), tokens[2]);
 	auto cmd = make_unique<AfterTimeCmd>(
 		motherBoard->getScheduler(), *this, tokens[3], time);
-	result.setString(cmd->getId());
-	afterCmds.push_back(move(cmd));
+	addCmd(move(cmd), result);
 }
 
 void AfterCommand::afterRealTime(array_ref<TclObject> tokens, TclObject& result)
@@ -266,8 +270,7 @@ void AfterCommand::afterRealTime(array_ref<TclObject> tokens, TclObject& result)
 	double time = getTime(getInterpreter(), tokens[2]);
 	auto cmd = make_unique<AfterRealTimeCmd>(
 		reactor.getRTScheduler(), *this, tokens[3], time);
-	result.setString(cmd->getId());
-	afterCmds.push_back(move(cmd));
+	addCmd(move(cmd), result);
 }
 
 void AfterCommand::afterTclTime(
@@ -277,8 +280,7 @@ void AfterCommand::afterTclTime(
 	command.addListElements(std::begin(tokens) + 2, std::end(tokens));
 	auto cmd = make_unique<AfterRealTimeCmd>(
 		reactor.getRTScheduler(), *this, command, ms / 1000.0);
-	result.setString(cmd->getId());
-	afterCmds.push_back(move(cmd));
+	addCmd(move(cmd), result);
 }
 
 template<EventType T>
@@ -289,8 +291,7 @@ void AfterCommand::afterEvent(array_ref<TclObject> tokens, TclObject& result)
 	}
 	auto cmd = make_unique<AfterEventCmd<T>>(
 		*this, tokens[1], tokens[2]);
-	result.setString(cmd->getId());
-	afterCmds.push_back(move(cmd));
+	addCmd(move(cmd), result);
 }
 
 void AfterCommand::afterInputEvent(
@@ -301,8 +302,7 @@ void AfterCommand::afterInputEvent(
 	}
 	auto cmd = make_unique<AfterInputEventCmd>(
 		*this, event, tokens[2]);
-	result.setString(cmd->getId());
-	afterCmds.push_back(move(cmd));
+	addCmd(move(cmd), result);
 }
 
 void AfterCommand::afterIdle(array_ref<TclObject> tokens, TclObject& result)
@@ -315,6 +315,12 @@ void AfterCommand::afterIdle(array_ref<TclObject> tokens, TclObject& result)
 	double time = getTime(getInterpreter(), tokens[2]);
 	auto cmd = make_unique<AfterIdleCmd>(
 		motherBoard->getScheduler(), *this, tokens[3], time);
+	addCmd(move(cmd), result);
+}
+
+void AfterCommand::addCmd(unique_ptr<AfterCmd> cmd, TclObject& result)
+{
+	cmd->initStatsName();
 	result.setString(cmd->getId());
 	afterCmds.push_back(move(cmd));
 }
@@ -485,14 +491,32 @@ const string& AfterCmd::getId() const
 	return id;
 }
 
+void AfterCmd::initStatsName()
+{
+	// Only use the first word of the command: scripts often re-register
+	// commands with changing arguments (e.g. a counter), using the whole
+	// command would create a new entry in the statistics each time.
+	string_ref cmdStr = getCommand();
+	auto isSpace = [](char c) { return isspace(static_cast<unsigned char>(c)); };
+	auto first = std::find_if_not(cmdStr.begin(), cmdStr.end(), isSpace);
+	auto last  = std::find_if    (first,          cmdStr.end(), isSpace);
+	statsName = "after " + getType() + ' ' + string(first, last);
+}
+
 void AfterCmd::execute()
 {
+	// Scripts often re-register the same command (object) each frame.
+	// Compiling the command stores the byte-code in that object, so the
+	// next time it can be executed without parsing it again.
+	auto& interp = afterCommand.getInterpreter();
+	auto start = Timer::getTime();
 	try {
-		command.executeCommand(afterCommand.getInterpreter());
+		command.executeCommand(interp, true);
 	} catch (CommandException& e) {
 		afterCommand.getCommandController().getCliComm().printWarning(
 			"Error executing delayed command: " + e.getMessage());
 	}
+	interp.addCallbackTime(statsName, Timer::getTime() - start);
 }
 
 unique_ptr<AfterCmd> AfterCmd::removeSelf()
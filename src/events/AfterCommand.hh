@@ -42,6 +42,7 @@ private:
 	void afterIdle    (array_ref<TclObject> tokens, TclObject& result);
 	void afterInfo    (array_ref<TclObject> tokens, TclObject& result);
 	void afterCancel  (array_ref<TclObject> tokens, TclObject& result);
+	void addCmd(std::unique_ptr<AfterCmd> cmd, TclObject& result);
 
 	// EventListener
 	int signalEvent(const std::shared_ptr<const Event>& event) override;
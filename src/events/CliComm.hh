@@ -28,6 +28,7 @@ public:
 		EXTENSION,
 		SOUNDDEVICE,
 		CONNECTOR,
+		DEBUGGABLE,
 		NUM_UPDATES // must be last
 	};
 
@@ -17,7 +17,9 @@
 #include "unistdp.hh"
 #include "openmsx.hh"
 #include "StringOp.hh"
+#include "endian.hh"
 #include <cassert>
+#include <cctype>
 #include <iostream>
 
 #ifdef _WIN32
@@ -34,9 +36,9 @@ namespace openmsx {
 class CliCommandEvent : public Event
 {
 public:
-	CliCommandEvent(string command_, const CliConnection* id_)
+	CliCommandEvent(string command_, const CliConnection* id_, bool binary_)
 		: Event(OPENMSX_CLICOMMAND_EVENT)
-		, command(std::move(command_)), id(id_)
+		, command(std::move(command_)), id(id_), binary(binary_)
 	{
 	}
 	const string& getCommand() const
@@ -47,6 +49,11 @@ public:
 	{
 		return id;
 	}
+	/** Is this a frame of the binary protocol (instead of a Tcl command)? */
+	bool isBinary() const
+	{
+		return binary;
+	}
 	void toStringImpl(TclObject& result) const override
 	{
 		result.addListElement("CliCmd");
@@ -60,16 +67,101 @@ public:
 private:
 	const string command;
 	const CliConnection* id;
+	const bool binary;
 };
 
 
+// The binary protocol
+//
+// A client switches to the binary protocol by sending the (XML) command
+// "binary-protocol". All replies to earlier commands are still sent in XML,
+// then the reply "<reply result=\"ok\">binary</reply>" follows, and from
+// then on all communication (in both directions) consists of frames. The
+// client sends its first frame only after it received that reply, whitespace
+// (e.g. a newline) between the command and that reply is ignored:
+//   uint32 length   number of bytes that follow (type + payload)
+//   uint8  type
+//   ...    payload (format depends on type)
+// All integers are little endian. Strings are not zero-terminated, their
+// length follows from the frame length (or from an explicit length field).
+//
+// Client -> openMSX:
+//   COMMAND: uint32 tag, command         execute a Tcl command
+//   READ:    uint32 tag, uint32 address, uint32 size, debuggable name
+//   WRITE:   uint32 tag, uint32 address, uint16 namelen, name, data
+//   BATCH:   a sequence of (COMMAND, READ or WRITE) frames, executed at once,
+//            all the replies are also sent at once
+// openMSX -> client:
+//   REPLY:   uint32 tag, uint8 ok (1 = ok, 0 = error), result
+//            (the raw bytes for READ, the error message on error)
+//   LOG:     uint8 level, message
+//   UPDATE:  uint8 type, uint16 machinelen, machine, uint16 namelen, name,
+//            value
+// The tag is chosen by the client and is copied in the corresponding REPLY.
+// The level and type values are the indices in CliComm::LogLevel and
+// CliComm::UpdateType.
+enum BinaryFrameType : uint8_t {
+	BIN_COMMAND = 0x01,
+	BIN_READ    = 0x02,
+	BIN_WRITE   = 0x03,
+	BIN_BATCH   = 0x04,
+	BIN_REPLY   = 0x81,
+	BIN_LOG     = 0x82,
+	BIN_UPDATE  = 0x83,
+};
+static const char* const BINARY_PROTOCOL_COMMAND = "binary-protocol";
+static const size_t MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+static void appendU16(string& out, uint16_t value)
+{
+	char buf[2];
+	Endian::write_UA_L16(buf, value);
+	out.append(buf, 2);
+}
+
+static void appendU32(string& out, uint32_t value)
+{
+	char buf[4];
+	Endian::write_UA_L32(buf, value);
+	out.append(buf, 4);
+}
+
+// Appends a frame of the given type, the payload is appended by the caller.
+// Returns the position of the length field, see finishFrame().
+static size_t startFrame(string& out, BinaryFrameType type)
+{
+	size_t pos = out.size();
+	appendU32(out, 0); // filled in later
+	out += char(type);
+	return pos;
+}
+
+static void finishFrame(string& out, size_t pos)
+{
+	Endian::write_UA_L32(&out[pos], uint32_t(out.size() - pos - 4));
+}
+
+static void appendReply(string& out, uint32_t tag, bool ok,
+                        const char* data, size_t size)
+{
+	auto pos = startFrame(out, BIN_REPLY);
+	appendU32(out, tag);
+	out += char(ok ? 1 : 0);
+	out.append(data, size);
+	finishFrame(out, pos);
+}
+
+
 // class CliConnection
 
 CliConnection::CliConnection(CommandController& commandController_,
                              EventDistributor& eventDistributor_)
-	: parser([this](const std::string& cmd) { execute(cmd); })
-	, commandController(commandController_)
+	: commandController(commandController_)
 	, eventDistributor(eventDistributor_)
+	, parser([this](const std::string& cmd) { execute(cmd, false); })
+	, binaryInputMode(false)
+	, skipSeparator(false)
+	, binaryOutputMode(false)
 {
 	for (auto& en : updateEnabled) {
 		en = false;
@@ -85,6 +177,15 @@ CliConnection::~CliConnection()
 
 void CliConnection::log(CliComm::LogLevel level, string_ref message)
 {
+	if (binaryOutputMode) {
+		string out;
+		auto pos = startFrame(out, BIN_LOG);
+		out += char(level);
+		out.append(message.data(), message.size());
+		finishFrame(out, pos);
+		output(out);
+		return;
+	}
 	auto levelStr = CliComm::getLevelStrings();
 	output(StringOp::Builder() <<
 		"<log level=\"" << levelStr[level] << "\">" <<
@@ -96,6 +197,19 @@ void CliConnection::update(CliComm::UpdateType type, string_ref machine,
 {
 	if (!getUpdateEnable(type)) return;
 
+	if (binaryOutputMode) {
+		string out;
+		auto pos = startFrame(out, BIN_UPDATE);
+		out += char(type);
+		appendU16(out, uint16_t(machine.size()));
+		out.append(machine.data(), machine.size());
+		appendU16(out, uint16_t(name.size()));
+		out.append(name.data(), name.size());
+		out.append(value.data(), value.size());
+		finishFrame(out, pos);
+		output(out);
+		return;
+	}
 	auto updateStr = CliComm::getUpdateStrings();
 	StringOp::Builder tmp;
 	tmp << "<update type=\"" << updateStr[type] << '\"';
@@ -122,7 +236,9 @@ void CliConnection::start()
 
 void CliConnection::end()
 {
-	output("</openmsx-output>\n");
+	if (!binaryOutputMode) {
+		output("</openmsx-output>\n");
+	}
 	close();
 
 	poller.abort();
@@ -132,10 +248,50 @@ void CliConnection::end()
 	}
 }
 
-void CliConnection::execute(const string& command)
+bool CliConnection::received(const char* buf, size_t n)
 {
+	// runs in helper thread
+	size_t i = 0;
+	while (!binaryInputMode && (i < n)) {
+		// Byte per byte, the protocol can switch halfway the buffer.
+		parser.parse(&buf[i++], 1);
+	}
+	// Skip a line terminator (or other whitespace) after the switch
+	// command. Once the "binary" reply is sent, the client may send
+	// frames, and then a whitespace value is (part of) a frame length.
+	while (skipSeparator && (i < n)) {
+		if (binaryOutputMode || !isspace(static_cast<unsigned char>(buf[i]))) {
+			skipSeparator = false;
+		} else {
+			++i;
+		}
+	}
+	if (i == n) return true;
+
+	binaryInput.append(buf + i, n - i);
+	size_t pos = 0;
+	while ((binaryInput.size() - pos) >= 4) {
+		uint32_t len = Endian::read_UA_L32(&binaryInput[pos]);
+		if ((len == 0) || (len > MAX_FRAME_SIZE)) return false;
+		if ((binaryInput.size() - pos - 4) < len) break; // incomplete
+		execute(binaryInput.substr(pos + 4, len), true);
+		pos += 4 + len;
+	}
+	binaryInput.erase(0, pos);
+	return true;
+}
+
+void CliConnection::execute(const string& command, bool binary)
+{
+	// runs in helper thread
+	if (!binary && (command == BINARY_PROTOCOL_COMMAND)) {
+		// The remaining input is binary. The output only switches once
+		// the replies for all earlier commands are sent.
+		binaryInputMode = true;
+		skipSeparator = true;
+	}
 	eventDistributor.distributeEvent(
-		std::make_shared<CliCommandEvent>(command, this));
+		std::make_shared<CliCommandEvent>(command, this, binary));
 }
 
 static string reply(const string& message, bool status)
@@ -145,13 +301,102 @@ static string reply(const string& message, bool status)
 		XMLElement::XMLEscape(message) << "</reply>\n";
 }
 
+void CliConnection::executeBinary(const string& frame, string& out)
+{
+	// 'frame' is a complete frame without the length field
+	auto type = uint8_t(frame[0]);
+	if (type == BIN_BATCH) {
+		size_t pos = 1;
+		while ((frame.size() - pos) >= 4) {
+			uint32_t len = Endian::read_UA_L32(&frame[pos]);
+			if ((len == 0) || ((frame.size() - pos - 4) < len)) break;
+			executeBinary(frame.substr(pos + 4, len), out);
+			pos += 4 + len;
+		}
+		if (pos != frame.size()) {
+			static const char msg[] = "Malformed batch frame";
+			appendReply(out, 0, false, msg, sizeof(msg) - 1);
+		}
+		return;
+	}
+
+	uint32_t tag = (frame.size() >= 5) ? Endian::read_UA_L32(&frame[1]) : 0;
+	try {
+		switch (type) {
+		case BIN_COMMAND: {
+			if (frame.size() < 5) break;
+			string result = commandController.executeCommand(
+				frame.substr(5), this).getString().str();
+			appendReply(out, tag, true, result.data(), result.size());
+			return;
+		}
+		case BIN_READ: {
+			if (frame.size() < 13) break;
+			// Equivalent to 'debug read_block', but without the
+			// conversion to a (escaped) string.
+			TclObject command;
+			command.addListElement("debug");
+			command.addListElement("read_block");
+			command.addListElement(string_ref(frame).substr(13));
+			command.addListElement(int(Endian::read_UA_L32(&frame[5])));
+			command.addListElement(int(Endian::read_UA_L32(&frame[9])));
+			auto result = command.executeCommand(
+				commandController.getInterpreter());
+			unsigned size;
+			auto* data = result.getBinary(size);
+			appendReply(out, tag, true,
+			            reinterpret_cast<const char*>(data), size);
+			return;
+		}
+		case BIN_WRITE: {
+			if (frame.size() < 11) break;
+			size_t nameLen = Endian::read_UA_L16(&frame[9]);
+			if (frame.size() < (11 + nameLen)) break;
+			// Equivalent to 'debug write_block' (so it's also
+			// recorded for replay).
+			string data = frame.substr(11 + nameLen);
+			TclObject block;
+			block.setBinary(reinterpret_cast<byte*>(&data[0]),
+			                unsigned(data.size()));
+			TclObject command;
+			command.addListElement("debug");
+			command.addListElement("write_block");
+			command.addListElement(string_ref(frame).substr(11, nameLen));
+			command.addListElement(int(Endian::read_UA_L32(&frame[5])));
+			command.addListElement(block);
+			command.executeCommand(commandController.getInterpreter());
+			appendReply(out, tag, true, nullptr, 0);
+			return;
+		}
+		}
+		static const char msg[] = "Malformed frame";
+		appendReply(out, tag, false, msg, sizeof(msg) - 1);
+	} catch (CommandException& e) {
+		const auto& msg = e.getMessage();
+		appendReply(out, tag, false, msg.data(), msg.size());
+	}
+}
+
 int CliConnection::signalEvent(const std::shared_ptr<const Event>& event)
 {
 	auto& commandEvent = checked_cast<const CliCommandEvent&>(*event);
-	if (commandEvent.getId() == this) {
+	if (commandEvent.getId() != this) return 0;
+
+	const auto& command = commandEvent.getCommand();
+	if (commandEvent.isBinary()) {
+		string out;
+		executeBinary(command, out);
+		output(out);
+	} else if (command == BINARY_PROTOCOL_COMMAND) {
+		// Switch before sending the reply: the helper thread must
+		// not skip whitespace anymore once the client can react.
+		string out = reply("binary", true);
+		binaryOutputMode = true;
+		output(out);
+	} else {
 		try {
 			string result = commandController.executeCommand(
-				commandEvent.getCommand(), this).getString().str();
+				command, this).getString().str();
 			output(reply(result, true));
 		} catch (CommandException& e) {
 			string result = e.getMessage() + '\n';
@@ -189,7 +434,7 @@ void StdioConnection::run()
 		char buf[BUF_SIZE];
 		int n = read(STDIN_FILENO, buf, sizeof(buf));
 		if (n > 0) {
-			parser.parse(buf, n);
+			if (!received(buf, n)) break;
 		} else if (n < 0) {
 			break;
 		}
@@ -283,7 +528,7 @@ void PipeConnection::run()
 			if (!GetOverlappedResult(pipeHandle, &overlapped, &bytesRead, TRUE)) {
 				break; // Pipe broke
 			}
-			parser.parse(buf, bytesRead);
+			if (!received(buf, bytesRead)) break;
 		}
 		else if (wait == WAIT_OBJECT_0) {
 			break; // Shutdown
@@ -364,7 +609,7 @@ void SocketConnection::run()
 		char buf[BUF_SIZE];
 		int n = sock_recv(sd, buf, BUF_SIZE);
 		if (n > 0) {
-			parser.parse(buf, n);
+			if (!received(buf, n)) break;
 		} else if (n < 0) {
 			break;
 		}
@@ -7,6 +7,7 @@
 #include "CliComm.hh"
 #include "AdhocCliCommParser.hh"
 #include "Poller.hh"
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -58,13 +59,19 @@ protected:
 	  */
 	void startOutput();
 
-	AdhocCliCommParser parser;
+	/** Process data received from the client (called from the helper
+	  * thread). Returns false when the connection should be closed
+	  * because of a protocol error.
+	  */
+	bool received(const char* buf, size_t n);
+
 	Poller poller;
 
 private:
 	virtual void run() = 0;
 
-	void execute(const std::string& command);
+	void execute(const std::string& command, bool binary);
+	void executeBinary(const std::string& frame, std::string& out);
 
 	// CliListener
 	void log(CliComm::LogLevel level, string_ref message) override;
@@ -79,6 +86,12 @@ private:
 
 	std::thread thread;
 
+	AdhocCliCommParser parser;
+	std::string binaryInput; // incomplete binary frame(s)
+	bool binaryInputMode;    // only accessed from helper thread
+	bool skipSeparator;      // idem, see received()
+	std::atomic<bool> binaryOutputMode;
+
 	bool updateEnabled[CliComm::NUM_UPDATES];
 };
 
@@ -10,6 +10,13 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cstdio>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
 
 using std::string;
 
@@ -18,6 +25,23 @@ namespace openmsx {
 EventDistributor::EventDistributor(Reactor& reactor_)
 	: reactor(reactor_)
 {
+#ifndef _WIN32
+	sleeping = false;
+	if (pipe(wakeupPipe)) {
+		wakeupPipe[0] = wakeupPipe[1] = -1;
+		perror("Failed to open wakeup pipe");
+	} else {
+		fcntl(wakeupPipe[0], F_SETFL, O_NONBLOCK);
+	}
+#endif
+}
+
+EventDistributor::~EventDistributor()
+{
+#ifndef _WIN32
+	close(wakeupPipe[0]);
+	close(wakeupPipe[1]);
+#endif
 }
 
 void EventDistributor::registerEventListener(
@@ -61,7 +85,16 @@ void EventDistributor::distributeEvent(const EventPtr& event)
 		//             EventDistributor::unregisterEventListener()
 		//   thread 2: EventDistributor::distributeEvent()
 		//             Reactor::enterMainLoop()
+#ifndef _WIN32
+		if (sleeping) {
+			char dummy = 'X';
+			if (write(wakeupPipe[1], &dummy, sizeof(dummy)) == -1) {
+				// nothing we can do, main thread wakes up later
+			}
+		}
+#else
 		condition.notify_all();
+#endif
 		lock.unlock();
 		reactor.enterMainLoop();
 	}
@@ -118,11 +151,46 @@ void EventDistributor::deliverEvents()
 	}
 }
 
-bool EventDistributor::sleep(unsigned us)
+void EventDistributor::waitForWork()
 {
-	std::chrono::microseconds duration(us);
-	std::unique_lock<std::mutex> lock(cvMutex);
-	return condition.wait_for(lock, duration) == std::cv_status::timeout;
+	assert(Thread::isMainThread());
+
+	// Tcl events (e.g. a 'fileevent' in a script) are only handled by
+	// Interpreter::poll(), so don't block longer than this.
+	const uint64_t TCL_POLL_INTERVAL = 100 * 1000; // 100ms
+
+	int inputFd;
+	auto timeout = std::min({
+		reactor.getRTScheduler().getTimeTillNext(),
+		reactor.getInputEventGenerator().getMaxIdleTime(inputFd),
+		TCL_POLL_INTERVAL});
+
+	std::unique_lock<std::mutex> lock(mutex);
+	// Checked under the lock, so distributeEvent() either already queued
+	// its event (we don't block) or it will see 'sleeping' (wakes us up).
+	if (!scheduledEvents.empty()) return;
+#ifndef _WIN32
+	sleeping = true;
+	lock.unlock();
+
+	int ms = int((timeout + 999) / 1000);
+	struct pollfd fds[2] = {
+		{ .fd = wakeupPipe[0], .events = POLLIN },
+		{ .fd = inputFd,       .events = POLLIN }, // ignored when -1
+	};
+	::poll(fds, 2, ms); // also returns on error or signal, that's fine
+
+	lock.lock();
+	sleeping = false;
+	char buf[16];
+	while (read(wakeupPipe[0], buf, sizeof(buf)) > 0) {
+		// drain
+	}
+#else
+	(void)inputFd; // there's no input file descriptor on windows
+	condition.wait_for(lock, std::chrono::microseconds(timeout),
+	                   [&] { return !scheduledEvents.empty(); });
+#endif
 }
 
 } // namespace openmsx
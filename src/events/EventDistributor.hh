@@ -29,6 +29,7 @@ public:
 	};
 
 	explicit EventDistributor(Reactor& reactor);
+	~EventDistributor();
 
 	/**
 	 * Registers a given object to receive certain events.
@@ -59,13 +60,14 @@ public:
 	  */
 	void deliverEvents();
 
-	/** Sleep for the specified amount of time, but return early when
-	  * (another thread) called the distributeEvent() method.
-	  * @param us Amount of time to sleep, in micro seconds.
-	  * @result true  if we return because time has passed
-	  *         false if we return because distributeEvent() was called
+	/** Block until there's work for the main loop: (another thread)
+	  * called the distributeEvent() method, an RTSchedulable expired or
+	  * new input arrived. When input can't be waited for directly (see
+	  * InputEventGenerator::getMaxIdleTime()) this returns periodically.
+	  * To still handle Tcl events it also returns at least every 100ms.
+	  * Idle openMSX instances this way need (almost) no CPU time.
 	  */
-	bool sleep(unsigned us);
+	void waitForWork();
 
 private:
 	bool isRegistered(EventType type, EventListener* listener) const;
@@ -77,8 +79,12 @@ private:
 	using EventQueue = std::vector<EventPtr>;
 	EventQueue scheduledEvents;
 	std::mutex mutex; // lock datastructures
-	std::mutex cvMutex; // lock condition_variable
+#ifndef _WIN32
+	int wakeupPipe[2];
+	bool sleeping; // main thread is blocked in waitForWork()
+#else
 	std::condition_variable condition;
+#endif
 };
 
 } // namespace openmsx
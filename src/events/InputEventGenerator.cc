@@ -4,6 +4,7 @@
 #include "IntegerSetting.hh"
 #include "GlobalSettings.hh"
 #include "Keys.hh"
+#include "MemoryPool.hh"
 #include "checked_cast.hh"
 #include "memory.hh"
 #include "outer.hh"
@@ -12,9 +13,13 @@
 #include <cassert>
 #include <iostream>
 
+#if defined(SDL_VIDEO_DRIVER_X11) && !PLATFORM_ANDROID
+#include <SDL_syswm.h>
+#define HAVE_X11_FD 1
+#endif
+
 using std::string;
 using std::vector;
-using std::make_shared;
 
 namespace openmsx {
 
@@ -71,6 +76,53 @@ void InputEventGenerator::wait()
 	}
 }
 
+uint64_t InputEventGenerator::getMaxIdleTime(int& fd) const
+{
+	// SDL-1.2 only offers a polling interface. For the cases we can't
+	// wait for a file descriptor, poll at this interval.
+	const uint64_t POLL_INTERVAL = 20 * 1000; // 20ms
+
+	fd = -1;
+#ifndef SDL_JOYSTICK_DISABLED
+	if (SDL_WasInit(SDL_INIT_JOYSTICK) && (SDL_NumJoysticks() > 0)) {
+		// joystick state is only read while polling
+		return POLL_INTERVAL;
+	}
+#endif
+	if (!SDL_WasInit(SDL_INIT_VIDEO)) {
+		// no window, so no keyboard, mouse or window events
+		return uint64_t(-1);
+	}
+	if (SDL_PeepEvents(nullptr, 1, SDL_PEEKEVENT, SDL_ALLEVENTS) > 0) {
+		// already queued in SDL (e.g. pumped by other code)
+		return 0;
+	}
+	if (keyRepeat) {
+		// key repeat events are generated while polling
+		return POLL_INTERVAL;
+	}
+#ifdef HAVE_X11_FD
+	SDL_SysWMinfo info;
+	SDL_VERSION(&info.version);
+	if ((SDL_GetWMInfo(&info) == 1) &&
+	    (info.subsystem == SDL_SYSWM_X11)) {
+		// All input (and window events) arrives via the connection
+		// with the X server. But other Xlib or GLX calls (e.g. an OSD
+		// repaint) may already have read events into Xlib's queue,
+		// then the connection doesn't become readable for them. Let
+		// SDL move those into its own queue and check that again.
+		SDL_PumpEvents();
+		if (SDL_PeepEvents(nullptr, 1, SDL_PEEKEVENT, SDL_ALLEVENTS) > 0) {
+			return 0;
+		}
+		Display* display = info.info.x11.display;
+		fd = ConnectionNumber(display);
+		return uint64_t(-1);
+	}
+#endif
+	return POLL_INTERVAL;
+}
+
 void InputEventGenerator::poll()
 {
 	SDL_Event event;
@@ -123,11 +175,11 @@ void InputEventGenerator::setNewOsdControlButtonState(
 		if (deltaState & (1 << i)) {
 			if (newState & (1 << i)) {
 				eventDistributor.distributeEvent(
-					make_shared<OsdControlReleaseEvent>(
+					make_pooled_shared<OsdControlReleaseEvent>(
 						i, origEvent));
 			} else {
 				eventDistributor.distributeEvent(
-					make_shared<OsdControlPressEvent>(
+					make_pooled_shared<OsdControlPressEvent>(
 						i, origEvent));
 			}
 		}
@@ -241,12 +293,12 @@ void InputEventGenerator::handle(const SDL_Event& evt)
 		// interpeted here as joystick buttons (respectively button 0
 		// and 1).
 		if (PLATFORM_ANDROID && evt.key.keysym.sym == SDLK_WORLD_93) {
-			event = make_shared<JoystickButtonUpEvent>(0, 0);
+			event = make_pooled_shared<JoystickButtonUpEvent>(0, 0);
 			triggerOsdControlEventsFromJoystickButtonEvent(
 				0, true, event);
 			androidButtonA = false;
 		} else if (PLATFORM_ANDROID && evt.key.keysym.sym == SDLK_WORLD_94) {
-			event = make_shared<JoystickButtonUpEvent>(0, 1);
+			event = make_pooled_shared<JoystickButtonUpEvent>(0, 1);
 			triggerOsdControlEventsFromJoystickButtonEvent(
 				1, true, event);
 			androidButtonB = false;
@@ -254,19 +306,19 @@ void InputEventGenerator::handle(const SDL_Event& evt)
 			auto keyCode = Keys::getCode(
 				evt.key.keysym.sym, evt.key.keysym.mod,
 				evt.key.keysym.scancode, true);
-			event = make_shared<KeyUpEvent>(
+			event = make_pooled_shared<KeyUpEvent>(
 				keyCode, evt.key.keysym.unicode);
 			triggerOsdControlEventsFromKeyEvent(keyCode, true, event);
 		}
 		break;
 	case SDL_KEYDOWN:
 		if (PLATFORM_ANDROID && evt.key.keysym.sym == SDLK_WORLD_93) {
-			event = make_shared<JoystickButtonDownEvent>(0, 0);
+			event = make_pooled_shared<JoystickButtonDownEvent>(0, 0);
 			triggerOsdControlEventsFromJoystickButtonEvent(
 				0, false, event);
 			androidButtonA = true;
 		} else if (PLATFORM_ANDROID && evt.key.keysym.sym == SDLK_WORLD_94) {
-			event = make_shared<JoystickButtonDownEvent>(0, 1);
+			event = make_pooled_shared<JoystickButtonDownEvent>(0, 1);
 			triggerOsdControlEventsFromJoystickButtonEvent(
 				1, false, event);
 			androidButtonB = true;
@@ -274,32 +326,32 @@ void InputEventGenerator::handle(const SDL_Event& evt)
 			auto keyCode = Keys::getCode(
 				evt.key.keysym.sym, evt.key.keysym.mod,
 				evt.key.keysym.scancode, false);
-			event = make_shared<KeyDownEvent>(
+			event = make_pooled_shared<KeyDownEvent>(
 				keyCode, evt.key.keysym.unicode);
 			triggerOsdControlEventsFromKeyEvent(keyCode, false, event);
 		}
 		break;
 
 	case SDL_MOUSEBUTTONUP:
-		event = make_shared<MouseButtonUpEvent>(evt.button.button);
+		event = make_pooled_shared<MouseButtonUpEvent>(evt.button.button);
 		break;
 	case SDL_MOUSEBUTTONDOWN:
-		event = make_shared<MouseButtonDownEvent>(evt.button.button);
+		event = make_pooled_shared<MouseButtonDownEvent>(evt.button.button);
 		break;
 	case SDL_MOUSEMOTION:
-		event = make_shared<MouseMotionEvent>(
+		event = make_pooled_shared<MouseMotionEvent>(
 			evt.motion.xrel, evt.motion.yrel,
 			evt.motion.x,    evt.motion.y);
 		break;
 
 	case SDL_JOYBUTTONUP:
-		event = make_shared<JoystickButtonUpEvent>(
+		event = make_pooled_shared<JoystickButtonUpEvent>(
 			evt.jbutton.which, evt.jbutton.button);
 		triggerOsdControlEventsFromJoystickButtonEvent(
 			evt.jbutton.button, true, event);
 		break;
 	case SDL_JOYBUTTONDOWN:
-		event = make_shared<JoystickButtonDownEvent>(
+		event = make_pooled_shared<JoystickButtonDownEvent>(
 			evt.jbutton.which, evt.jbutton.button);
 		triggerOsdControlEventsFromJoystickButtonEvent(
 			evt.jbutton.button, false, event);
@@ -310,32 +362,32 @@ void InputEventGenerator::handle(const SDL_Event& evt)
 		auto value = (evt.jaxis.value < -threshold) ? evt.jaxis.value
 		           : (evt.jaxis.value >  threshold) ? evt.jaxis.value
 		                                            : 0;
-		event = make_shared<JoystickAxisMotionEvent>(
+		event = make_pooled_shared<JoystickAxisMotionEvent>(
 			evt.jaxis.which, evt.jaxis.axis, value);
 		triggerOsdControlEventsFromJoystickAxisMotion(
 			evt.jaxis.axis, value, event);
 		break;
 	}
 	case SDL_JOYHATMOTION:
-		event = make_shared<JoystickHatEvent>(
+		event = make_pooled_shared<JoystickHatEvent>(
 			evt.jhat.which, evt.jhat.hat, evt.jhat.value);
 		triggerOsdControlEventsFromJoystickHat(evt.jhat.value, event);
 		break;
 
 	case SDL_ACTIVEEVENT:
-		event = make_shared<FocusEvent>(evt.active.gain != 0);
+		event = make_pooled_shared<FocusEvent>(evt.active.gain != 0);
 		break;
 
 	case SDL_VIDEORESIZE:
-		event = make_shared<ResizeEvent>(evt.resize.w, evt.resize.h);
+		event = make_pooled_shared<ResizeEvent>(evt.resize.w, evt.resize.h);
 		break;
 
 	case SDL_VIDEOEXPOSE:
-		event = make_shared<SimpleEvent>(OPENMSX_EXPOSE_EVENT);
+		event = make_pooled_shared<SimpleEvent>(OPENMSX_EXPOSE_EVENT);
 		break;
 
 	case SDL_QUIT:
-		event = make_shared<QuitEvent>();
+		event = make_pooled_shared<QuitEvent>();
 		break;
 
 	default:
@@ -56,6 +56,13 @@ public:
 
 	void poll();
 
+	/** For the main loop when it has nothing to do: how long (in us) it
+	  * may block before poll() must be called again, uint64_t(-1) means
+	  * unlimited. When available 'fd' is set to a file descriptor that
+	  * becomes readable when new input arrives (otherwise it's set to -1).
+	  */
+	uint64_t getMaxIdleTime(int& fd) const;
+
 private:
 	using EventPtr = std::shared_ptr<const Event>;
 
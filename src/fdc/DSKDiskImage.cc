@@ -21,14 +21,26 @@ DSKDiskImage::DSKDiskImage(const Filename& fileName,
 
 void DSKDiskImage::readSectorImpl(size_t sector, SectorBuffer& buf)
 {
-	file->seek(sector * sizeof(buf));
-	file->read(&buf, sizeof(buf));
+	readSectorsImpl(&buf, sector, 1);
 }
 
 void DSKDiskImage::writeSectorImpl(size_t sector, const SectorBuffer& buf)
 {
-	file->seek(sector * sizeof(buf));
-	file->write(&buf, sizeof(buf));
+	writeSectorsImpl(&buf, sector, 1);
+}
+
+void DSKDiskImage::readSectorsImpl(
+	SectorBuffer* buffers, size_t startSector, size_t num)
+{
+	file->seek(startSector * sizeof(SectorBuffer));
+	file->read(buffers, num * sizeof(SectorBuffer));
+}
+
+void DSKDiskImage::writeSectorsImpl(
+	const SectorBuffer* buffers, size_t startSector, size_t num)
+{
+	file->seek(startSector * sizeof(SectorBuffer));
+	file->write(buffers, num * sizeof(SectorBuffer));
 }
 
 bool DSKDiskImage::isWriteProtectedImpl() const
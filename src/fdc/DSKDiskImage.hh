@@ -17,6 +17,10 @@ public:
 private:
 	void readSectorImpl (size_t sector,       SectorBuffer& buf) override;
 	void writeSectorImpl(size_t sector, const SectorBuffer& buf) override;
+	void readSectorsImpl (      SectorBuffer* buffers,
+	                      size_t startSector, size_t num) override;
+	void writeSectorsImpl(const SectorBuffer* buffers,
+	                      size_t startSector, size_t num) override;
 	bool isWriteProtectedImpl() const override;
 	Sha1Sum getSha1SumImpl(FilePool& filepool) override;
 
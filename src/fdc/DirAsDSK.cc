@@ -265,6 +265,8 @@ DirAsDSK::DirAsDSK(DiskChanger& diskChanger_, CliComm& cliComm_,
 	, hostDir(hostDir_.getResolved() + '/')
 	, syncMode(syncMode_)
 	, lastAccess(EmuTime::zero)
+	, hostScanner(hostDir)
+	, msxModified(true)
 	, nofSectors((diskChanger_.isDoubleSidedDrive() ? 2 : 1) * SECTORS_PER_TRACK * NUM_TRACKS)
 	, nofSectorsPerFat((((3 * nofSectors) / (2 * SECTORS_PER_CLUSTER)) + SECTOR_SIZE - 1) / SECTOR_SIZE)
 	, firstSector2ndFAT(FIRST_FAT_SECTOR + nofSectorsPerFat)
@@ -365,8 +367,7 @@ void DirAsDSK::readSectorImpl(size_t sector, SectorBuffer& buf)
 			// Happens when dirasdisk is used in virtual_drive.
 			needSync = true;
 		}
-		if (needSync) {
-			syncWithHost();
+		if (needSync && syncWithHost()) {
 			flushCaches(); // e.g. sha1sum
 			// Let the diskdrive report the disk has been ejected.
 			// E.g. a turbor machine uses this to flush its
@@ -379,8 +380,21 @@ void DirAsDSK::readSectorImpl(size_t sector, SectorBuffer& buf)
 	memcpy(&buf, &sectors[sector], sizeof(buf));
 }
 
-void DirAsDSK::syncWithHost()
+bool DirAsDSK::syncWithHost()
 {
+	// Skip the whole sync when neither the host directory nor the virtual
+	// disk changed since the previous sync (then it would be a no-op).
+	// The background scanner also provides a snapshot of the host
+	// directory, so that the steps below don't have to walk the host
+	// filesystem on this thread.
+	bool hostChanged;
+	hostSnapshot = hostScanner.getSnapshot(hostChanged);
+	if (!hostChanged && !msxModified) {
+		hostSnapshot.reset();
+		return false;
+	}
+	msxModified = false;
+
 	// Check for removed host files. This frees up space in the virtual
 	// disk. Do this first because otherwise later actions may fail (run
 	// out of virtual disk space) for no good reason.
@@ -394,6 +408,39 @@ void DirAsDSK::syncWithHost()
 
 	// Last add new host files (this can only consume virtual disk space).
 	addNewHostFiles("", firstDirSector);
+
+	hostSnapshot.reset();
+	return true;
+}
+
+bool DirAsDSK::getHostStat(const string& hostPath, FileOperations::Stat& fst)
+{
+	if (hostSnapshot) {
+		auto it = hostSnapshot->entries.find(hostPath);
+		if (it != end(hostSnapshot->entries)) {
+			fst = it->second;
+			return true;
+		}
+		// Not in the snapshot, typically because the file no longer
+		// exists. Fall back to the host filesystem to be sure.
+	}
+	return FileOperations::getStat(hostDir + hostPath, fst);
+}
+
+vector<string> DirAsDSK::readHostDir(const string& hostSubDir)
+{
+	if (hostSnapshot) {
+		auto it = hostSnapshot->dirs.find(hostSubDir);
+		if (it != end(hostSnapshot->dirs)) {
+			return it->second;
+		}
+	}
+	vector<string> hostNames;
+	ReadDir dir(hostDir + hostSubDir);
+	while (auto* d = dir.getEntry()) {
+		hostNames.emplace_back(d->d_name);
+	}
+	return hostNames;
 }
 
 void DirAsDSK::checkDeletedHostFiles()
@@ -414,11 +461,10 @@ void DirAsDSK::checkDeletedHostFiles()
 		}
 		const DirIndex& dirIndex = p.first;
 		MapDir& mapDir = p.second;
-		string fullHostName = hostDir + mapDir.hostName;
 		bool isMSXDirectory = (msxDir(dirIndex).attrib &
 		                       MSXDirEntry::ATT_DIRECTORY) != 0;
 		FileOperations::Stat fst;
-		if ((!FileOperations::getStat(fullHostName, fst)) ||
+		if ((!getHostStat(mapDir.hostName, fst)) ||
 		    (FileOperations::isDirectory(fst) != isMSXDirectory)) {
 			// TODO also check access permission
 			// Error stat-ing file, or directory/file type is not
@@ -504,11 +550,10 @@ void DirAsDSK::checkModifiedHostFiles()
 		}
 		const DirIndex& dirIndex = p.first;
 		MapDir& mapDir = p.second;
-		string fullHostName = hostDir + mapDir.hostName;
 		bool isMSXDirectory = (msxDir(dirIndex).attrib &
 		                       MSXDirEntry::ATT_DIRECTORY) != 0;
 		FileOperations::Stat fst;
-		if (FileOperations::getStat(fullHostName, fst) &&
+		if (getHostStat(mapDir.hostName, fst) &&
 		    (FileOperations::isDirectory(fst) == isMSXDirectory)) {
 			// Detect changes in host file.
 			// Heuristic: we use filesize and modification time to detect
@@ -693,13 +738,7 @@ void DirAsDSK::addNewHostFiles(const string& hostSubDir, unsigned msxDirSector)
 	assert(!StringOp::startsWith(hostSubDir, '/'));
 	assert(hostSubDir.empty() || StringOp::endsWith(hostSubDir, '/'));
 
-	vector<string> hostNames;
-	{
-		ReadDir dir(hostDir + hostSubDir);
-		while (auto* d = dir.getEntry()) {
-			hostNames.emplace_back(d->d_name);
-		}
-	}
+	vector<string> hostNames = readHostDir(hostSubDir);
 	sort(begin(hostNames), end(hostNames),
 	     [](const string& l, const string& r) { return weight(l) < weight(r); });
 
@@ -712,7 +751,7 @@ void DirAsDSK::addNewHostFiles(const string& hostSubDir, unsigned msxDirSector)
 			}
 			string fullHostName = hostDir + hostSubDir + hostName;
 			FileOperations::Stat fst;
-			if (!FileOperations::getStat(fullHostName, fst)) {
+			if (!getHostStat(hostSubDir + hostName, fst)) {
 				throw MSXException("Error accessing " + fullHostName);
 			}
 			if (FileOperations::isDirectory(fst)) {
@@ -896,6 +935,7 @@ void DirAsDSK::writeSectorImpl(size_t sector_, const SectorBuffer& buf)
 	if (auto* scheduler = diskChanger.getScheduler()) {
 		lastAccess = scheduler->getCurrentTime();
 	}
+	msxModified = true;
 
 	DirIndex dirDirIndex;
 	if (sector == 0) {
@@ -4,8 +4,10 @@
 #include "SectorBasedDisk.hh"
 #include "DiskImageUtils.hh"
 #include "FileOperations.hh"
+#include "HostDirScanner.hh"
 #include "EmuTime.hh"
 #include <map>
+#include <memory>
 
 namespace openmsx {
 
@@ -61,7 +63,9 @@ private:
 	void writeDataSector(unsigned sector, const SectorBuffer& buf);
 	void writeDIREntry(DirIndex dirIndex, DirIndex dirDirIndex,
 	                   const MSXDirEntry& newEntry);
-	void syncWithHost();
+	bool syncWithHost();
+	bool getHostStat(const std::string& hostPath, FileOperations::Stat& fst);
+	std::vector<std::string> readHostDir(const std::string& hostSubDir);
 	void checkDeletedHostFiles();
 	void deleteMSXFile(DirIndex dirIndex);
 	void deleteMSXFilesInDir(unsigned msxDirSector);
@@ -121,6 +125,15 @@ private:
 
 	EmuTime lastAccess; // last time there was a sector read/write
 
+	// Watches the host directory in the background, allows to skip or
+	// speed up syncWithHost().
+	HostDirScanner hostScanner;
+	// Host directory snapshot used during syncWithHost(), nullptr when
+	// the host filesystem must be accessed directly.
+	std::shared_ptr<const HostDirScanner::Snapshot> hostSnapshot;
+	// Has the virtual disk been written since the last syncWithHost()?
+	bool msxModified;
+
 	// For each directory entry that has a mapped host file/directory we
 	// store the name, last modification time and size of the corresponding
 	// host file/dir.
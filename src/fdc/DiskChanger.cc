@@ -3,6 +3,7 @@
 #include "DummyDisk.hh"
 #include "RamDSKDiskImage.hh"
 #include "DirAsDSK.hh"
+#include "SectorBasedDisk.hh"
 #include "CommandController.hh"
 #include "RecordedCommand.hh"
 #include "StateChangeDistributor.hh"
@@ -172,8 +173,18 @@ void DiskChanger::insertDisk(array_ref<TclObject> args)
 	auto& diskFactory = reactor.getDiskFactory();
 	std::unique_ptr<Disk> newDisk(diskFactory.createDisk(diskImage, *this));
 	for (unsigned i = 2; i < args.size(); ++i) {
-		newDisk->applyPatch(Filename(
-			args[i].getString().str(), userFileContext()));
+		if (args[i].getString() == "-overlay") {
+			// Other disk types (DMK) don't write via writeSector().
+			if (!dynamic_cast<SectorBasedDisk*>(newDisk.get())) {
+				throw MSXException(
+					"An overlay is not supported for this "
+					"type of disk image.");
+			}
+			newDisk->enableOverlay();
+		} else {
+			newDisk->applyPatch(Filename(
+				args[i].getString().str(), userFileContext()));
+		}
 	}
 
 	// no errors, only now replace original disk
@@ -221,6 +232,9 @@ void DiskCommand::execute(array_ref<TclObject> tokens, TclObject& result)
 		if (diskChanger.disk->isWriteProtected()) {
 			options.addListElement("readonly");
 		}
+		if (diskChanger.disk->hasOverlay()) {
+			options.addListElement("overlay");
+		}
 		if (options.getListLength(getInterpreter()) != 0) {
 			result.addListElement(options);
 		}
@@ -283,7 +297,9 @@ string DiskCommand::help(const vector<string>& /*tokens*/) const
 	       driveName + " <filename>        : change the disk file\n" +
 	       driveName + "                   : show which disk image is in drive\n" +
 	       "The following options are supported when inserting a disk image:\n" +
-	       "-ips <filename> : apply the given IPS patch to the disk image";
+	       "-ips <filename> : apply the given IPS patch to the disk image\n" +
+	       "-overlay        : don't write to the disk image, instead keep the\n" +
+	       "                  changes in memory (and in savestates)";
 }
 
 void DiskCommand::tabCompletion(vector<string>& tokens) const
@@ -308,6 +324,7 @@ static string calcSha1(SectorAccessibleDisk* disk, FilePool& filePool)
 
 // version 1:  initial version
 // version 2:  replaced Filename with DiskName
+// version 3:  added overlay
 template<typename Archive>
 void DiskChanger::serialize(Archive& ar, unsigned version)
 {
@@ -331,6 +348,14 @@ void DiskChanger::serialize(Archive& ar, unsigned version)
 	}
 	ar.serialize("patches", patches);
 
+	bool overlay = false;
+	if (ar.versionAtLeast(version, 3)) {
+		if (!ar.isLoader()) {
+			overlay = disk->hasOverlay();
+		}
+		ar.serialize("overlay", overlay);
+	}
+
 	auto& filePool = reactor.getFilePool();
 	string oldChecksum;
 	if (!ar.isLoader()) {
@@ -362,6 +387,9 @@ void DiskChanger::serialize(Archive& ar, unsigned version)
 				p.updateAfterLoadState();
 				args.emplace_back(p.getResolved()); // TODO
 			}
+			if (overlay) {
+				args.emplace_back("-overlay");
+			}
 
 			try {
 				insertDisk(args);
@@ -388,6 +416,11 @@ void DiskChanger::serialize(Archive& ar, unsigned version)
 		}
 	}
 
+	// Only the changes, the checksum above is without the overlay.
+	if (overlay) {
+		disk->serializeOverlay(ar);
+	}
+
 	// This should only be restored after disk is inserted
 	ar.serialize("diskChanged", diskChangedFlag);
 }
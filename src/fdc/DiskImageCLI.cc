@@ -47,9 +47,17 @@ void DiskImageCLI::parse(string_ref drive, string_ref image,
 	TclObject command;
 	command.addListElement(drive);
 	command.addListElement(image);
-	while (peekArgument(cmdLine) == "-ips") {
-		cmdLine.pop_front();
-		command.addListElement(getArgument("-ips", cmdLine));
+	while (true) {
+		string option = peekArgument(cmdLine);
+		if (option == "-ips") {
+			cmdLine.pop_front();
+			command.addListElement(getArgument("-ips", cmdLine));
+		} else if (option == "-overlay") {
+			cmdLine.pop_front();
+			command.addListElement("-overlay");
+		} else {
+			break;
+		}
 	}
 	command.executeCommand(parser.getInterpreter());
 }
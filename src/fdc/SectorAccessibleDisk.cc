@@ -2,9 +2,13 @@
 #include "EmptyDiskPatch.hh"
 #include "IPSPatch.hh"
 #include "DiskExceptions.hh"
+#include "MemBuffer.hh"
 #include "sha1.hh"
+#include "serialize.hh"
+#include "serialize_stl.hh"
 #include "xrange.hh"
 #include "memory.hh"
+#include <cassert>
 
 namespace openmsx {
 
@@ -17,6 +21,7 @@ const size_t SectorAccessibleDisk::SECTOR_SIZE;
 
 SectorAccessibleDisk::SectorAccessibleDisk()
 	: patch(make_unique<EmptyDiskPatch>(*this))
+	, overlayEnabled(false)
 	, forcedWriteProtect(false)
 	, peekMode(false)
 {
@@ -34,9 +39,23 @@ void SectorAccessibleDisk::readSector(size_t sector, SectorBuffer& buf)
 	    (getNbSectors() <= sector)) {
 		throw NoSuchSectorException("No such sector");
 	}
+	if (!overlay.empty()) {
+		auto it = overlay.find(sector);
+		if (it != overlay.end()) {
+			buf = it->second;
+			return;
+		}
+	}
+	readBaseSectors(&buf, sector, 1);
+}
+
+void SectorAccessibleDisk::readBaseSectors(
+	SectorBuffer* buffers, size_t startSector, size_t num)
+{
 	try {
-		// in the end this calls readSectorImpl()
-		patch->copyBlock(sector * sizeof(buf), buf.raw, sizeof(buf));
+		// in the end this calls readSectorsImpl()
+		patch->copyBlock(startSector * SECTOR_SIZE, buffers[0].raw,
+		                 num * SECTOR_SIZE);
 	} catch (MSXException& e) {
 		throw DiskIOErrorException("Disk I/O error: " + e.getMessage());
 	}
@@ -50,6 +69,10 @@ void SectorAccessibleDisk::writeSector(size_t sector, const SectorBuffer& buf)
 	if (!isDummyDisk() && (getNbSectors() <= sector)) {
 		throw NoSuchSectorException("No such sector");
 	}
+	if (overlayEnabled) {
+		writeOverlay(&buf, sector, 1);
+		return;
+	}
 	try {
 		writeSectorImpl(sector, buf);
 	} catch (MSXException& e) {
@@ -58,6 +81,34 @@ void SectorAccessibleDisk::writeSector(size_t sector, const SectorBuffer& buf)
 	flushCaches();
 }
 
+void SectorAccessibleDisk::writeOverlay(
+	const SectorBuffer* buffers, size_t startSector, size_t num)
+{
+	for (auto i : xrange(num)) {
+		overlay[startSector + i] = buffers[i];
+	}
+	// The sha1sum doesn't include the overlay, so it remains valid.
+	auto sum = sha1cache;
+	flushCaches();
+	sha1cache = sum;
+}
+
+void SectorAccessibleDisk::readSectorsImpl(
+	SectorBuffer* buffers, size_t startSector, size_t num)
+{
+	for (auto i : xrange(num)) {
+		readSectorImpl(startSector + i, buffers[i]);
+	}
+}
+
+void SectorAccessibleDisk::writeSectorsImpl(
+	const SectorBuffer* buffers, size_t startSector, size_t num)
+{
+	for (auto i : xrange(num)) {
+		writeSectorImpl(startSector + i, buffers[i]);
+	}
+}
+
 size_t SectorAccessibleDisk::getNbSectors() const
 {
 	return getNbSectorsImpl();
@@ -78,6 +129,51 @@ bool SectorAccessibleDisk::hasPatches() const
 	return !patch->isEmptyPatch();
 }
 
+void SectorAccessibleDisk::enableOverlay()
+{
+	overlay.clear();
+	overlayEnabled = true;
+	flushCaches();
+}
+
+template<typename Archive>
+void SectorAccessibleDisk::serializeOverlay(Archive& ar)
+{
+	assert(overlayEnabled);
+	// the numbers of the written sectors, followed by their content
+	std::vector<unsigned> sectors;
+	if (!ar.isLoader()) {
+		for (auto& p : overlay) sectors.push_back(unsigned(p.first));
+	}
+	ar.serialize("overlaySectors", sectors);
+	if (sectors.empty()) {
+		overlay.clear();
+	} else {
+		MemBuffer<SectorBuffer> data(sectors.size());
+		if (!ar.isLoader()) {
+			size_t i = 0;
+			for (auto& p : overlay) data[i++] = p.second;
+		}
+		ar.serialize_blob("overlayData", data.data(),
+		                  sectors.size() * sizeof(SectorBuffer));
+		if (ar.isLoader()) {
+			overlay.clear();
+			for (auto i : xrange(sectors.size())) {
+				overlay[sectors[i]] = data[i];
+			}
+		}
+	}
+	if (ar.isLoader()) {
+		auto sum = sha1cache;
+		flushCaches();
+		sha1cache = sum;
+	}
+}
+template void SectorAccessibleDisk::serializeOverlay(MemInputArchive&);
+template void SectorAccessibleDisk::serializeOverlay(MemOutputArchive&);
+template void SectorAccessibleDisk::serializeOverlay(XmlInputArchive&);
+template void SectorAccessibleDisk::serializeOverlay(XmlOutputArchive&);
+
 Sha1Sum SectorAccessibleDisk::getSha1Sum(FilePool& filePool)
 {
 	checkCaches();
@@ -94,7 +190,7 @@ Sha1Sum SectorAccessibleDisk::getSha1SumImpl(FilePool& /*filePool*/)
 		SHA1 sha1;
 		for (auto i : xrange(getNbSectors())) {
 			SectorBuffer buf;
-			readSector(i, buf);
+			readBaseSectors(&buf, i, 1);
 			sha1.update(buf.raw, sizeof(buf));
 		}
 		setPeekMode(false);
@@ -108,9 +204,17 @@ Sha1Sum SectorAccessibleDisk::getSha1SumImpl(FilePool& /*filePool*/)
 int SectorAccessibleDisk::readSectors (
 	SectorBuffer* buffers, size_t startSector, size_t nbSectors)
 {
+	if (nbSectors == 0) return 0;
 	try {
-		for (auto i : xrange(nbSectors)) {
-			readSector(startSector + i, buffers[i]);
+		// see readSector() for the special case of sector 0 and 1
+		auto last = startSector + nbSectors - 1;
+		if (!isDummyDisk() && (last > 1) && (getNbSectors() <= last)) {
+			return -1;
+		}
+		readBaseSectors(buffers, startSector, nbSectors);
+		for (auto it = overlay.lower_bound(startSector);
+		     (it != overlay.end()) && (it->first <= last); ++it) {
+			buffers[it->first - startSector] = it->second;
 		}
 		return 0;
 	} catch (MSXException&) {
@@ -121,19 +225,29 @@ int SectorAccessibleDisk::readSectors (
 int SectorAccessibleDisk::writeSectors(
 	const SectorBuffer* buffers, size_t startSector, size_t nbSectors)
 {
+	if (nbSectors == 0) return 0;
+	if (isWriteProtected() ||
+	    (!isDummyDisk() && (getNbSectors() < (startSector + nbSectors)))) {
+		return -1;
+	}
+	if (overlayEnabled) {
+		writeOverlay(buffers, startSector, nbSectors);
+		return 0;
+	}
 	try {
-		for (auto i : xrange(nbSectors)) {
-			writeSector(startSector + i, buffers[i]);
-		}
+		writeSectorsImpl(buffers, startSector, nbSectors);
+		flushCaches();
 		return 0;
 	} catch (MSXException&) {
+		flushCaches(); // possibly partially written
 		return -1;
 	}
 }
 
 bool SectorAccessibleDisk::isWriteProtected() const
 {
-	return forcedWriteProtect || isWriteProtectedImpl();
+	return forcedWriteProtect ||
+	       (!overlayEnabled && isWriteProtectedImpl());
 }
 
 void SectorAccessibleDisk::forceWriteProtect()
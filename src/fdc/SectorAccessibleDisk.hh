@@ -4,6 +4,7 @@
 #include "DiskImageUtils.hh"
 #include "Filename.hh"
 #include "sha1.hh"
+#include <map>
 #include <vector>
 #include <memory>
 
@@ -33,13 +34,26 @@ public:
 	std::vector<Filename> getPatches() const;
 	bool hasPatches() const;
 
-	/** Calculate SHA1 of the content of this disk.
+	// copy-on-write overlay
+	/** From now on writes no longer go to the disk image, instead the
+	 * written sectors are kept in memory (and in savestates) and reads
+	 * return that data. The disk also becomes writable when the image
+	 * itself is read-only. Any earlier overlay content is discarded.
+	 */
+	void enableOverlay();
+	bool hasOverlay() const { return overlayEnabled; }
+	template<typename Archive>
+	void serializeOverlay(Archive& ar);
+
+	/** Calculate SHA1 of the content of this disk. When there's an
+	 * overlay, its content is not included.
 	 * This value is cached (and flushed on writes).
 	 */
 	Sha1Sum getSha1Sum(FilePool& filepool);
 
+	// Read/write multiple sectors at once, this is more efficient than
+	// one-per-one (e.g. a single file access).
 	// For compatibility with nowind
-	//  - read/write multiple sectors instead of one-per-one
 	//  - use error codes instead of exceptions
 	//  - different order of parameters
 	int readSectors (      SectorBuffer* buffers, size_t startSector,
@@ -61,14 +75,29 @@ protected:
 	virtual void flushCaches();
 	virtual Sha1Sum getSha1SumImpl(FilePool& filepool);
 
+	/** Like readSectors(), but ignores the overlay, doesn't check the
+	 * sector numbers and throws on errors. */
+	void readBaseSectors(SectorBuffer* buffers, size_t startSector,
+	                     size_t num);
+
 private:
+	void writeOverlay(const SectorBuffer* buffers, size_t startSector,
+	                  size_t num);
+
 	virtual void readSectorImpl (size_t sector,       SectorBuffer& buf) = 0;
 	virtual void writeSectorImpl(size_t sector, const SectorBuffer& buf) = 0;
+	// The default implementation calls the single sector versions above.
+	virtual void readSectorsImpl (      SectorBuffer* buffers,
+	                              size_t startSector, size_t num);
+	virtual void writeSectorsImpl(const SectorBuffer* buffers,
+	                              size_t startSector, size_t num);
 	virtual size_t getNbSectorsImpl() const = 0;
 	virtual bool isWriteProtectedImpl() const = 0;
 
 	std::unique_ptr<const PatchInterface> patch;
+	std::map<size_t, SectorBuffer> overlay;
 	Sha1Sum sha1cache;
+	bool overlayEnabled;
 	bool forcedWriteProtect;
 	bool peekMode;
 
@@ -1,7 +1,13 @@
 #include "CompressedFileAdapter.hh"
+#include "InflateIndex.hh"
+#include "ZlibInflate.hh"
 #include "FileException.hh"
+#include "FileOperations.hh"
 #include "hash_set.hh"
+#include "memory.hh"
+#include "sha1.hh"
 #include "xxhash.hh"
+#include <algorithm>
 #include <cstring>
 
 using std::string;
@@ -17,6 +23,20 @@ static hash_set<std::shared_ptr<CompressedFileAdapter::Decompressed>,
                 GetURLFromDecompressed, XXHasher> decompressCache;
 
 
+// The header in front of the deflate stream is never larger than this.
+static const size_t MAX_HEADER_SIZE = 1024 * 1024;
+
+CompressedFileAdapter::Decompressed::Decompressed() = default;
+CompressedFileAdapter::Decompressed::~Decompressed() = default;
+
+static string getIndexCacheFile(const string& url)
+{
+	// One cache file per compressed file, named after the sha1 of its URL.
+	return FileOperations::getUserDataDir() + "/inflateindex/" +
+	       SHA1::calc(reinterpret_cast<const uint8_t*>(url.data()),
+	                  url.size()).toString();
+}
+
 CompressedFileAdapter::CompressedFileAdapter(std::unique_ptr<FileBase> file_)
 	: file(std::move(file_)), pos(0)
 {
@@ -41,14 +61,25 @@ void CompressedFileAdapter::decompress()
 	if (it != end(decompressCache)) {
 		decompressed = *it;
 	} else {
-		decompressed = std::make_shared<Decompressed>();
-		decompress(*file, *decompressed);
-		decompressed->cachedModificationDate = getModificationDate();
-		decompressed->cachedURL = std::move(url);
+		auto d = std::make_shared<Decompressed>();
+		size_t size;
+		const byte* data = file->mmap(size);
+		ZlibInflate zlib(data, std::min(size, MAX_HEADER_SIZE));
+		skipHeader(zlib, d->originalName);
+		auto offset = zlib.getPos();
+		d->cachedModificationDate = getModificationDate();
+		d->index = make_unique<InflateIndex>(
+			data + offset, size - offset, getIndexCacheFile(url),
+			d->cachedModificationDate);
+		d->size = d->index->getSize();
+		d->cachedURL = std::move(url);
+		// the index keeps on reading from the mmap'ed file
+		d->file = std::move(file);
+		decompressed = std::move(d);
 		decompressCache.insert_noDuplicateCheck(decompressed);
 	}
 
-	// close original file after succesful decompress
+	// shared state is used from now on
 	file.reset();
 }
 
@@ -59,7 +90,11 @@ void CompressedFileAdapter::read(void* buffer, size_t num)
 		throw FileException("Read beyond end of file");
 	}
 	const auto& buf = decompressed->buf;
-	memcpy(buffer, buf.data() + pos, num);
+	if (!buf.empty()) {
+		memcpy(buffer, buf.data() + pos, num);
+	} else {
+		decompressed->index->read(pos, static_cast<byte*>(buffer), num);
+	}
 	pos += num;
 }
 
@@ -71,7 +106,13 @@ void CompressedFileAdapter::write(const void* /*buffer*/, size_t /*num*/)
 const byte* CompressedFileAdapter::mmap(size_t& size)
 {
 	decompress();
-	size = decompressed->size;
+	auto& d = *decompressed;
+	if (d.buf.empty() && d.size) {
+		// Needs the whole decompressed file in memory.
+		d.buf.resize(d.size);
+		d.index->read(0, d.buf.data(), d.size);
+	}
+	size = d.size;
 	return reinterpret_cast<const byte*>(decompressed->buf.data());
 }
 
@@ -7,11 +7,26 @@
 
 namespace openmsx {
 
+class InflateIndex;
+class ZlibInflate;
+
+/** Base class for compressed (gzip, zip) files, these contain a single
+  * deflate stream.
+  *
+  * Reads only decompress the needed part of the stream (see InflateIndex),
+  * only mmap() decompresses the whole file into memory. Adapters for the
+  * same file share this state.
+  */
 class CompressedFileAdapter : public FileBase
 {
 public:
 	struct Decompressed {
-		MemBuffer<byte> buf;
+		Decompressed();
+		~Decompressed();
+
+		std::unique_ptr<FileBase> file; // kept open for 'index'
+		std::unique_ptr<InflateIndex> index;
+		MemBuffer<byte> buf; // only filled in by mmap()
 		size_t size;
 		std::string originalName;
 		std::string cachedURL;
@@ -35,7 +50,11 @@ public:
 protected:
 	explicit CompressedFileAdapter(std::unique_ptr<FileBase> file);
 	~CompressedFileAdapter();
-	virtual void decompress(FileBase& file, Decompressed& decompressed) = 0;
+
+	/** Parse the header in front of the deflate stream, afterwards
+	  * 'zlib' must point to the start of that stream.
+	  */
+	virtual void skipHeader(ZlibInflate& zlib, std::string& originalName) = 0;
 
 private:
 	void decompress();
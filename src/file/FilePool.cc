@@ -16,13 +16,15 @@
 #include "StringOp.hh"
 #include "memory.hh"
 #include "sha1.hh"
-#include "stl.hh"
+#include "xrange.hh"
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <thread>
 #include <cassert>
+#include <cstring>
 
 using std::ifstream;
-using std::get;
-using std::make_tuple;
 using std::ofstream;
 using std::string;
 using std::vector;
@@ -43,6 +45,13 @@ private:
 
 const char* const FILE_CACHE = "/.filecache";
 
+// Hash this many (new or modified) files in one go.
+static const size_t SCAN_BATCH = 64;
+// Don't use more threads than this for hashing.
+static const unsigned MAX_THREADS = 8;
+// Larger files are hashed in the main thread, so that progress can be shown.
+static const size_t MAX_BACKGROUND_SIZE = 16 * 1024 * 1024;
+
 static string initialFilePoolSettingValue()
 {
 	TclObject result;
@@ -72,65 +81,82 @@ FilePool::FilePool(CommandController& controller, Reactor& reactor_)
 		"instead use the 'filepool' command.",
 		initialFilePoolSettingValue())
 	, reactor(reactor_)
+	, cacheLines(0)
 	, quit(false)
 {
 	filePoolSetting.attach(*this);
 	reactor.getEventDistributor().registerEventListener(OPENMSX_QUIT_EVENT, *this);
 	readSha1sums();
-	needWrite = false;
 
 	sha1SumCommand = make_unique<Sha1SumCommand>(controller, *this);
 }
 
 FilePool::~FilePool()
 {
-	if (needWrite) {
-		writeSha1sums();
-	}
 	reactor.getEventDistributor().unregisterEventListener(OPENMSX_QUIT_EVENT, *this);
 	filePoolSetting.detach(*this);
 }
 
-void FilePool::insert(const Sha1Sum& sum, time_t time, const string& filename)
+void FilePool::setInfo(const string& filename, const Sha1Sum& sum, time_t time)
 {
-	auto it = upper_bound(begin(pool), end(pool), sum,
-	                      LessTupleElement<0>());
-	pool.insert(it, make_tuple(sum, time, filename));
-	needWrite = true;
+	auto* info = findInDatabase(filename);
+	if (info && (info->sum == sum) && (info->time == time)) return;
+	addToIndex(filename, sum, time);
+	appendToCache(filename, sum, time);
 }
 
-void FilePool::remove(Pool::iterator it)
+void FilePool::remove(const string& filename)
 {
-	pool.erase(it);
-	needWrite = true;
+	auto* info = findInDatabase(filename);
+	if (!info) return;
+	auto time = info->time;
+	removeFromIndex(filename);
+	// an all-zero sha1sum marks a removed entry
+	appendToCache(filename, Sha1Sum(), time);
 }
 
-// Change the sha1sum of the element pointed to by 'it' into 'newSum'.
-// Also re-arrange the items so that pool remains sorted on sha1sum. Internally
-// this method doesn't actually sort, it merely rotates the elements.
-// Returns false if the new position is before (or at) the old position.
-// Returns true  if the new position is after          the old position.
-bool FilePool::adjust(Pool::iterator it, const Sha1Sum& newSum)
+void FilePool::addToIndex(const string& filename, const Sha1Sum& sum, time_t time)
 {
-	needWrite = true;
-	auto newIt = upper_bound(begin(pool), end(pool), newSum,
-	                         LessTupleElement<0>());
-	get<0>(*it) = newSum; // update sum
-	if (newIt > it) {
-		// move to back
-		rotate(it, it + 1, newIt);
-		return true;
-	} else {
-		if (newIt < it) {
-			// move to front
-			rotate(newIt, it, it + 1);
-		} else {
-			// (unlikely) sha1sum has changed, but after
-			// resorting item would remain in the same
-			// position
-		}
-		return false;
+	removeFromIndex(filename);
+	files.emplace_noDuplicateCheck(filename, FileInfo{sum, time});
+	sums[sum].push_back(filename);
+}
+
+bool FilePool::removeFromIndex(const string& filename)
+{
+	auto it = files.find(filename);
+	if (it == files.end()) return false;
+	auto it2 = sums.find(it->second.sum);
+	assert(it2 != sums.end());
+	auto& names = it2->second;
+	names.erase(std::find(begin(names), end(names), filename));
+	if (names.empty()) sums.erase(it2);
+	files.erase(it);
+	return true;
+}
+
+static void writeLine(ofstream& file, const string& filename,
+                      const Sha1Sum& sum, time_t time)
+{
+	file << sum.toString()      << "  " // sum
+	     << Date::toString(time) << "  " // date
+	     << filename                     // filename
+	     << '\n';
+}
+
+void FilePool::appendToCache(const string& filename, const Sha1Sum& sum,
+                             time_t time)
+{
+	if (!cacheStream.is_open()) {
+		string cacheFile = FileOperations::getUserDataDir() + FILE_CACHE;
+		FileOperations::openofstream(cacheStream, cacheFile, std::ios::app);
+		if (!cacheStream.is_open()) return;
 	}
+	writeLine(cacheStream, filename, sum, time);
+	// Flush right away, a crash shouldn't throw away already calculated
+	// sums. This is cheap compared to calculating a sha1sum.
+	cacheStream.flush();
+	++cacheLines;
 }
 
 static bool parse(const string& line, Sha1Sum& sha1, time_t& time, string& filename)
@@ -152,7 +178,7 @@ static bool parse(const string& line, Sha1Sum& sha1, time_t& time, string& filen
 
 void FilePool::readSha1sums()
 {
-	assert(pool.empty());
+	assert(files.empty());
 
 	string cacheFile = FileOperations::getUserDataDir() + FILE_CACHE;
 	ifstream file(cacheFile.c_str());
@@ -163,33 +189,35 @@ void FilePool::readSha1sums()
 	while (file.good()) {
 		getline(file, line);
 		if (parse(line, sum, time, filename)) {
-			pool.emplace_back(sum, time, filename);
+			// later lines override earlier lines for the same file
+			if (sum.empty()) {
+				removeFromIndex(filename);
+			} else {
+				addToIndex(filename, sum, time);
+			}
+			++cacheLines;
 		}
 	}
 
-	if (!std::is_sorted(begin(pool), end(pool), LessTupleElement<0>())) {
-		// This should _rarely_ happen. In fact it should only happen
-		// when .filecache was manually edited. Though because it's
-		// very important that pool is indeed sorted I've added this
-		// safety mechanism.
-		sort(begin(pool), end(pool), LessTupleElement<0>());
+	// Only rewrite the file when it mostly contains outdated lines.
+	if (cacheLines > (2 * files.size() + 1000)) {
+		writeSha1sums();
 	}
 }
 
 void FilePool::writeSha1sums()
 {
+	assert(!cacheStream.is_open());
 	string cacheFile = FileOperations::getUserDataDir() + FILE_CACHE;
 	ofstream file;
 	FileOperations::openofstream(file, cacheFile);
 	if (!file.is_open()) {
 		return;
 	}
-	for (auto& p : pool) {
-		file << get<0>(p).toString()      << "  " // sum
-		     << Date::toString(get<1>(p)) << "  " // date
-		     << get<2>(p)                         // filename
-		     << '\n';
+	for (auto& p : files) {
+		writeLine(file, p.first, p.second.sum, p.second.time);
 	}
+	cacheLines = files.size();
 }
 
 static int parseTypes(Interpreter& interp, const TclObject& list)
@@ -283,6 +311,9 @@ File FilePool::getFile(FileType fileType, const Sha1Sum& sha1sum)
 		if (d.types & fileType) {
 			string path = FileOperations::expandTilde(d.path);
 			result = scanDirectory(sha1sum, path, d.path, progress);
+			if (!result.is_open()) {
+				result = hashPending(sha1sum, progress);
+			}
 			if (result.is_open()) return result;
 		}
 	}
@@ -337,15 +368,15 @@ static Sha1Sum calcSha1sum(File& file, Reactor& reactor)
 
 File FilePool::getFromPool(const Sha1Sum& sha1sum)
 {
-	auto bound = equal_range(begin(pool), end(pool), sha1sum,
-	                         LessTupleElement<0>());
-	// use indices instead of iterators
-	auto i    = distance(begin(pool), bound.first);
-	auto last = distance(begin(pool), bound.second);
-	while (i != last) {
-		auto it = begin(pool) + i;
-		auto& time           = get<1>(*it);
-		const auto& filename = get<2>(*it);
+	auto it = sums.find(sha1sum);
+	if (it == sums.end()) return File(); // not found
+
+	// copy, entries are (re)moved in the loop below
+	auto candidates = it->second;
+	for (auto& filename : candidates) {
+		auto* info = findInDatabase(filename);
+		assert(info);
+		auto time = info->time;
 		try {
 			File file(filename);
 			auto newTime = file.getModificationDate();
@@ -355,28 +386,18 @@ File FilePool::getFromPool(const Sha1Sum& sha1sum)
 				// expensive sha1sum calculation.
 				return file;
 			}
-			time = newTime; // update timestamp
-			needWrite = true;
 			auto newSum = calcSha1sum(file, reactor);
+			setInfo(filename, newSum, newTime);
 			if (newSum == sha1sum) {
 				// Modification time was changed, but
 				// (recalculated) sha1sum is still the same.
 				return file;
 			}
-			// Sha1sum has changed: update sha1sum, move entry to
-			// new position new sum and continue searching.
-			if (adjust(it, newSum)) {
-				// after
-				--last; // no ++i
-			} else {
-				// before (or at)
-				++i;
-			}
+			// Sha1sum has changed: continue searching.
 		} catch (FileException&) {
 			// Error reading file: remove from db and continue
 			// searching.
-			remove(it);
-			--last;
+			remove(filename);
 		}
 	}
 	return File(); // not found
@@ -431,62 +452,118 @@ File FilePool::scanFile(const Sha1Sum& sha1sum, const string& filename,
 	// deliver, so it's ok to call on each file.
 	reactor.getEventDistributor().deliverEvents();
 
-	auto it = findInDatabase(filename);
-	if (it == end(pool)) {
-		// not in pool
-		try {
-			File file(filename);
-			auto sum = calcSha1sum(file, reactor);
-			auto time = FileOperations::getModificationDate(st);
-			insert(sum, time, filename);
-			if (sum == sha1sum) {
-				return file;
+	auto time = FileOperations::getModificationDate(st);
+	auto* info = findInDatabase(filename);
+	if (info && (info->time == time)) {
+		// db is still up to date
+		if (info->sum == sha1sum) {
+			try {
+				return File(filename);
+			} catch (FileException&) {
+				// error reading file, remove from db
+				remove(filename);
 			}
-		} catch (FileException&) {
-			// ignore
 		}
-	} else {
-		// already in pool
-		assert(filename == get<2>(*it));
-		try {
-			auto time = FileOperations::getModificationDate(st);
-			if (time == get<1>(*it)) {
-				// db is still up to date
-				if (get<0>(*it) == sha1sum) {
-					return File(filename);
-				}
-			} else {
-				// db outdated
-				File file(filename);
-				auto sum = calcSha1sum(file, reactor);
-				get<1>(*it) = time;
-				adjust(it, sum);
-				if (sum == sha1sum) {
-					return file;
-				}
-			}
-		} catch (FileException&) {
-			// error reading file, remove from db
-			remove(it);
+		return File(); // not found
+	}
+	// Not in db or db outdated: calculate sha1sum later, together with
+	// a bunch of other files.
+	progress.pending.push_back(PendingFile{filename, time});
+	if (progress.pending.size() >= SCAN_BATCH) {
+		return hashPending(sha1sum, progress);
+	}
+	return File(); // not found (yet)
+}
+
+namespace {
+enum HashResult { HASHED, IN_MAIN_THREAD, FAILED };
+}
+
+// Can be called from any thread: doesn't use (not thread-safe) compressed
+// file adapters, those files are left for the main thread.
+static HashResult hashLocalFile(const string& filename, Sha1Sum& result)
+{
+	static const byte GZ_HEADER[3]  = { 0x1F, 0x8B, 0x08 };
+	static const byte ZIP_HEADER[4] = { 0x50, 0x4B, 0x03, 0x04 };
+	try {
+		File file(filename, "rb"); // never a compressed file adapter
+		size_t size;
+		const byte* data = file.mmap(size);
+		if ((size > MAX_BACKGROUND_SIZE) ||
+		    ((size >= 4) && ((memcmp(data, GZ_HEADER,  3) == 0) ||
+		                     (memcmp(data, ZIP_HEADER, 4) == 0)))) {
+			return IN_MAIN_THREAD;
 		}
+		result = SHA1::calc(data, size);
+		return HASHED;
+	} catch (FileException&) {
+		return FAILED;
 	}
-	return File(); // not found
 }
 
-FilePool::Pool::iterator FilePool::findInDatabase(const string& filename)
+File FilePool::hashPending(const Sha1Sum& sha1sum, ScanProgress& progress)
 {
-	// Linear search in pool for filename.
-	// Search from back to front because often, soon after this search, we
-	// will insert/remove an element from the vector. This requires
-	// shifting all elements in the vector starting from a certain
-	// position. Starting the search from the back increases the likelihood
-	// that the to-be-shifted elements are already in the memory cache.
-	for (auto it = pool.rbegin(); it != pool.rend(); ++it) {
-		if (get<2>(*it) == filename) {
-			return it.base() - 1;
+	auto pending = std::move(progress.pending);
+	progress.pending.clear();
+	if (pending.empty() || quit) return File();
+
+	auto num = pending.size();
+	vector<Sha1Sum> sums_(num);
+	vector<HashResult> results(num);
+	std::atomic<size_t> next(0);
+	auto work = [&] {
+		while (true) {
+			size_t i = next++;
+			if (i >= num) break;
+			results[i] = hashLocalFile(pending[i].filename, sums_[i]);
 		}
+	};
+	unsigned numThreads = std::min<size_t>(std::min(
+		std::max(std::thread::hardware_concurrency(), 1u), MAX_THREADS),
+		num);
+	vector<std::thread> workers;
+	for (unsigned t = 1; t < numThreads; ++t) {
+		workers.emplace_back(work);
 	}
-	return end(pool); // not found
+	work(); // also use this thread
+	for (auto& w : workers) w.join();
+
+	// Update the db in the original order, return the first match.
+	File result;
+	for (auto i : xrange(num)) {
+		const auto& filename = pending[i].filename;
+		if (results[i] == IN_MAIN_THREAD) {
+			// No need to (slowly) hash these anymore once we have
+			// a match, they'll be hashed during a next search.
+			if (result.is_open() || quit) continue;
+			try {
+				File file(filename);
+				sums_[i] = calcSha1sum(file, reactor);
+				results[i] = HASHED;
+			} catch (FileException&) {
+				results[i] = FAILED;
+			}
+		}
+		if (results[i] == FAILED) {
+			remove(filename);
+			continue;
+		}
+		setInfo(filename, sums_[i], pending[i].time);
+		if (!result.is_open() && (sums_[i] == sha1sum)) {
+			try {
+				result = File(filename);
+			} catch (FileException&) {
+				// ignore
+			}
+		}
+	}
+	return result;
+}
+
+const FilePool::FileInfo* FilePool::findInDatabase(const string& filename) const
+{
+	auto it = files.find(filename);
+	return (it != files.end()) ? &it->second : nullptr;
 }
 
 Sha1Sum FilePool::getSha1Sum(File& file)
@@ -494,23 +571,16 @@ Sha1Sum FilePool::getSha1Sum(File& file)
 	auto time = file.getModificationDate();
 	const auto& filename = file.getURL();
 
-	auto it = findInDatabase(filename);
-	if ((it != end(pool)) && (get<1>(*it) == time)) {
+	auto* info = findInDatabase(filename);
+	if (info && (info->time == time)) {
 		// in database and modification time matches,
 		// assume sha1sum also matches
-		return get<0>(*it);
+		return info->sum;
 	}
 
 	// not in database or timestamp mismatch
 	auto sum = calcSha1sum(file, reactor);
-	if (it == end(pool)) {
-		// was not yet in database, insert new entry
-		insert(sum, time, filename);
-	} else {
-		// was already in database, but with wrong timestamp (and sha1sum)
-		get<1>(*it) = time;
-		adjust(it, sum);
-	}
+	setInfo(filename, sum, time);
 	return sum;
 }
 
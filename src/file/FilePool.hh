@@ -6,9 +6,11 @@
 #include "Observer.hh"
 #include "EventListener.hh"
 #include "sha1.hh"
+#include "hash_map.hh"
+#include "xxhash.hh"
+#include <fstream>
 #include <memory>
 #include <string>
-#include <tuple>
 #include <vector>
 #include <ctime>
 #include <cstdint>
@@ -20,6 +22,21 @@ class Reactor;
 class File;
 class Sha1SumCommand;
 
+/** Finds files (e.g. system roms) based on their sha1sum.
+  *
+  * The sha1sums of all files encountered while searching the pool
+  * directories are kept in a database, indexed on both filename and
+  * sha1sum. An entry is assumed to be still valid as long as the
+  * modification time of the file didn't change. The database is stored in
+  * the .filecache file in the user data directory, changes are appended to
+  * that file right away (a later line for the same filename overrides an
+  * earlier one). Only when there are too many overridden lines the file
+  * is rewritten completely.
+  *
+  * When a file isn't in the database yet, the pool directories are
+  * scanned. Files that need a (new) sha1sum calculation are collected in
+  * batches, these are hashed on several threads.
+  */
 class FilePool final : private Observer<Setting>, private EventListener
 {
 public:
@@ -43,9 +60,14 @@ public:
 	Sha1Sum getSha1Sum(File& file);
 
 private:
+	struct PendingFile {
+		std::string filename;
+		time_t time;
+	};
 	struct ScanProgress {
 		uint64_t lastTime;
 		unsigned amountScanned;
+		std::vector<PendingFile> pending; // need a sha1sum calculation
 	};
 	struct Entry {
 		std::string path;
@@ -53,12 +75,19 @@ private:
 	};
 	using Directories = std::vector<Entry>;
 
-	// <sha1sum, timestamp, filename>, sorted on sha1sum
-	using Pool = std::vector<std::tuple<Sha1Sum, time_t, std::string>>;
+	struct FileInfo {
+		Sha1Sum sum;
+		time_t time;
+	};
 
-	void insert(const Sha1Sum& sum, time_t time, const std::string& filename);
-	void remove(Pool::iterator it);
-	bool adjust(Pool::iterator it, const Sha1Sum& newSum);
+	// update the index and the .filecache file
+	void setInfo(const std::string& filename, const Sha1Sum& sum, time_t time);
+	void remove(const std::string& filename);
+	// only update the index
+	void addToIndex(const std::string& filename, const Sha1Sum& sum, time_t time);
+	bool removeFromIndex(const std::string& filename);
+	void appendToCache(const std::string& filename, const Sha1Sum& sum,
+	                   time_t time);
 
 	void readSha1sums();
 	void writeSha1sums();
@@ -73,7 +102,8 @@ private:
 	              const FileOperations::Stat& st,
 	              const std::string& poolPath,
 	              ScanProgress& progress);
-	Pool::iterator findInDatabase(const std::string& filename);
+	File hashPending(const Sha1Sum& sha1sum, ScanProgress& progress);
+	const FileInfo* findInDatabase(const std::string& filename) const;
 
 	Directories getDirectories() const;
 
@@ -87,9 +117,12 @@ private:
 	StringSetting filePoolSetting;
 	Reactor& reactor;
 
-	Pool pool;
+	hash_map<std::string, FileInfo, XXHasher> files;
+	// per sha1sum, all files with that content
+	hash_map<Sha1Sum, std::vector<std::string>, Sha1Sum::Hasher> sums;
+	std::ofstream cacheStream; // for appending, opened on first change
+	unsigned cacheLines; // number of lines in the .filecache file
 	bool quit;
-	bool needWrite;
 
 	std::unique_ptr<Sha1SumCommand> sha1SumCommand;
 };
@@ -17,7 +17,7 @@ GZFileAdapter::GZFileAdapter(std::unique_ptr<FileBase> file_)
 {
 }
 
-static bool skipHeader(ZlibInflate& zlib, std::string& originalName)
+static bool parseHeader(ZlibInflate& zlib, std::string& originalName)
 {
 	// check magic bytes
 	if (zlib.get16LE() != 0x8B1F) {
@@ -53,15 +53,11 @@ static bool skipHeader(ZlibInflate& zlib, std::string& originalName)
 	return true;
 }
 
-void GZFileAdapter::decompress(FileBase& f, Decompressed& d)
+void GZFileAdapter::skipHeader(ZlibInflate& zlib, std::string& originalName)
 {
-	size_t size;
-	const byte* data = f.mmap(size);
-	ZlibInflate zlib(data, size);
-	if (!skipHeader(zlib, d.originalName)) {
+	if (!parseHeader(zlib, originalName)) {
 		throw FileException("Not a gzip header");
 	}
-	d.size = zlib.inflate(d.buf);
 }
 
 } // namespace openmsx
@@ -11,7 +11,7 @@ public:
 	explicit GZFileAdapter(std::unique_ptr<FileBase> file);
 
 private:
-	void decompress(FileBase& file, Decompressed& decompressed) override;
+	void skipHeader(ZlibInflate& zlib, std::string& originalName) override;
 };
 
 } // namespace openmsx
@@ -0,0 +1,176 @@
+#include "HostDirScanner.hh"
+#include "ReadDir.hh"
+#include "StringOp.hh"
+#include <algorithm>
+#include <cassert>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using std::string;
+
+namespace openmsx {
+
+// Don't descend deeper than this (e.g. protects against symlink loops).
+// Deeper trees are not watched, instead the scanner disables itself.
+static const unsigned MAX_DEPTH = 32;
+
+HostDirScanner::HostDirScanner(string hostDir_)
+	: hostDir(std::move(hostDir_))
+	, fd(-1)
+	, eventSeq(0), snapshotSeq(0), returnedSeq(unsigned(-1))
+	, broken(false)
+{
+	assert(StringOp::endsWith(hostDir, '/'));
+#ifdef __linux__
+	fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd == -1) return; // not available, getSnapshot() returns nullptr
+	thread = std::thread([this]() { run(); });
+#endif
+}
+
+HostDirScanner::~HostDirScanner()
+{
+	poller.abort();
+	if (thread.joinable()) thread.join();
+#ifdef __linux__
+	if (fd != -1) close(fd);
+#endif
+}
+
+std::shared_ptr<const HostDirScanner::Snapshot> HostDirScanner::getSnapshot(
+	bool& changed)
+{
+	changed = true;
+	std::lock_guard<std::mutex> lock(mutex);
+	// While we hold the lock the scanner thread cannot consume events. So
+	// if there are no pending events and the snapshot was started after
+	// the last consumed event, then it reflects the current host state.
+	if (broken || !snapshot || (snapshotSeq != eventSeq) || eventsPending()) {
+		return nullptr;
+	}
+	changed = snapshotSeq != returnedSeq;
+	returnedSeq = snapshotSeq;
+	return snapshot;
+}
+
+void HostDirScanner::run()
+{
+#ifdef __linux__
+	while (true) {
+		scan();
+		if (poller.poll(fd)) break; // aborted or error
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			drainEvents();
+			++eventSeq;
+		}
+		// Note: also when the change notification queue overflowed
+		// (IN_Q_OVERFLOW) we simply rescan the whole tree.
+	}
+#endif
+}
+
+void HostDirScanner::scan()
+{
+	unsigned seq;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (broken) return;
+		seq = eventSeq;
+	}
+	auto newSnapshot = std::make_shared<Snapshot>();
+	scanDir(*newSnapshot, "", 0);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	snapshot = std::move(newSnapshot);
+	snapshotSeq = seq;
+}
+
+void HostDirScanner::scanDir(Snapshot& result, const string& hostSubDir,
+                             unsigned depth)
+{
+#ifdef __linux__
+	if (poller.aborted()) return;
+	string fullDir = hostDir + hostSubDir;
+	if (depth > MAX_DEPTH) {
+		std::lock_guard<std::mutex> lock(mutex);
+		broken = true;
+		return;
+	}
+	// First add the watch, then read the directory. This way there are
+	// no changes that can go unnoticed.
+	const uint32_t mask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB |
+	                      IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE |
+	                      IN_DELETE_SELF | IN_MOVE_SELF;
+	if (inotify_add_watch(fd, fullDir.c_str(), mask) == -1) {
+		// Typically the limit on the number of watches is reached.
+		std::lock_guard<std::mutex> lock(mutex);
+		broken = true;
+		return;
+	}
+
+	auto& names = result.dirs[hostSubDir];
+	{
+		ReadDir dir(fullDir);
+		while (auto* d = dir.getEntry()) {
+			if (StringOp::startsWith(d->d_name, '.')) {
+				// skip '.', '..' and hidden files
+				continue;
+			}
+			names.emplace_back(d->d_name);
+			if (d->d_type == DT_LNK) {
+				// Changes in the target of a symlink are not
+				// reported by the watch on this directory.
+				string link = fullDir + d->d_name;
+				if (inotify_add_watch(fd, link.c_str(), mask) == -1) {
+					std::lock_guard<std::mutex> lock(mutex);
+					broken = true;
+				}
+			}
+		}
+	}
+	sort(begin(names), end(names));
+
+	for (auto& name : names) {
+		string hostPath = hostSubDir + name;
+		FileOperations::Stat fst;
+		if (!FileOperations::getStat(hostDir + hostPath, fst)) continue;
+		result.entries[hostPath] = fst;
+		if (FileOperations::isDirectory(fst)) {
+			scanDir(result, hostPath + '/', depth + 1);
+		}
+	}
+#else
+	(void)result; (void)hostSubDir; (void)depth;
+#endif
+}
+
+bool HostDirScanner::eventsPending() const
+{
+#ifdef __linux__
+	struct pollfd pfd;
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	return ::poll(&pfd, 1, 0) != 0;
+#else
+	return true;
+#endif
+}
+
+void HostDirScanner::drainEvents()
+{
+#ifdef __linux__
+	// We don't look at the individual events, any event triggers a
+	// rescan of the whole tree.
+	char buf[4096];
+	while (read(fd, buf, sizeof(buf)) > 0) {
+		// nothing
+	}
+#endif
+}
+
+} // namespace openmsx
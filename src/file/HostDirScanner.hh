@@ -0,0 +1,80 @@
+#ifndef HOSTDIRSCANNER_HH
+#define HOSTDIRSCANNER_HH
+
+#include "FileOperations.hh"
+#include "Poller.hh"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace openmsx {
+
+/**
+ * Keeps an in-memory snapshot of a host directory tree (names and stat
+ * info of all files and subdirectories). The snapshot is (re)built by a
+ * background thread, and only after the host filesystem reported a change
+ * (via inotify). This avoids walking and stat-ing the whole tree on the
+ * emulation thread when nothing changed.
+ *
+ * When change notification is not available (non-Linux hosts, inotify
+ * limits reached, ...) getSnapshot() always returns nullptr and the host
+ * filesystem must be accessed directly.
+ */
+class HostDirScanner final
+{
+public:
+	struct Snapshot {
+		/** For each directory (path relative to the root, empty or
+		  * ending in '/'), the names of the entries in it. Hidden
+		  * entries (starting with '.') are not included.
+		  */
+		std::map<std::string, std::vector<std::string>> dirs;
+		/** Stat info for each entry (path relative to the root,
+		  * without trailing '/'). Entries that could not be stat-ed
+		  * are missing.
+		  */
+		std::map<std::string, FileOperations::Stat> entries;
+	};
+
+	/** Start watching the given directory.
+	  * @param hostDir Directory to watch, must end in '/'.
+	  */
+	explicit HostDirScanner(std::string hostDir);
+	~HostDirScanner();
+
+	/** Get the most recent snapshot, but only if it's known to reflect
+	  * the current state of the host directory. Otherwise nullptr.
+	  * @param changed Output parameter. Set to false iff a snapshot is
+	  *   returned and it's the same one as returned by the previous call
+	  *   (thus nothing changed on the host since then).
+	  */
+	std::shared_ptr<const Snapshot> getSnapshot(bool& changed);
+
+private:
+	void run();
+	void scan();
+	void scanDir(Snapshot& snapshot, const std::string& hostSubDir,
+	             unsigned depth);
+	bool eventsPending() const;
+	void drainEvents();
+
+	const std::string hostDir;
+	std::thread thread;
+	Poller poller;
+	int fd; // inotify file descriptor, -1 if not available
+
+	std::mutex mutex; // protects all members below
+	std::shared_ptr<const Snapshot> snapshot;
+	unsigned eventSeq;    // incremented for each batch of change events
+	unsigned snapshotSeq; // value of eventSeq when 'snapshot' was started
+	unsigned returnedSeq; // value of snapshotSeq of last getSnapshot()
+	bool broken; // failed to watch (part of) the tree
+};
+
+} // namespace openmsx
+
+#endif
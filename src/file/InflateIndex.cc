@@ -0,0 +1,289 @@
+#include "InflateIndex.hh"
+#include "FileException.hh"
+#include "FileOperations.hh"
+#include "MSXException.hh"
+#include "StringOp.hh"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <zlib.h>
+
+namespace openmsx {
+
+// Distance (in decompressed bytes) between two access points. A read
+// decompresses (on average) half of this.
+static const size_t SPAN = 1024 * 1024;
+// Size of the deflate dictionary.
+static const size_t WINSIZE = 32 * 1024;
+// Feed the input to zlib in blocks of at most this size (avail_in is only
+// 32 bit).
+static const size_t MAX_BLOCK = 1024 * 1024 * 1024;
+
+static const char PERSIST_MAGIC[8] = { 'o','M','S','X','z','i','x','1' };
+struct PersistHeader
+{
+	char magic[8];
+	uint64_t dataSize;
+	int64_t time;
+	uint64_t outSize;
+	uint64_t numPoints;
+};
+struct PersistPoint
+{
+	uint64_t in;
+	uint64_t out;
+	uint64_t bits;
+};
+
+namespace {
+// Small RAII wrapper around a z_stream for raw inflate.
+class Inflater
+{
+public:
+	Inflater(const byte* data_, size_t size_)
+		: data(data_), size(size_), pos(0)
+	{
+		memset(&s, 0, sizeof(s));
+		int err = inflateInit2(&s, -MAX_WBITS);
+		if (err != Z_OK) {
+			throw FileException(StringOp::Builder()
+				<< "Error initializing inflate struct: " << zError(err));
+		}
+	}
+	~Inflater() { inflateEnd(&s); }
+
+	void setPos(size_t newPos) {
+		pos = newPos;
+		s.avail_in = 0;
+	}
+	// Feed the next block of input when all previous input was consumed.
+	void feed() {
+		if (s.avail_in) return;
+		auto num = std::min(size - pos, MAX_BLOCK);
+		s.next_in = const_cast<byte*>(data + pos);
+		s.avail_in = uInt(num);
+		pos += num;
+	}
+	// Position of the next (not yet consumed) input byte.
+	size_t getPos() const { return pos - s.avail_in; }
+
+	z_stream s;
+private:
+	const byte* data;
+	size_t size;
+	size_t pos;
+};
+}
+
+static void checkError(int err)
+{
+	if (err == Z_BUF_ERROR) {
+		throw FileException(
+			"Error while decompressing: unexpected end of file.");
+	}
+	if ((err != Z_OK) && (err != Z_STREAM_END)) {
+		throw FileException(StringOp::Builder()
+			<< "Error while decompressing: " << zError(err));
+	}
+}
+
+InflateIndex::InflateIndex(const byte* data_, size_t size,
+                           const std::string& cacheFile, time_t time)
+	: data(data_), dataSize(size), useCounter(0), outSize(0)
+{
+	for (auto& c : chunks) {
+		c.point = size_t(-1);
+		c.lastUse = 0;
+	}
+	if (load(cacheFile, time)) return;
+	build();
+	store(cacheFile, time);
+}
+
+void InflateIndex::build()
+{
+	points.clear();
+	points.push_back(Point{0, 0, 0, MemBuffer<byte>()});
+
+	Inflater inf(data, dataSize);
+	auto& s = inf.s;
+	byte window[WINSIZE]; // circular buffer for the decompressed data
+	uint64_t out = 0;
+	s.avail_out = 0;
+	while (true) {
+		if (s.avail_out == 0) {
+			s.next_out = window;
+			s.avail_out = WINSIZE;
+		}
+		inf.feed();
+		auto before = s.avail_out;
+		// stop at the end of each deflate block
+		int err = ::inflate(&s, Z_BLOCK);
+		out += before - s.avail_out;
+		checkError(err);
+		if (err == Z_STREAM_END) break;
+
+		// At the end of a block that's not the last block, and far
+		// enough from the previous point?
+		if ((s.data_type & 128) && !(s.data_type & 64) &&
+		    ((out - points.back().out) >= SPAN)) {
+			// SPAN > WINSIZE, so the window is completely filled
+			MemBuffer<byte> dict(WINSIZE);
+			auto left = s.avail_out;
+			memcpy(dict.data(), window + WINSIZE - left, left);
+			memcpy(dict.data() + left, window, WINSIZE - left);
+			points.push_back(Point{inf.getPos(), out,
+			                       unsigned(s.data_type & 7),
+			                       std::move(dict)});
+		}
+	}
+	outSize = out;
+}
+
+size_t InflateIndex::getChunkEnd(size_t point) const
+{
+	return ((point + 1) < points.size()) ? points[point + 1].out : outSize;
+}
+
+const InflateIndex::Chunk& InflateIndex::getChunk(size_t point)
+{
+	++useCounter;
+	auto* victim = &chunks[0];
+	for (auto& c : chunks) {
+		if (c.point == point) {
+			c.lastUse = useCounter;
+			return c;
+		}
+		if (c.lastUse < victim->lastUse) victim = &c;
+	}
+
+	const auto& p = points[point];
+	size_t num = getChunkEnd(point) - p.out;
+	victim->point = size_t(-1); // invalid until successfully decompressed
+	victim->buf.resize(num);
+
+	Inflater inf(data, dataSize);
+	auto& s = inf.s;
+	if (p.bits) {
+		// continue in the middle of a byte
+		assert(p.in > 0);
+		int err = inflatePrime(&s, p.bits, data[p.in - 1] >> (8 - p.bits));
+		checkError(err);
+	}
+	inf.setPos(p.in);
+	if (!p.window.empty()) {
+		int err = inflateSetDictionary(&s, p.window.data(), WINSIZE);
+		checkError(err);
+	}
+	size_t done = 0;
+	while (done < num) {
+		inf.feed();
+		s.next_out = victim->buf.data() + done;
+		s.avail_out = uInt(std::min(num - done, MAX_BLOCK));
+		auto before = s.avail_out;
+		int err = ::inflate(&s, Z_NO_FLUSH);
+		done += before - s.avail_out;
+		checkError(err);
+		if ((err == Z_STREAM_END) && (done < num)) {
+			throw FileException(
+				"Error while decompressing: unexpected end of stream.");
+		}
+	}
+	victim->point = point;
+	victim->lastUse = useCounter;
+	return *victim;
+}
+
+void InflateIndex::read(size_t pos, byte* buffer, size_t num)
+{
+	assert((pos + num) <= outSize);
+	while (num) {
+		// index of the last point at or before 'pos'
+		auto it = std::upper_bound(begin(points), end(points), pos,
+			[](size_t p, const Point& point) { return p < point.out; });
+		size_t point = (it - begin(points)) - 1;
+		const auto& chunk = getChunk(point);
+		size_t offset = pos - points[point].out;
+		size_t n = std::min(num, getChunkEnd(point) - pos);
+		memcpy(buffer, chunk.buf.data() + offset, n);
+		buffer += n;
+		pos    += n;
+		num    -= n;
+	}
+}
+
+bool InflateIndex::load(const std::string& cacheFile, time_t time)
+{
+	auto file = FileOperations::openFile(cacheFile, "rb");
+	if (!file) return false;
+
+	PersistHeader header;
+	if ((fread(&header, sizeof(header), 1, file.get()) != 1) ||
+	    (memcmp(header.magic, PERSIST_MAGIC, sizeof(PERSIST_MAGIC)) != 0) ||
+	    (header.dataSize != dataSize) ||
+	    (header.time != int64_t(time)) ||
+	    (header.numPoints == 0)) {
+		return false;
+	}
+	std::vector<Point> newPoints;
+	for (uint64_t i = 0; i < header.numPoints; ++i) {
+		PersistPoint p;
+		if ((fread(&p, sizeof(p), 1, file.get()) != 1) ||
+		    (p.in > dataSize) || (p.out > header.outSize) ||
+		    (p.bits > 7) || ((p.bits != 0) && (p.in == 0)) ||
+		    ((i == 0) ? (p.out != 0)
+		              : (p.out <= newPoints.back().out))) {
+			return false;
+		}
+		MemBuffer<byte> window;
+		if (i != 0) {
+			window.resize(WINSIZE);
+			if (fread(window.data(), WINSIZE, 1, file.get()) != 1) {
+				return false;
+			}
+		}
+		newPoints.push_back(Point{p.in, p.out, unsigned(p.bits),
+		                          std::move(window)});
+	}
+	points = std::move(newPoints);
+	outSize = header.outSize;
+	return true;
+}
+
+void InflateIndex::store(const std::string& cacheFile, time_t time) const
+{
+	// Rebuilding the index for a small stream is cheap.
+	if (points.size() < 2) return;
+
+	// It's only a cache, so silently ignore all errors.
+	try {
+		FileOperations::mkdirp(FileOperations::getBaseName(cacheFile));
+	} catch (MSXException&) {
+		return;
+	}
+	auto file = FileOperations::openFile(cacheFile, "wb");
+	if (!file) return;
+
+	PersistHeader header;
+	memcpy(header.magic, PERSIST_MAGIC, sizeof(PERSIST_MAGIC));
+	header.dataSize = dataSize;
+	header.time = time;
+	header.outSize = outSize;
+	header.numPoints = points.size();
+	bool ok = fwrite(&header, sizeof(header), 1, file.get()) == 1;
+	for (auto& p : points) {
+		if (!ok) break;
+		PersistPoint pp = { p.in, p.out, p.bits };
+		ok = fwrite(&pp, sizeof(pp), 1, file.get()) == 1;
+		if (ok && !p.window.empty()) {
+			ok = fwrite(p.window.data(), WINSIZE, 1, file.get()) == 1;
+		}
+	}
+	if (!ok) {
+		file.reset();
+		FileOperations::unlink(cacheFile);
+	}
+}
+
+} // namespace openmsx
@@ -0,0 +1,79 @@
+#ifndef INFLATEINDEX_HH
+#define INFLATEINDEX_HH
+
+#include "MemBuffer.hh"
+#include "openmsx.hh"
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+/** Random access into a (raw) deflate stream, without keeping the whole
+  * decompressed data in memory.
+  *
+  * Building the index requires one pass over the whole stream. At the
+  * first block boundary after every SPAN decompressed bytes the state of
+  * the decompressor is remembered: the position in the compressed and
+  * decompressed data, plus the last 32kB of decompressed data (the
+  * dictionary). From such a point decompression can be restarted (the same
+  * technique as zran.c in the zlib examples). Reads only decompress the
+  * chunk(s) between two such points, the last few chunks are cached.
+  *
+  * Building the index takes as long as decompressing the whole stream, so
+  * for larger streams the index is stored in a cache file. It's reused when
+  * the size and the modification time of the compressed file still match.
+  */
+class InflateIndex
+{
+public:
+	/** @param data Start of the raw deflate stream, must remain valid
+	  *             during the lifetime of this object.
+	  * @param size Size of the compressed stream.
+	  * @param cacheFile Name of the file to load/store the index from/to.
+	  * @param time Modification time of the compressed file.
+	  */
+	InflateIndex(const byte* data, size_t size,
+	             const std::string& cacheFile, time_t time);
+
+	/** Size of the decompressed data. */
+	size_t getSize() const { return outSize; }
+
+	/** Decompress 'num' bytes starting at 'pos'. The caller must make
+	  * sure this range is within the decompressed data. */
+	void read(size_t pos, byte* buffer, size_t num);
+
+private:
+	struct Point {
+		uint64_t in;   // position of the next byte in the compressed data
+		uint64_t out;  // corresponding position in the decompressed data
+		unsigned bits; // number of bits (1-7) of the byte before 'in' that
+		               // still need to be processed, or 0
+		MemBuffer<byte> window; // empty for the first point
+	};
+	struct Chunk {
+		MemBuffer<byte> buf;
+		size_t point; // index in 'points'
+		uint64_t lastUse;
+	};
+
+	void build();
+	bool load(const std::string& cacheFile, time_t time);
+	void store(const std::string& cacheFile, time_t time) const;
+	const Chunk& getChunk(size_t point);
+	size_t getChunkEnd(size_t point) const;
+
+	static const unsigned NUM_CHUNKS = 4;
+
+	const byte* const data;
+	const size_t dataSize;
+	std::vector<Point> points;
+	Chunk chunks[NUM_CHUNKS];
+	uint64_t useCounter;
+	size_t outSize;
+};
+
+} // namespace openmsx
+
+#endif
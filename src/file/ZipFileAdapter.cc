@@ -9,12 +9,8 @@ ZipFileAdapter::ZipFileAdapter(std::unique_ptr<FileBase> file_)
 {
 }
 
-void ZipFileAdapter::decompress(FileBase& f, Decompressed& d)
+void ZipFileAdapter::skipHeader(ZlibInflate& zlib, std::string& originalName)
 {
-	size_t size;
-	const byte* data = f.mmap(size);
-	ZlibInflate zlib(data, size);
-
 	if (zlib.get32LE() != 0x04034B50) {
 		throw FileException("Invalid ZIP file");
 	}
@@ -28,16 +24,14 @@ void ZipFileAdapter::decompress(FileBase& f, Decompressed& d)
 	}
 
 	// skip "last mod file time", "last mod file data",
-	//      "crc32",              "compressed size"
-	zlib.skip(2 + 2 + 4 + 4);
+	//      "crc32",              "compressed size",
+	//      "uncompressed size"
+	zlib.skip(2 + 2 + 4 + 4 + 4);
 
-	unsigned origSize = zlib.get32LE(); // uncompressed size
 	unsigned filenameLen = zlib.get16LE(); // filename length
 	unsigned extraFieldLen = zlib.get16LE(); // extra field length
-	d.originalName = zlib.getString(filenameLen); // original filename
+	originalName = zlib.getString(filenameLen); // original filename
 	zlib.skip(extraFieldLen); // skip "extra field"
-
-	d.size = zlib.inflate(d.buf, origSize);
 }
 
 } // namespace openmsx
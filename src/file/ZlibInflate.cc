@@ -1,12 +1,11 @@
 #include "ZlibInflate.hh"
 #include "FileException.hh"
-#include "MemBuffer.hh"
-#include "StringOp.hh"
 #include <limits>
 
 namespace openmsx {
 
-ZlibInflate::ZlibInflate(const byte* input, size_t inputLen_)
+ZlibInflate::ZlibInflate(const byte* input_, size_t inputLen_)
+	: input(input_)
 {
 	if (inputLen_ > std::numeric_limits<decltype(s.avail_in)>::max()) {
 		throw FileException(
@@ -19,14 +18,6 @@ ZlibInflate::ZlibInflate(const byte* input, size_t inputLen_)
 	s.opaque = nullptr;
 	s.next_in  = const_cast<byte*>(input);
 	s.avail_in = inputLen;
-	wasInit = false;
-}
-
-ZlibInflate::~ZlibInflate()
-{
-	if (wasInit) {
-		inflateEnd(&s);
-	}
 }
 
 void ZlibInflate::skip(size_t num)
@@ -80,37 +71,4 @@ std::string ZlibInflate::getCString()
 	return result;
 }
 
-size_t ZlibInflate::inflate(MemBuffer<byte>& output, size_t sizeHint)
-{
-	int initErr = inflateInit2(&s, -MAX_WBITS);
-	if (initErr != Z_OK) {
-		throw FileException(StringOp::Builder()
-			<< "Error initializing inflate struct: " << zError(initErr));
-	}
-	wasInit = true;
-
-	size_t outSize = sizeHint;
-	output.resize(outSize);
-	s.avail_out = uInt(outSize); // TODO overflow?
-	while (true) {
-		s.next_out = output.data() + s.total_out;
-		int err = ::inflate(&s, Z_NO_FLUSH);
-		if (err == Z_STREAM_END) {
-			break;
-		}
-		if (err != Z_OK) {
-			throw FileException(StringOp::Builder()
-				<< "Error decompressing gzip: " << zError(err));
-		}
-		auto oldSize = outSize;
-		outSize = oldSize * 2; // double buffer size
-		output.resize(outSize);
-		s.avail_out = uInt(outSize - oldSize); // TODO overflow?
-	}
-
-	// set actual size
-	output.resize(s.total_out);
-	return s.total_out;
-}
-
 } // namespace openmsx
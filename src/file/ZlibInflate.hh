@@ -1,7 +1,6 @@
 #ifndef ZLIBINFLATE_HH
 #define ZLIBINFLATE_HH
 
-#include "MemBuffer.hh"
 #include "openmsx.hh"
 #include <string>
 #include <zlib.h>
@@ -12,7 +11,6 @@ class ZlibInflate
 {
 public:
 	ZlibInflate(const byte* buffer, size_t len);
-	~ZlibInflate();
 
 	void skip(size_t num);
 	byte getByte();
@@ -21,11 +19,12 @@ public:
 	std::string getString(size_t len);
 	std::string getCString();
 
-	size_t inflate(MemBuffer<byte>& output, size_t sizeHint = 65536);
+	/** Number of bytes consumed by the get/skip methods above. */
+	size_t getPos() const { return s.next_in - input; }
 
 private:
 	z_stream s;
-	bool wasInit;
+	const byte* input;
 };
 
 } // namespace openmsx
@@ -2,6 +2,7 @@
 #include "FileContext.hh"
 #include "FileException.hh"
 #include "FilePool.hh"
+#include "FileOperations.hh"
 #include "DeviceConfig.hh"
 #include "CliComm.hh"
 #include "HDImageCLI.hh"
@@ -12,6 +13,7 @@
 #include "MSXException.hh"
 #include "HDCommand.hh"
 #include "Timer.hh"
+#include "sha1.hh"
 #include "serialize.hh"
 #include "memory.hh"
 #include "xrange.hh"
@@ -40,13 +42,18 @@ HD::HD(const DeviceConfig& config)
 	// For the initial hd image, savestate should only try exactly this
 	// (resolved) filename. For user-specified hd images (commandline or
 	// via hda command) savestate will try to re-resolve the filename.
+	bool useOverlay = config.getChildDataAsBool("overlay", false);
 	auto mode = File::NORMAL;
 	string cliImage = HDImageCLI::getImageForId(id);
 	if (cliImage.empty()) {
 		string original = config.getChildData("filename");
 		string resolved = config.getFileContext().resolveCreate(original);
 		filename = Filename(resolved);
-		mode = File::CREATE;
+		// With an overlay an existing image is never written to, so
+		// it's fine when it's read-only.
+		if (!useOverlay || !FileOperations::exists(resolved)) {
+			mode = File::CREATE;
+		}
 	} else {
 		filename = Filename(cliImage, userFileContext());
 	}
@@ -60,7 +67,12 @@ HD::HD(const DeviceConfig& config)
 		filesize = file.getSize();
 	}
 	tigerTree = make_unique<TigerTree>(
-		*this, filesize, filename.getResolved());
+		*this, filesize, filename.getResolved(), getTigerTreeCacheFile());
+	if (useOverlay) {
+		// Leave the image untouched, e.g. so that it can be shared
+		// between several machines.
+		enableOverlay();
+	}
 
 	(*hdInUse)[id] = true;
 	hdCommand = make_unique<HDCommand>(
@@ -88,7 +100,10 @@ void HD::switchImage(const Filename& newFilename)
 	filename = newFilename;
 	filesize = file.getSize();
 	tigerTree = make_unique<TigerTree>(*this, filesize,
-			filename.getResolved());
+			filename.getResolved(), getTigerTreeCacheFile());
+	if (hasOverlay()) {
+		enableOverlay(); // discard changes to the previous image
+	}
 	motherBoard.getMSXCliComm().update(CliComm::MEDIA, getName(),
 	                                   filename.getResolved());
 }
@@ -100,15 +115,30 @@ size_t HD::getNbSectorsImpl() const
 
 void HD::readSectorImpl(size_t sector, SectorBuffer& buf)
 {
-	file.seek(sector * sizeof(buf));
-	file.read(&buf, sizeof(buf));
+	readSectorsImpl(&buf, sector, 1);
 }
 
 void HD::writeSectorImpl(size_t sector, const SectorBuffer& buf)
 {
-	file.seek(sector * sizeof(buf));
-	file.write(&buf, sizeof(buf));
-	tigerTree->notifyChange(sector * sizeof(buf), sizeof(buf),
+	writeSectorsImpl(&buf, sector, 1);
+}
+
+void HD::readSectorsImpl(SectorBuffer* buffers, size_t startSector, size_t num)
+{
+	file.seek(startSector * sizeof(SectorBuffer));
+	file.read(buffers, num * sizeof(SectorBuffer));
+}
+
+void HD::writeSectorsImpl(const SectorBuffer* buffers, size_t startSector,
+                          size_t num)
+{
+	file.seek(startSector * sizeof(SectorBuffer));
+	file.write(buffers, num * sizeof(SectorBuffer));
+	// Flush so that the modification date is final. Otherwise the date
+	// stored in the tiger-tree cache file would not match next time.
+	file.flush();
+	tigerTree->notifyChange(startSector * sizeof(SectorBuffer),
+	                        num * sizeof(SectorBuffer),
 	                        file.getModificationDate());
 }
 
@@ -165,14 +195,22 @@ uint8_t* HD::getData(size_t offset, size_t size)
 	};
 	static Work work; // not reentrant
 
-	size_t sector = offset / sizeof(SectorBuffer);
-	for (auto i : xrange(size / sizeof(SectorBuffer))) {
-		// This possibly applies IPS patches.
-		readSector(sector++, work.bufs[i]);
-	}
+	// This possibly applies IPS patches. The hash is for the image
+	// itself, so without the overlay.
+	readBaseSectors(work.bufs, offset / sizeof(SectorBuffer),
+	                size / sizeof(SectorBuffer));
 	return work.bufs[0].raw;
 }
 
+string HD::getTigerTreeCacheFile() const
+{
+	// One cache file per image, named after the sha1 of the image path.
+	const auto& path = filename.getResolved();
+	return FileOperations::getUserDataDir() + "/tigertree/" +
+	       SHA1::calc(reinterpret_cast<const uint8_t*>(path.data()),
+	                  path.size()).toString();
+}
+
 bool HD::isCacheStillValid(time_t& cacheTime)
 {
 	time_t fileTime = file.getModificationDate();
@@ -208,6 +246,7 @@ int HD::insertDisk(string_ref newDisk)
 
 // version 1: initial version
 // version 2: replaced 'checksum'(=sha1) with 'tthsum`
+// version 3: added overlay
 template<typename Archive>
 void HD::serialize(Archive& ar, unsigned version)
 {
@@ -283,6 +322,12 @@ void HD::serialize(Archive& ar, unsigned version)
 			forceWriteProtect();
 		}
 	}
+
+	// Only the changes, the hash above is without the overlay. Whether
+	// there is an overlay follows from the (also stored) config.
+	if (ar.versionAtLeast(version, 3) && hasOverlay()) {
+		serializeOverlay(ar);
+	}
 }
 INSTANTIATE_SERIALIZE_METHODS(HD);
 
@@ -39,6 +39,10 @@ private:
 	// SectorAccessibleDisk:
 	void readSectorImpl (size_t sector,       SectorBuffer& buf) override;
 	void writeSectorImpl(size_t sector, const SectorBuffer& buf) override;
+	void readSectorsImpl (      SectorBuffer* buffers,
+	                      size_t startSector, size_t num) override;
+	void writeSectorsImpl(const SectorBuffer* buffers,
+	                      size_t startSector, size_t num) override;
 	size_t getNbSectorsImpl() const override;
 	bool isWriteProtectedImpl() const override;
 	Sha1Sum getSha1SumImpl(FilePool& filePool) override;
@@ -54,6 +58,7 @@ private:
 	bool isCacheStillValid(time_t& time) override;
 
 	void showProgress(size_t position, size_t maxPosition);
+	std::string getTigerTreeCacheFile() const;
 
 	MSXMotherBoard& motherBoard;
 	std::string name;
@@ -73,7 +78,7 @@ private:
 };
 
 REGISTER_BASE_CLASS(HD, "HD");
-SERIALIZE_CLASS_VERSION(HD, 2);
+SERIALIZE_CLASS_VERSION(HD, 3);
 
 } // namespace openmsx
 
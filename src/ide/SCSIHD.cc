@@ -273,20 +273,16 @@ unsigned SCSIHD::readSectors(unsigned& blocks)
 	unsigned numSectors = std::min(currentLength, BUFFER_BLOCK_SIZE);
 	unsigned counter = currentLength * SECTOR_SIZE;
 
-	try {
-		for (unsigned i = 0; i < numSectors; ++i) {
-			auto* sbuf = aligned_cast<SectorBuffer*>(buffer);
-			readSector(currentSector, sbuf[i]);
-			++currentSector;
-			--currentLength;
-		}
-		blocks = currentLength;
-		return counter;
-	} catch (MSXException&) {
+	auto* sbuf = aligned_cast<SectorBuffer*>(buffer);
+	if (SectorAccessibleDisk::readSectors(sbuf, currentSector, numSectors)) {
 		blocks = 0;
 		keycode = SCSI::SENSE_UNRECOVERED_READ_ERROR;
 		return 0;
 	}
+	currentSector += numSectors;
+	currentLength -= numSectors;
+	blocks = currentLength;
+	return counter;
 }
 
 unsigned SCSIHD::dataIn(unsigned& blocks)
@@ -307,23 +303,19 @@ unsigned SCSIHD::writeSectors(unsigned& blocks)
 
 	unsigned numSectors = std::min(currentLength, BUFFER_BLOCK_SIZE);
 
-	try {
-		for (unsigned i = 0; i < numSectors; ++i) {
-			auto* sbuf = aligned_cast<const SectorBuffer*>(buffer);
-			writeSector(currentSector, sbuf[i]);
-			++currentSector;
-			--currentLength;
-		}
-
-		unsigned tmp = std::min(currentLength, BUFFER_BLOCK_SIZE);
-		blocks = currentLength - tmp;
-		unsigned counter = tmp * SECTOR_SIZE;
-		return counter;
-	} catch (MSXException&) {
+	auto* sbuf = aligned_cast<const SectorBuffer*>(buffer);
+	if (SectorAccessibleDisk::writeSectors(sbuf, currentSector, numSectors)) {
 		keycode = SCSI::SENSE_WRITE_FAULT;
 		blocks = 0;
 		return 0;
 	}
+	currentSector += numSectors;
+	currentLength -= numSectors;
+
+	unsigned tmp = std::min(currentLength, BUFFER_BLOCK_SIZE);
+	blocks = currentLength - tmp;
+	unsigned counter = tmp * SECTOR_SIZE;
+	return counter;
 }
 
 unsigned SCSIHD::dataOut(unsigned& blocks)
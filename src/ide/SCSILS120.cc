@@ -382,19 +382,16 @@ unsigned SCSILS120::readSector(unsigned& blocks)
 	unsigned numSectors = std::min(currentLength, BUFFER_BLOCK_SIZE);
 	unsigned counter = currentLength * SECTOR_SIZE;
 
-	try {
-		// TODO: somehow map this to SectorAccessibleDisk::readSector?
-		file.seek(SECTOR_SIZE * currentSector);
-		file.read(buffer, SECTOR_SIZE * numSectors);
-		currentSector += numSectors;
-		currentLength -= numSectors;
-		blocks = currentLength;
-		return counter;
-	} catch (FileException&) {
+	auto* sbuf = aligned_cast<SectorBuffer*>(buffer);
+	if (readSectors(sbuf, currentSector, numSectors)) {
 		blocks = 0;
 		keycode = SCSI::SENSE_UNRECOVERED_READ_ERROR;
 		return 0;
 	}
+	currentSector += numSectors;
+	currentLength -= numSectors;
+	blocks = currentLength;
+	return counter;
 }
 
 unsigned SCSILS120::dataIn(unsigned& blocks)
@@ -417,22 +414,19 @@ unsigned SCSILS120::writeSector(unsigned& blocks)
 
 	unsigned numSectors = std::min(currentLength, BUFFER_BLOCK_SIZE);
 
-	// TODO: somehow map this to SectorAccessibleDisk::writeSector?
-	try {
-		file.seek(SECTOR_SIZE * currentSector);
-		file.write(buffer, SECTOR_SIZE * numSectors);
-		currentSector += numSectors;
-		currentLength -= numSectors;
-
-		unsigned tmp = std::min(currentLength, BUFFER_BLOCK_SIZE);
-		blocks = currentLength - tmp;
-		unsigned counter = tmp * SECTOR_SIZE;
-		return counter;
-	} catch (FileException&) {
+	auto* sbuf = aligned_cast<const SectorBuffer*>(buffer);
+	if (writeSectors(sbuf, currentSector, numSectors)) {
 		keycode = SCSI::SENSE_WRITE_FAULT;
 		blocks = 0;
 		return 0;
 	}
+	currentSector += numSectors;
+	currentLength -= numSectors;
+
+	unsigned tmp = std::min(currentLength, BUFFER_BLOCK_SIZE);
+	blocks = currentLength - tmp;
+	unsigned counter = tmp * SECTOR_SIZE;
+	return counter;
 }
 
 unsigned SCSILS120::dataOut(unsigned& blocks)
@@ -713,14 +707,26 @@ Sha1Sum SCSILS120::getSha1SumImpl(FilePool& filePool)
 
 void SCSILS120::readSectorImpl(size_t sector, SectorBuffer& buf)
 {
-	file.seek(sizeof(buf) * sector);
-	file.read(&buf, sizeof(buf));
+	readSectorsImpl(&buf, sector, 1);
 }
 
 void SCSILS120::writeSectorImpl(size_t sector, const SectorBuffer& buf)
 {
-	file.seek(sizeof(buf) * sector);
-	file.write(&buf, sizeof(buf));
+	writeSectorsImpl(&buf, sector, 1);
+}
+
+void SCSILS120::readSectorsImpl(
+	SectorBuffer* buffers, size_t startSector, size_t num)
+{
+	file.seek(sizeof(SectorBuffer) * startSector);
+	file.read(buffers, sizeof(SectorBuffer) * num);
+}
+
+void SCSILS120::writeSectorsImpl(
+	const SectorBuffer* buffers, size_t startSector, size_t num)
+{
+	file.seek(sizeof(SectorBuffer) * startSector);
+	file.write(buffers, sizeof(SectorBuffer) * num);
 }
 
 SectorAccessibleDisk* SCSILS120::getSectorAccessibleDisk()
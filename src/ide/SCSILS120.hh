@@ -41,6 +41,10 @@ private:
 	// SectorAccessibleDisk:
 	void readSectorImpl (size_t sector,       SectorBuffer& buf) override;
 	void writeSectorImpl(size_t sector, const SectorBuffer& buf) override;
+	void readSectorsImpl (      SectorBuffer* buffers,
+	                      size_t startSector, size_t num) override;
+	void writeSectorsImpl(const SectorBuffer* buffers,
+	                      size_t startSector, size_t num) override;
 	size_t getNbSectorsImpl() const override;
 	bool isWriteProtectedImpl() const override;
 	Sha1Sum getSha1SumImpl(FilePool& filePool) override;
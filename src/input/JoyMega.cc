@@ -5,6 +5,7 @@
 #include "InputEvents.hh"
 #include "InputEventGenerator.hh"
 #include "StateChange.hh"
+#include "MemoryPool.hh"
 #include "checked_cast.hh"
 #include "serialize.hh"
 #include "serialize_meta.hh"
@@ -300,7 +301,7 @@ void JoyMega::createEvent(EmuTime::param time, unsigned newStatus)
 	// make sure we create an event with minimal changes
 	unsigned press   =    status & diff;
 	unsigned release = newStatus & diff;
-	stateChangeDistributor.distributeNew(std::make_shared<JoyMegaState>(
+	stateChangeDistributor.distributeNew(make_pooled_shared<JoyMegaState>(
 		time, joyNum, press, release));
 }
 
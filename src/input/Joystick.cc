@@ -11,6 +11,7 @@
 #include "IntegerSetting.hh"
 #include "CommandController.hh"
 #include "CommandException.hh"
+#include "MemoryPool.hh"
 #include "serialize.hh"
 #include "serialize_meta.hh"
 #include "memory.hh"
@@ -329,7 +330,7 @@ void Joystick::createEvent(EmuTime::param time, byte newStatus)
 	// make sure we create an event with minimal changes
 	byte press   =    status & diff;
 	byte release = newStatus & diff;
-	stateChangeDistributor.distributeNew(std::make_shared<JoyState>(
+	stateChangeDistributor.distributeNew(make_pooled_shared<JoyState>(
 		time, joyNum, press, release));
 }
 
@@ -4,6 +4,7 @@
 #include "InputEvents.hh"
 #include "StateChange.hh"
 #include "Clock.hh"
+#include "MemoryPool.hh"
 #include "checked_cast.hh"
 #include "serialize.hh"
 #include "serialize_meta.hh"
@@ -282,7 +283,7 @@ void Mouse::signalEvent(const shared_ptr<const Event>& event, EmuTime::param tim
 void Mouse::createMouseStateChange(
 	EmuTime::param time, int deltaX, int deltaY, byte press, byte release)
 {
-	stateChangeDistributor.distributeNew(std::make_shared<MouseState>(
+	stateChangeDistributor.distributeNew(make_pooled_shared<MouseState>(
 		time, deltaX, deltaY, press, release));
 }
 
@@ -15,6 +15,7 @@
 #include "CommandException.hh"
 #include "Clock.hh"
 #include "Math.hh"
+#include "MemoryPool.hh"
 #include "checked_cast.hh"
 #include "serialize.hh"
 #include "serialize_meta.hh"
@@ -261,7 +262,7 @@ void Touchpad::signalEvent(const shared_ptr<const Event>& event,
 void Touchpad::createTouchpadStateChange(
 	EmuTime::param time, byte x_, byte y_, bool touch_, bool button_)
 {
-	stateChangeDistributor.distributeNew(std::make_shared<TouchpadState>(
+	stateChangeDistributor.distributeNew(make_pooled_shared<TouchpadState>(
 		time, x_, y_, touch_, button_));
 }
 
@@ -281,7 +282,7 @@ void Touchpad::stopReplay(EmuTime::param time)
 	// TODO Get actual mouse state. Is it worth the trouble?
 	if (x || y || touch || button) {
 		stateChangeDistributor.distributeNew(
-			std::make_shared<TouchpadState>(
+			make_pooled_shared<TouchpadState>(
 				time, 0, 0, false, false));
 	}
 }
@@ -4,6 +4,7 @@
 #include "InputEvents.hh"
 #include "StateChange.hh"
 #include "Math.hh"
+#include "MemoryPool.hh"
 #include "checked_cast.hh"
 #include "serialize.hh"
 #include "serialize_meta.hh"
@@ -257,7 +258,7 @@ void Trackball::signalEvent(const shared_ptr<const Event>& event,
 void Trackball::createTrackballStateChange(
 	EmuTime::param time, int deltaX, int deltaY, byte press, byte release)
 {
-	stateChangeDistributor.distributeNew(std::make_shared<TrackballState>(
+	stateChangeDistributor.distributeNew(make_pooled_shared<TrackballState>(
 		time, deltaX, deltaY, press, release));
 }
 
@@ -279,7 +280,7 @@ void Trackball::stopReplay(EmuTime::param time)
 	byte release = (JOY_BUTTONA | JOY_BUTTONB) & ~status;
 	if ((currentDeltaX != 0) || (currentDeltaY != 0) || (release != 0)) {
 		stateChangeDistributor.distributeNew(
-			std::make_shared<TrackballState>(
+			make_pooled_shared<TrackballState>(
 				time, -currentDeltaX, -currentDeltaY, 0, release));
 	}
 }
@@ -3,12 +3,17 @@
 #include "yuv2rgb.hh"
 #include "likely.hh"
 #include "CliComm.hh"
+#include "FileOperations.hh"
+#include "Filename.hh"
 #include "StringOp.hh"
 #include "MemoryOps.hh"
 #include "memory.hh"
 #include "stl.hh"
 #include "stringsp.hh" // for strncasecmp
+#include "endian.hh"
+#include "sha1.hh"
 #include <algorithm>
+#include <cstdio>
 #include <cstring> // for memcpy, memcmp
 #include <cstdlib> // for atoi
 #include <cctype> // for isspace
@@ -19,6 +24,32 @@
 // - Clean up this mess!
 namespace openmsx {
 
+// Size of an ogg page header, without the segment table.
+static const size_t OGG_HEADER_SIZE = 27;
+
+// The page index is built in steps of (at most) this many bytes of the file,
+// so that the decoder thread can handle requests in between.
+static const size_t INDEX_STEP = 4 * 1024 * 1024;
+
+// Layout of the index cache file: this header, followed by 'numVideo' and
+// then 'numAudio' entries.
+static const char INDEX_MAGIC[8] = { 'o','M','S','X','o','g','x','1' };
+struct IndexCacheHeader
+{
+	char magic[8];
+	uint64_t fileSize;
+	int64_t time;
+	uint64_t indexedSize;
+	uint64_t numVideo;
+	uint64_t numAudio;
+};
+struct IndexCacheEntry
+{
+	uint64_t offset;
+	uint64_t granule;
+	uint64_t keyFrame;
+};
+
 Frame::Frame(const th_ycbcr_buffer& yuv)
 {
 	unsigned y_size  = yuv[0].height * yuv[0].stride;
@@ -46,6 +77,17 @@ Frame::~Frame()
 OggReader::OggReader(const Filename& filename, CliComm& cli_)
 	: cli(cli_)
 	, file(filename)
+	, totalFrames(0)
+	, indexedSize(0)
+	, indexDone(false)
+	, requestedFrame(1)
+	, seekFrame(1)
+	, seekSample(0)
+	, decodedPackets(0)
+	, seekPending(true) // start decoding at the beginning of the streams
+	, endOfStream(false)
+	, waiting(false)
+	, quitDecoder(false)
 {
 	audioSerial = -1;
 	videoSerial = -1;
@@ -69,7 +111,6 @@ OggReader::OggReader(const Filename& filename, CliComm& cli_)
 
 	ogg_sync_init(&sync);
 
-	state = PLAYING;
 	fileOffset = 0;
 	fileSize = file.getSize();
 
@@ -189,6 +230,16 @@ OggReader::OggReader(const Filename& filename, CliComm& cli_)
 		if (ti.pixel_fmt != TH_PF_420) {
 			throw MSXException("Video must be YUV420");
 		}
+
+		// Building the page index requires reading the whole file,
+		// that happens in the decoder thread (or the index is loaded
+		// from the cache). Only the number of frames is needed now.
+		indexCacheFile = FileOperations::getUserDataDir() + "/oggindex/" +
+			SHA1::calc(reinterpret_cast<const uint8_t*>(
+				filename.getResolved().data()),
+				filename.getResolved().size()).toString();
+		fileTime = file.getModificationDate();
+		totalFrames = findLastFrame();
 	}
 	catch (MSXException&) {
 		th_setup_free(tsi);
@@ -201,6 +252,8 @@ OggReader::OggReader(const Filename& filename, CliComm& cli_)
 	th_setup_free(tsi);
 	th_info_clear(&ti);
 	th_comment_clear(&tc);
+
+	decoder = std::thread([this]() { decoderMain(); });
 }
 
 void OggReader::cleanup()
@@ -227,6 +280,12 @@ void OggReader::cleanup()
 
 OggReader::~OggReader()
 {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quitDecoder = true;
+	}
+	decoderCond.notify_one();
+	decoder.join();
 	cleanup();
 }
 
@@ -245,7 +304,7 @@ void OggReader::vorbisFoundPosition()
 
 	// last is now the first vorbis audio decoded
 	if (last > currentSample) {
-		cli.printWarning("missing part of audio stream");
+		warning("missing part of audio stream");
 	}
 
 	if (vorbisPos > currentSample) {
@@ -322,29 +381,9 @@ void OggReader::theoraHeaderPage(ogg_page* page, th_info& ti, th_comment& tc,
 
 void OggReader::readVorbis(ogg_packet* packet)
 {
-	// deal with header packets
-	if (unlikely(packet->packetno <= 2)) {
-		return;
-	}
-
-	if (state == FIND_LAST) {
-		if (packet->granulepos != -1) {
-			if ((currentSample == AudioFragment::UNKNOWN_POS) ||
-			    (size_t(packet->granulepos) > currentSample)) {
-				currentSample = packet->granulepos;
-			}
-		}
-		return;
-
-	} else if (state == FIND_FIRST) {
-		if (packet->granulepos != -1 &&
-				currentSample == AudioFragment::UNKNOWN_POS) {
-			currentSample = packet->granulepos;
-		}
-		return;
-
-	} else if (state == FIND_KEYFRAME) {
-		// Not relevant for vorbis
+	// deal with header packets (packet type is odd), note that we can't
+	// use the packet number, it restarts from zero after a seek
+	if (unlikely((packet->bytes > 0) && (packet->packet[0] & 1))) {
 		return;
 	}
 
@@ -357,8 +396,16 @@ void OggReader::readVorbis(ogg_packet* packet)
 
 	float** pcm;
 	long decoded = vorbis_synthesis_pcmout(&vd, &pcm);
-	long pos = 0;
 
+	std::lock_guard<std::mutex> lock(mutex);
+	if (seekPending) {
+		// we'll start reading at a different position soon, no
+		// need to queue this audio
+		vorbis_synthesis_read(&vd, decoded);
+		return;
+	}
+
+	long pos = 0;
 	while (pos < decoded)  {
 		// Find memory to copy PCM into
 		if (recycleAudioList.empty()) {
@@ -408,7 +455,7 @@ void OggReader::readVorbis(ogg_packet* packet)
 			vorbisFoundPosition();
 		} else {
 			if (vorbisPos != size_t(packet->granulepos)) {
-				cli.printWarning("vorbis audio out of sync, "
+				warning("vorbis audio out of sync, "
 					"expected " +
 					StringOp::toString(vorbisPos) +
 					", got " +
@@ -484,74 +531,51 @@ void OggReader::readTheora(ogg_packet* packet)
 
 	size_t frameno = frameNo(packet);
 
-	// If we're seeking, we're only interested in packets with
-	// frame numbers
-	if ((state != PLAYING) && (frameno == size_t(-1))) {
-		return;
-	}
-
-	if (state == FIND_LAST) {
-		if ((currentFrame == size_t(-1)) || (currentFrame < frameno)) {
-			currentFrame = frameno;
-		}
-		return;
-
-	} else if (state == FIND_FIRST) {
-		if ((currentFrame == size_t(-1)) || (currentFrame > frameno)) {
-			currentFrame = frameno;
-		}
-		return;
-
-	} else if (state == FIND_KEYFRAME) {
-		if (frameno < currentFrame) {
-			keyFrame = packet->granulepos >> granuleShift;
-		} else if (currentFrame == frameno) {
-			keyFrame = packet->granulepos >> granuleShift;
-			currentSample = 1;
-		} else if (frameno > currentFrame) {
-			currentSample = 1;
-		}
-		return;
-	}
-
 	if ((keyFrame != size_t(-1)) && (frameno != size_t(-1)) &&
 	    (frameno < keyFrame)) {
 		// We're reading before the keyframe, discard
 		return;
 	}
 
-	if (packet->bytes == 0 && frameList.empty()) {
-		// No use passing empty packets (which represent dup frame)
-		// before we've read any frame.
-		return;
+	if (packet->bytes == 0) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (frameList.empty()) {
+			// No use passing empty packets (which represent dup
+			// frame) before we've read any frame.
+			return;
+		}
 	}
 
 	keyFrame = size_t(-1);
 
 	int rc = th_decode_packetin(theora, packet, nullptr);
 	switch (rc) {
-	case TH_DUPFRAME:
-		if (frameList.empty()) {
-			cli.printWarning("Theora error: dup frame encountered "
-					 "without preceding frame");
+	case TH_DUPFRAME: {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (seekPending) {
+			// frame will be discarded anyway
+		} else if (frameList.empty()) {
+			warning("Theora error: dup frame encountered "
+			        "without preceding frame");
 		} else {
 			frameList.back()->length++;
 		}
 		break;
+	}
 	case TH_EIMPL:
-		cli.printWarning("Theora error: not capable of reading this");
+		warning("Theora error: not capable of reading this");
 		break;
 	case TH_EFAULT:
-		cli.printWarning("Theora error: API not used correctly");
+		warning("Theora error: API not used correctly");
 		break;
 	case TH_EBADPACKET:
-		cli.printWarning("Theora error: bad packet");
+		warning("Theora error: bad packet");
 		break;
 	case 0:
 		break;
 	default:
-		cli.printWarning("Theora error: unknown error " +
-					StringOp::toString(rc));
+		warning("Theora error: unknown error " +
+		        StringOp::toString(rc));
 		break;
 	}
 
@@ -571,6 +595,12 @@ void OggReader::readTheora(ogg_packet* packet)
 
 	currentFrame = frameno + 1;
 
+	std::lock_guard<std::mutex> lock(mutex);
+	if (seekPending) {
+		// This frame belongs to the old position
+		return;
+	}
+
 	std::unique_ptr<Frame> frame;
 	if (recycleFrameList.empty()) {
 		frame = make_unique<Frame>(yuv);
@@ -592,7 +622,7 @@ void OggReader::readTheora(ogg_packet* packet)
 	if (last && (last->no != size_t(-1))) {
 		if ((frameno != size_t(-1)) &&
 		    (frameno != last->no + last->length)) {
-			cli.printWarning("Theora frame sequence wrong");
+			warning("Theora frame sequence wrong");
 		} else {
 			frameno = last->no + last->length;
 		}
@@ -618,13 +648,17 @@ void OggReader::readTheora(ogg_packet* packet)
 
 void OggReader::getFrameNo(RawFrame& rawFrame, size_t frameno)
 {
+	printWarnings();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	requestedFrame = frameno;
 	Frame* frame;
 	while (true) {
 		// If there are no frames or the frames we have read
 		// does not include a proper frame number, just read
 		// more data
 		if (frameList.empty() || (frameList[0]->no == size_t(-1))) {
-			if (!nextPacket()) {
+			if (!waitForData(lock)) {
 				return;
 			}
 			continue;
@@ -640,7 +674,7 @@ void OggReader::getFrameNo(RawFrame& rawFrame, size_t frameno)
 		if (!frameList.empty() && frameList[0]->no > frameno) {
 			// we're missing frames!
 			frame = frameList[0].get();
-			cli.printWarning("Cannot find frame " +
+			warnings.push_back("Cannot find frame " +
 				StringOp::toString(frameno) + " using " +
 				StringOp::toString(frame->no) + " instead");
 			break;
@@ -664,17 +698,22 @@ void OggReader::getFrameNo(RawFrame& rawFrame, size_t frameno)
 		if (frameList.size() > (2u << granuleShift)) {
 			// We've got more than twice as many frames
 			// as the maximum distance between key frames.
-			cli.printWarning("Cannot find frame " +
+			warnings.push_back("Cannot find frame " +
 				StringOp::toString(frameno));
 			return;
 		}
 
 		// ..add read some new ones
-		if (!nextPacket()) {
+		if (!waitForData(lock)) {
 			return;
 		}
 	}
+	lock.unlock();
+	// Frames we removed from the window can be refilled.
+	decoderCond.notify_one();
 
+	// Only this thread removes frames from 'frameList', so 'frame'
+	// remains valid while converting without holding the lock.
 	yuv2rgb::convert(frame->buffer, rawFrame);
 }
 
@@ -686,10 +725,14 @@ void OggReader::recycleAudio(std::unique_ptr<AudioFragment> audio)
 
 const AudioFragment* OggReader::getAudio(size_t sample)
 {
+	printWarnings();
+
+	std::unique_lock<std::mutex> lock(mutex);
+
 	// Read while position is unknown
 	while (audioList.empty() ||
 	       audioList.front()->position == AudioFragment::UNKNOWN_POS) {
-		if (!nextPacket()) {
+		if (!waitForData(lock)) {
 			return nullptr;
 		}
 	}
@@ -716,7 +759,7 @@ const AudioFragment* OggReader::getAudio(size_t sample)
 		if (it == end(audioList)) {
 			size_t size = audioList.size();
 			while (size == audioList.size()) {
-				if (!nextPacket()) {
+				if (!waitForData(lock)) {
 					return nullptr;
 				}
 			}
@@ -758,14 +801,14 @@ bool OggReader::nextPacket()
 		int serial = ogg_page_serialno(&page);
 		if (serial == audioSerial) {
 			if (ogg_stream_pagein(&vorbisStream, &page)) {
-				cli.printWarning("Failed to submit vorbis page");
+				warning("Failed to submit vorbis page");
 			}
 		} else if (serial == videoSerial) {
 			if (ogg_stream_pagein(&theoraStream, &page)) {
-				cli.printWarning("Failed to submit theora page");
+				warning("Failed to submit theora page");
 			}
 		} else if (serial != skeletonSerial) {
-			cli.printWarning("Unexpected stream with serial " +
+			warning("Unexpected stream with serial " +
 				StringOp::toString(serial) + " in ogg file");
 		}
 	}
@@ -796,109 +839,183 @@ bool OggReader::nextPage(ogg_page* page)
 		fileOffset += chunk;
 
 		if (ogg_sync_wrote(&sync, long(chunk)) == -1) {
-			cli.printWarning("Internal error: ogg_sync_wrote failed");
+			warning("Internal error: ogg_sync_wrote failed");
 		}
 	}
 
 	return true;
 }
 
-size_t OggReader::bisection(
-	size_t frame, size_t sample,
-	size_t maxOffset, size_t maxSamples, size_t maxFrames)
+size_t OggReader::findLastFrame()
 {
-	// Defined to be a power-of-two such that the arthmetic can be done faster.
-	// Note that the sample-number is in the range of: 1..(44100*60*60)
-	static const uint64_t SHIFT = 0x20000000ull;
+	// The last pages are at most this far from the end of the file.
+	static const size_t TAIL = 256 * 1024;
 
-	uint64_t offsetA = 0, offsetB = maxOffset;
-	uint64_t sampleA = 0, sampleB = maxSamples;
-	uint64_t frameA = 1, frameB = maxFrames;
+	size_t start = fileSize - std::min(fileSize, TAIL);
+	std::vector<byte> buf(fileSize - start);
+	file.seek(start);
+	file.read(buf.data(), buf.size());
+	file.seek(fileOffset);
 
-	while (true) {
-		uint64_t ratio = (frame - frameA) * SHIFT / (frameB - frameA);
-		if (ratio < 5) {
-			return offsetA;
-		}
-
-		uint64_t frameOffset = ratio * (offsetB - offsetA) / SHIFT + offsetA;
-		ratio = (sample - sampleA) * SHIFT / (sampleB - sampleA);
-		if (ratio < 5) {
-			return offsetA;
-		}
-		uint64_t sampleOffset = ratio * (offsetB - offsetA) / SHIFT + offsetA;
-		auto offset = std::min(sampleOffset, frameOffset);
-
-		file.seek(offset);
-		fileOffset = offset;
-		ogg_sync_reset(&sync);
-		currentFrame = size_t(-1);
-		currentSample = AudioFragment::UNKNOWN_POS;
-		state = FIND_FIRST;
-
-		while (((currentFrame == size_t(-1)) ||
-			(currentSample == AudioFragment::UNKNOWN_POS)) &&
-		       nextPacket()) {
-			// continue reading
-		}
-
-		state = PLAYING;
-
-		if (currentSample > sample || currentFrame > frame) {
-			offsetB = offset;
-			sampleB = currentSample;
-			frameB = currentFrame;
-		} else if (currentSample + getSampleRate() < sample &&
-				currentFrame + 64 < frame) {
-			offsetA = offset;
-			sampleA = currentSample;
-			frameA = currentFrame;
-		} else {
-			return offset;
-		}
+	size_t last = 0;
+	for (size_t i = 0; (i + OGG_HEADER_SIZE) <= buf.size(); ++i) {
+		const byte* header = &buf[i];
+		if ((memcmp(header, "OggS", 4) != 0) || (header[4] != 0)) continue;
+		auto granule = int64_t(Endian::read_UA_L64(header + 6));
+		int serial = Endian::read_UA_L32(header + 14);
+		if ((serial != videoSerial) || (granule == -1)) continue;
+		size_t key   = granule >> granuleShift;
+		size_t intra = granule & ((1 << granuleShift) - 1);
+		last = std::max(last, key + intra);
 	}
+	return last;
 }
 
-size_t OggReader::findOffset(size_t frame, size_t sample)
+bool OggReader::extendIndex(size_t maxBytes)
 {
-	static const size_t STEP = 32 * 1024;
-
-	// first calculate total length in bytes, samples and frames
-
-	// The file might have changed since we last requested its size,
-	// we assume that only data will be added to it and the ogg streams
-	// are exactly as before
-	fileSize = file.getSize();
-	auto offset = fileSize - 1;
-
-	while (offset > 0) {
-		if (offset > STEP) {
-			offset -= STEP;
-		} else {
-			offset = 0;
+	// Only the page headers are parsed, the packets themselves are not
+	// decoded. The file is read in big chunks, most pages are a lot
+	// smaller than a chunk.
+	static const size_t CHUNK = 64 * 1024;
+
+	std::vector<byte> buf(CHUNK);
+	size_t bufStart = 0;
+	size_t bufSize = 0;
+	// make sure file[offset, offset + size) is in 'buf'
+	auto fill = [&](size_t offset, size_t size) {
+		if ((offset < bufStart) || ((offset + size) > (bufStart + bufSize))) {
+			bufStart = offset;
+			bufSize = std::min(CHUNK, fileSize - offset);
+			file.seek(offset);
+			file.read(buf.data(), bufSize);
 		}
-
-		file.seek(offset);
-		fileOffset = offset;
-		ogg_sync_reset(&sync);
-		currentFrame = size_t(-1);
-		currentSample = AudioFragment::UNKNOWN_POS;
-		state = FIND_LAST;
-
-		while (nextPacket()) {
-			// continue reading
+		return &buf[offset - bufStart];
+	};
+
+	size_t offset = indexedSize;
+	size_t stop = offset + std::min(maxBytes, fileSize - offset);
+	bool done = true;
+	while ((offset + OGG_HEADER_SIZE) <= fileSize) {
+		if (offset >= stop) {
+			done = false;
+			break;
+		}
+		const byte* header = fill(offset, OGG_HEADER_SIZE);
+		if (memcmp(header, "OggS", 4) != 0) {
+			// Not at the start of a page (corrupt file?), search
+			// for the next one.
+			++offset;
+			continue;
 		}
+		unsigned segments = header[26];
+		if ((offset + OGG_HEADER_SIZE + segments) > fileSize) break;
+		header = fill(offset, OGG_HEADER_SIZE + segments);
+		size_t pageSize = OGG_HEADER_SIZE + segments;
+		for (unsigned i = 0; i < segments; ++i) {
+			pageSize += header[OGG_HEADER_SIZE + i];
+		}
+		if ((offset + pageSize) > fileSize) break; // incomplete page
+
+		auto granule = int64_t(Endian::read_UA_L64(header + 6));
+		int serial = Endian::read_UA_L32(header + 14);
+		if (granule != -1) {
+			if (serial == videoSerial) {
+				size_t key   = granule >> granuleShift;
+				size_t intra = granule & ((1 << granuleShift) - 1);
+				videoIndex.push_back({offset, key + intra, key});
+			} else if (serial == audioSerial) {
+				audioIndex.push_back({offset, size_t(granule), 0});
+			}
+		}
+		offset += pageSize;
+	}
+	indexedSize = offset;
+	// the decoder continues reading where it was
+	file.seek(fileOffset);
 
-		state = PLAYING;
+	if (!videoIndex.empty() && (videoIndex.back().granule > totalFrames)) {
+		totalFrames = videoIndex.back().granule;
+	}
+	if (done) storeIndex();
+	return done;
+}
 
-		if ((currentFrame != size_t(-1)) &&
-		    (currentSample != AudioFragment::UNKNOWN_POS)) {
-			break;
+bool OggReader::indexCovers(size_t frame, size_t sample) const
+{
+	return !videoIndex.empty() && (videoIndex.back().granule >= frame) &&
+	       !audioIndex.empty() && (audioIndex.back().granule >= sample);
+}
+
+bool OggReader::loadIndex()
+{
+	auto f = FileOperations::openFile(indexCacheFile, "rb");
+	if (!f) return false;
+
+	IndexCacheHeader header;
+	if ((fread(&header, sizeof(header), 1, f.get()) != 1) ||
+	    (memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) ||
+	    (header.fileSize != fileSize) ||
+	    (header.time != int64_t(fileTime)) ||
+	    (header.indexedSize > fileSize) ||
+	    (header.numVideo > (fileSize / OGG_HEADER_SIZE)) ||
+	    (header.numAudio > (fileSize / OGG_HEADER_SIZE))) {
+		return false;
+	}
+	std::vector<PageIndex> newVideo, newAudio;
+	for (uint64_t i = 0; i < (header.numVideo + header.numAudio); ++i) {
+		IndexCacheEntry e;
+		if ((fread(&e, sizeof(e), 1, f.get()) != 1) ||
+		    (e.offset >= header.indexedSize)) {
+			return false;
 		}
+		auto& index = (i < header.numVideo) ? newVideo : newAudio;
+		index.push_back({size_t(e.offset), size_t(e.granule),
+		                 size_t(e.keyFrame)});
+	}
+	videoIndex = std::move(newVideo);
+	audioIndex = std::move(newAudio);
+	indexedSize = header.indexedSize;
+	if (!videoIndex.empty() && (videoIndex.back().granule > totalFrames)) {
+		totalFrames = videoIndex.back().granule;
 	}
+	return true;
+}
 
-	totalFrames = currentFrame;
+void OggReader::storeIndex() const
+{
+	// It's only a cache, so silently ignore all errors.
+	try {
+		FileOperations::mkdirp(FileOperations::getBaseName(indexCacheFile));
+	} catch (MSXException&) {
+		return;
+	}
+	auto f = FileOperations::openFile(indexCacheFile, "wb");
+	if (!f) return;
+
+	IndexCacheHeader header;
+	memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+	header.fileSize = fileSize;
+	header.time = fileTime;
+	header.indexedSize = indexedSize;
+	header.numVideo = videoIndex.size();
+	header.numAudio = audioIndex.size();
+	std::vector<IndexCacheEntry> entries;
+	entries.reserve(videoIndex.size() + audioIndex.size());
+	for (auto* index : { &videoIndex, &audioIndex }) {
+		for (auto& p : *index) {
+			entries.push_back({p.offset, p.granule, p.keyFrame});
+		}
+	}
+	if ((fwrite(&header, sizeof(header), 1, f.get()) != 1) ||
+	    (fwrite(entries.data(), sizeof(IndexCacheEntry), entries.size(),
+	            f.get()) != entries.size())) {
+		f.reset();
+		FileOperations::unlink(indexCacheFile);
+	}
+}
 
+size_t OggReader::findOffset(size_t frame, size_t sample)
+{
 	// If we're close to beginning, don't bother searching for it,
 	// just start at the beginning (arbitrary boundary of 1 second).
 	if (sample < getSampleRate() || frame <= 30) {
@@ -906,68 +1023,220 @@ size_t OggReader::findOffset(size_t frame, size_t sample)
 		return 0;
 	}
 
-	auto maxOffset = offset;
-	auto maxSamples = currentSample;
-	auto maxFrames = currentFrame;
-
-	if ((sample > maxSamples) || (frame > maxFrames)) {
-		sample = maxSamples;
-		frame = maxFrames;
+	// The file might have changed since we built the index, we assume
+	// that only data will be added to it and the ogg streams are exactly
+	// as before
+	size_t newSize = file.getSize();
+	if (newSize > fileSize) {
+		fileSize = newSize;
+		indexDone = false;
+	}
+	// Normally the index is already (completely) built in the background,
+	// otherwise only extend it as far as needed for this seek.
+	while (!indexDone && !indexCovers(frame, sample)) {
+		indexDone = extendIndex(INDEX_STEP);
+	}
+	if (videoIndex.empty() || audioIndex.empty()) {
+		keyFrame = 1;
+		return 0;
 	}
 
-	offset = bisection(frame, sample, maxOffset, maxSamples, maxFrames);
-
-	// Find key frame
-	file.seek(offset);
-	fileOffset = offset;
-	ogg_sync_reset(&sync);
-	currentFrame = frame;
-	currentSample = 0;
-	keyFrame = size_t(-1);
-	state = FIND_KEYFRAME;
+	if ((sample > audioIndex.back().granule) ||
+	    (frame > videoIndex.back().granule)) {
+		sample = audioIndex.back().granule;
+		frame = videoIndex.back().granule;
+	}
 
-	while (currentSample == 0 && nextPacket()) {
-		// continue reading
+	auto lessGranule = [](const PageIndex& p, size_t g) {
+		return p.granule < g;
+	};
+
+	// Find the keyframe of the requested frame. The first page that
+	// ends in (or after) the requested frame knows the keyframe for
+	// its last packet. If that is a later keyframe, the previous page
+	// knows an earlier one (possibly earlier than strictly needed).
+	auto v = std::lower_bound(begin(videoIndex), end(videoIndex),
+	                          frame, lessGranule);
+	keyFrame = v->keyFrame;
+	if (keyFrame > frame) {
+		keyFrame = (v == begin(videoIndex)) ? 1 : (v - 1)->keyFrame;
 	}
 
-	state = PLAYING;
+	// The keyframe packet starts somewhere after the last packet that
+	// ends before it, so start reading at the page of that packet.
+	v = std::lower_bound(begin(videoIndex), end(videoIndex),
+	                     keyFrame, lessGranule);
+	size_t videoOffset = (v == begin(videoIndex)) ? 0 : (v - 1)->offset;
 
-	if ((keyFrame == size_t(-1)) || (frame == keyFrame)) {
-		return offset;
-	}
+	// Same for audio, but start one page earlier: vorbis needs the
+	// preceding packet to produce output.
+	auto a = std::lower_bound(begin(audioIndex), end(audioIndex),
+	                          sample, lessGranule);
+	auto dist = a - begin(audioIndex);
+	size_t audioOffset = (dist < 2) ? 0 : (a - 2)->offset;
 
-	return bisection(keyFrame, sample, maxOffset, maxSamples, maxFrames);
+	return std::min(videoOffset, audioOffset);
 }
 
 bool OggReader::seek(size_t frame, size_t samples)
 {
-	// Remove all queued frames
-	recycleFrameList.insert(end(recycleFrameList),
-		make_move_iterator(begin(frameList)),
-		make_move_iterator(end  (frameList)));
-	frameList.clear();
+	printWarnings();
 
-	// Remove all queued audio
-	if (!recycleAudioList.empty()) {
-		recycleAudioList.front()->length = 0;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		// Remove all queued frames
+		recycleFrameList.insert(end(recycleFrameList),
+			make_move_iterator(begin(frameList)),
+			make_move_iterator(end  (frameList)));
+		frameList.clear();
+
+		// Remove all queued audio
+		for (auto& a : audioList) {
+			recycleAudio(std::move(a));
+		}
+		audioList.clear();
+
+		// The actual seek is done by the decoder thread
+		requestedFrame = frame;
+		seekFrame = frame;
+		seekSample = samples;
+		seekPending = true;
+		endOfStream = false;
 	}
-	for (auto& a : audioList) {
-		recycleAudio(std::move(a));
+	decoderCond.notify_one();
+	return true;
+}
+
+void OggReader::doSeek(size_t frame, size_t samples)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		// discard partially filled fragment
+		if (!recycleAudioList.empty()) {
+			recycleAudioList.front()->length = 0;
+		}
 	}
-	audioList.clear();
 
 	fileOffset = findOffset(frame, samples);
 	file.seek(fileOffset);
 
 	ogg_sync_reset(&sync);
+	// drop the packets of the old position
+	ogg_stream_reset(&vorbisStream);
+	ogg_stream_reset(&theoraStream);
 
 	vorbisPos = AudioFragment::UNKNOWN_POS;
 	currentFrame = frame;
 	currentSample = samples;
 
 	vorbis_synthesis_restart(&vd);
+}
 
-	return true;
+void OggReader::decoderMain()
+{
+	indexDone = loadIndex();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		if (!indexDone && !quitDecoder && !needDecode()) {
+			// Nothing to decode right now, use the time to extend
+			// the page index.
+			lock.unlock();
+			try {
+				indexDone = extendIndex(INDEX_STEP);
+			} catch (MSXException& e) {
+				warning("Error indexing laserdisc image: " +
+				        e.getMessage());
+				indexDone = true; // seeks still extend it
+			}
+			lock.lock();
+			continue;
+		}
+		decoderCond.wait(lock, [&]() { return quitDecoder || needDecode(); });
+		if (quitDecoder) return;
+
+		bool pending = seekPending;
+		size_t frame = seekFrame;
+		size_t sample = seekSample;
+		seekPending = false;
+		lock.unlock();
+
+		bool more;
+		try {
+			if (pending) {
+				doSeek(frame, sample);
+				more = true;
+			} else {
+				more = nextPacket();
+			}
+		} catch (MSXException& e) {
+			warning("Error reading laserdisc image: " +
+			        e.getMessage());
+			more = false;
+		}
+
+		lock.lock();
+		warnings.insert(end(warnings),
+			make_move_iterator(begin(decoderWarnings)),
+			make_move_iterator(end  (decoderWarnings)));
+		decoderWarnings.clear();
+		if (!pending) ++decodedPackets;
+		if (!more && !seekPending) endOfStream = true;
+		if (waiting) dataCond.notify_one();
+	}
+}
+
+bool OggReader::needDecode() const
+{
+	// Keep this many frames decoded ahead of the last requested frame.
+	static const unsigned PREFETCH_FRAMES = 16;
+
+	if (seekPending) return true;
+	if (endOfStream) return false;
+	if (waiting) return true;
+	unsigned ahead = 0;
+	for (auto& f : frameList) {
+		if ((f->no == size_t(-1)) || (f->no + f->length > requestedFrame)) {
+			++ahead;
+		}
+	}
+	return ahead < PREFETCH_FRAMES;
+}
+
+/** Wait till the decoder thread processed another packet. Returns false when
+ * the end of the streams is reached. Must be called with 'mutex' locked.
+ */
+bool OggReader::waitForData(std::unique_lock<std::mutex>& lock)
+{
+	if (endOfStream) return false;
+	auto packets = decodedPackets;
+	waiting = true;
+	decoderCond.notify_one();
+	dataCond.wait(lock, [&]() {
+		return (decodedPackets != packets) || endOfStream; });
+	waiting = false;
+	return decodedPackets != packets;
+}
+
+/** Used by the decoder thread, the warnings are printed by the emulation
+ * thread (see printWarnings()).
+ */
+void OggReader::warning(std::string message)
+{
+	decoderWarnings.push_back(std::move(message));
+}
+
+void OggReader::printWarnings()
+{
+	std::vector<std::string> tmp;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		swap(tmp, warnings);
+	}
+	for (auto& w : tmp) {
+		cli.printWarning(w);
+	}
 }
 
 bool OggReader::stopFrame(size_t frame) const
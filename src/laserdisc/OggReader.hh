@@ -6,8 +6,14 @@
 #include <ogg/ogg.h>
 #include <vorbis/codec.h>
 #include <theora/theoradec.h>
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
 #include <memory>
+#include <mutex>
 #include <list>
+#include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -36,6 +42,21 @@ struct Frame
 	int length;
 };
 
+/** Reads the audio and video streams from an ogg file.
+  *
+  * Decoding happens in a separate thread. That thread keeps a window of
+  * decoded frames (and the audio that's interleaved with them) ahead of
+  * the last requested frame, getFrameNo() and getAudio() only wait for it
+  * when the requested data isn't decoded yet (e.g. right after a seek).
+  *
+  * The headers of all ogg pages are scanned to build an index of the file
+  * offsets of the video and audio pages. A seek uses this index to directly
+  * start reading just before the keyframe the requested frame depends on.
+  * The index is built by the decoder thread whenever it has nothing to
+  * decode (a seek only waits till the index covers the requested position).
+  * The complete index is stored in a cache file, it's reused when the size
+  * and the modification time of the file still match.
+  */
 class OggReader
 {
 public:
@@ -57,6 +78,17 @@ public:
 	size_t getChapter(int chapterNo) const;
 
 private:
+	/** An entry in the page index: one for each page on which a packet
+	  * ends. 'granule' is the frame number (video) or sample number
+	  * (audio) of the last packet that ends on the page, 'keyFrame' is
+	  * the keyframe that video frame depends on.
+	  */
+	struct PageIndex {
+		size_t offset;
+		size_t granule;
+		size_t keyFrame;
+	};
+
 	void cleanup();
 	void readTheora(ogg_packet* packet);
 	void theoraHeaderPage(ogg_page* page, th_info& ti, th_comment& tc,
@@ -70,19 +102,29 @@ private:
 	void vorbisFoundPosition();
 	size_t frameNo(ogg_packet* packet);
 
+	size_t findLastFrame();
+	bool extendIndex(size_t maxBytes);
+	bool indexCovers(size_t frame, size_t sample) const;
+	bool loadIndex();
+	void storeIndex() const;
 	size_t findOffset(size_t frame, size_t sample);
-	size_t bisection(size_t frame, size_t sample,
-	                 size_t maxOffset, size_t maxSamples, size_t maxFrames);
+	void doSeek(size_t frame, size_t sample);
+
+	void decoderMain();
+	bool needDecode() const;
+	bool waitForData(std::unique_lock<std::mutex>& lock);
+	void warning(std::string message);
+	void printWarnings();
 
 	CliComm& cli;
 	File file;
 
-	enum State {
-		PLAYING,
-		FIND_LAST,
-		FIND_FIRST,
-		FIND_KEYFRAME
-	} state;
+	// Metadata (read-only once the constructor is done)
+	std::vector<size_t> stopFrames;
+	std::vector<std::pair<int, size_t>> chapters;
+
+	// The members below are only used by the decoder thread (and by the
+	// constructor, before that thread is started).
 
 	// ogg state
 	ogg_sync_state sync;
@@ -99,10 +141,7 @@ private:
 	size_t keyFrame;
 	size_t currentFrame;
 	int granuleShift;
-	size_t totalFrames;
-
-	cb_queue<std::unique_ptr<Frame>> frameList;
-	std::vector<std::unique_ptr<Frame>> recycleFrameList;
+	std::atomic<size_t> totalFrames; // also read by the emulation thread
 
 	// audio
 	int audioHeaders;
@@ -113,12 +152,36 @@ private:
 	size_t currentSample;
 	size_t vorbisPos;
 
+	// index
+	std::vector<PageIndex> videoIndex;
+	std::vector<PageIndex> audioIndex;
+	size_t indexedSize; // the index covers the file up to this offset
+	bool indexDone;     // indexedSize can't grow (till the file grows)
+	std::string indexCacheFile;
+	time_t fileTime;
+
+	std::vector<std::string> decoderWarnings;
+
+	// The members below are shared between the decoder thread and the
+	// emulation thread, they are protected by 'mutex'.
+	cb_queue<std::unique_ptr<Frame>> frameList;
+	std::vector<std::unique_ptr<Frame>> recycleFrameList;
 	std::list<std::unique_ptr<AudioFragment>> audioList;
 	cb_queue<std::unique_ptr<AudioFragment>> recycleAudioList;
-
-	// Metadata
-	std::vector<size_t> stopFrames;
-	std::vector<std::pair<int, size_t>> chapters;
+	std::vector<std::string> warnings;
+	size_t requestedFrame; // last frame requested via getFrameNo()
+	size_t seekFrame;      // parameters of a pending seek
+	size_t seekSample;
+	unsigned decodedPackets;
+	bool seekPending;
+	bool endOfStream;
+	bool waiting;          // the emulation thread waits for more data
+	bool quitDecoder;
+
+	std::mutex mutex;
+	std::condition_variable decoderCond; // wakes up the decoder thread
+	std::condition_variable dataCond;    // signals new decoded data
+	std::thread decoder;
 };
 
 } // namespace openmsx
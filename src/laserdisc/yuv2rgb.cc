@@ -7,6 +7,9 @@
 #ifdef __SSE2__
 #include <emmintrin.h>
 #endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 namespace openmsx {
 namespace yuv2rgb {
@@ -38,193 +41,309 @@ namespace yuv2rgb {
  * G = 1.164 * Y - 0.813 * V - 0.391 * U + 135.576
  * B = 1.164 * Y             + 2.018 * U - 276.836
  */
+// Contribution of 8 U and V values (in 16-bit lanes) to the R, G and B
+// components.
+static inline void uv2rgb_sse2(__m128i u, __m128i v,
+                               __m128i& dr, __m128i& dg, __m128i& db)
+{
+	const __m128i RED_V   = _mm_set1_epi16(   102); // 102/64 =  1.59
+	const __m128i GREEN_U = _mm_set1_epi16(   -25); // -25/64 = -0.39
+	const __m128i GREEN_V = _mm_set1_epi16(   -52); // -52/64 = -0.81
+	const __m128i BLUE_U  = _mm_set1_epi16(   129); // 129/64 =  2.02
+	const __m128i CNST_R  = _mm_set1_epi16(  -223); // -222.921
+	const __m128i CNST_G  = _mm_set1_epi16(   136); //  135.576
+	const __m128i CNST_B  = _mm_set1_epi16(  -277); // -276.836
+
+	__m128i mr = _mm_srai_epi16(_mm_mullo_epi16(v, RED_V), 6);
+	__m128i sg = _mm_mullo_epi16(v, GREEN_V);
+	__m128i tg = _mm_mullo_epi16(u, GREEN_U);
+	__m128i mg = _mm_srai_epi16(_mm_adds_epi16(sg, tg), 6);
+	__m128i mb = _mm_srli_epi16(_mm_mullo_epi16(u, BLUE_U), 6); // logical shift
+	dr = _mm_adds_epi16(mr, CNST_R);
+	dg = _mm_adds_epi16(mg, CNST_G);
+	db = _mm_adds_epi16(mb, CNST_B);
+}
+
+// Combine 16 Y values with the U,V contribution (each U,V value is shared by
+// two horizontally adjacent pixels). Results in 16 R, G and B bytes.
+static inline void y2rgb_sse2(__m128i y, __m128i dr, __m128i dg, __m128i db,
+                              __m128i& r, __m128i& g, __m128i& b)
+{
+	const __m128i COEF_Y  = _mm_set1_epi16(    74); //  74/64 =  1.16
+	const __m128i Y_MASK  = _mm_set1_epi16(0x00FF);
+
+	__m128i y_even  = _mm_and_si128(y, Y_MASK);
+	__m128i y_odd   = _mm_srli_epi16(y, 8);
+	__m128i dy_even = _mm_srai_epi16(_mm_mullo_epi16(y_even, COEF_Y), 6);
+	__m128i dy_odd  = _mm_srai_epi16(_mm_mullo_epi16(y_odd,  COEF_Y), 6);
+	__m128i r_even  = _mm_adds_epi16(dr, dy_even);
+	__m128i g_even  = _mm_adds_epi16(dg, dy_even);
+	__m128i b_even  = _mm_adds_epi16(db, dy_even);
+	__m128i r_odd   = _mm_adds_epi16(dr, dy_odd);
+	__m128i g_odd   = _mm_adds_epi16(dg, dy_odd);
+	__m128i b_odd   = _mm_adds_epi16(db, dy_odd);
+	r = _mm_unpackhi_epi8(_mm_packus_epi16(r_even, r_even),
+	                      _mm_packus_epi16(r_odd,  r_odd));
+	g = _mm_unpackhi_epi8(_mm_packus_epi16(g_even, g_even),
+	                      _mm_packus_epi16(g_odd,  g_odd));
+	b = _mm_unpackhi_epi8(_mm_packus_epi16(b_even, b_even),
+	                      _mm_packus_epi16(b_odd,  b_odd));
+}
+
+// Store 16 pixels as BGRA.
+static inline void store_sse2(uint32_t* out_, __m128i r, __m128i g, __m128i b,
+                              const SDL_PixelFormat& /*format*/)
+{
+	auto* out = reinterpret_cast<__m128i*>(out_);
+	const __m128i ALPHA = _mm_set1_epi16(-1); // 0xFFFF
+
+	__m128i br07   = _mm_unpacklo_epi8(b, r);
+	__m128i br8f   = _mm_unpackhi_epi8(b, r);
+	__m128i ga07   = _mm_unpacklo_epi8(g, ALPHA);
+	__m128i ga8f   = _mm_unpackhi_epi8(g, ALPHA);
+	__m128i bgra03 = _mm_unpacklo_epi8(br07, ga07);
+	__m128i bgra47 = _mm_unpackhi_epi8(br07, ga07);
+	__m128i bgra8b = _mm_unpacklo_epi8(br8f, ga8f);
+	__m128i bgracf = _mm_unpackhi_epi8(br8f, ga8f);
+	_mm_store_si128(out + 0, bgra03);
+	_mm_store_si128(out + 1, bgra47);
+	_mm_store_si128(out + 2, bgra8b);
+	_mm_store_si128(out + 3, bgracf);
+}
+
+// Combine 8 R, G and B values (in 16-bit lanes) into 16bpp pixels, this gives
+// the same result as SDL_MapRGB().
+static inline __m128i pack16_sse2(__m128i r, __m128i g, __m128i b,
+                                  const SDL_PixelFormat& format)
+{
+	__m128i pr = _mm_sll_epi16(_mm_srl_epi16(r, _mm_cvtsi32_si128(format.Rloss)),
+	                           _mm_cvtsi32_si128(format.Rshift));
+	__m128i pg = _mm_sll_epi16(_mm_srl_epi16(g, _mm_cvtsi32_si128(format.Gloss)),
+	                           _mm_cvtsi32_si128(format.Gshift));
+	__m128i pb = _mm_sll_epi16(_mm_srl_epi16(b, _mm_cvtsi32_si128(format.Bloss)),
+	                           _mm_cvtsi32_si128(format.Bshift));
+	__m128i pa = _mm_set1_epi16(int16_t(format.Amask));
+	return _mm_or_si128(_mm_or_si128(pr, pg), _mm_or_si128(pb, pa));
+}
+
+// Store 16 pixels in the given 16bpp format.
+static inline void store_sse2(uint16_t* out_, __m128i r, __m128i g, __m128i b,
+                              const SDL_PixelFormat& format)
+{
+	auto* out = reinterpret_cast<__m128i*>(out_);
+	const __m128i ZERO = _mm_setzero_si128();
+
+	_mm_store_si128(out + 0, pack16_sse2(_mm_unpacklo_epi8(r, ZERO),
+	                                     _mm_unpacklo_epi8(g, ZERO),
+	                                     _mm_unpacklo_epi8(b, ZERO), format));
+	_mm_store_si128(out + 1, pack16_sse2(_mm_unpackhi_epi8(r, ZERO),
+	                                     _mm_unpackhi_epi8(g, ZERO),
+	                                     _mm_unpackhi_epi8(b, ZERO), format));
+}
+
+template<typename Pixel>
 static inline void yuv2rgb_sse2(
 	const uint8_t* u_ , const uint8_t* v_,
 	const uint8_t* y0_, const uint8_t* y1_,
-	uint32_t* out0_, uint32_t* out1_)
+	Pixel* out0, Pixel* out1, const SDL_PixelFormat& format)
 {
-	// This routine calculates 32x2 RGBA pixels. Each output pixel uses a
+	// This routine calculates 32x2 pixels. Each output pixel uses a
 	// unique corresponding input Y value, but a group of 2x2 ouput pixels
 	// shares the same U and V input value.
 	auto* u    = reinterpret_cast<const __m128i*>(u_);
 	auto* v    = reinterpret_cast<const __m128i*>(v_);
 	auto* y0   = reinterpret_cast<const __m128i*>(y0_);
 	auto* y1   = reinterpret_cast<const __m128i*>(y1_);
-	auto* out0 = reinterpret_cast<      __m128i*>(out0_);
-	auto* out1 = reinterpret_cast<      __m128i*>(out1_);
 
-	// constants
-	const __m128i ZERO    = _mm_setzero_si128();
-	const __m128i ALPHA   = _mm_set1_epi16(    -1); // 0xFFFF
-	const __m128i RED_V   = _mm_set1_epi16(   102); // 102/64 =  1.59
-	const __m128i GREEN_U = _mm_set1_epi16(   -25); // -25/64 = -0.39
-	const __m128i GREEN_V = _mm_set1_epi16(   -52); // -52/64 = -0.81
-	const __m128i BLUE_U  = _mm_set1_epi16(   129); // 129/64 =  2.02
-	const __m128i COEF_Y  = _mm_set1_epi16(    74); //  74/64 =  1.16
-	const __m128i CNST_R  = _mm_set1_epi16(  -223); // -222.921
-	const __m128i CNST_G  = _mm_set1_epi16(   136); //  135.576
-	const __m128i CNST_B  = _mm_set1_epi16(  -277); // -276.836
-	const __m128i Y_MASK  = _mm_set1_epi16(0x00FF);
+	const __m128i ZERO = _mm_setzero_si128();
+	__m128i u0f = _mm_load_si128(u);
+	__m128i v0f = _mm_load_si128(v);
+	__m128i dr, dg, db, r, g, b;
 
 	// left
-	__m128i u0f  = _mm_load_si128(u);
-	__m128i v0f  = _mm_load_si128(v);
-	__m128i u07  = _mm_unpacklo_epi8(u0f, ZERO);
-	__m128i v07  = _mm_unpacklo_epi8(v0f, ZERO);
-	__m128i mr07 = _mm_srai_epi16(_mm_mullo_epi16(v07, RED_V), 6);
-	__m128i sg07 = _mm_mullo_epi16(v07, GREEN_V);
-	__m128i tg07 = _mm_mullo_epi16(u07, GREEN_U);
-	__m128i mg07 = _mm_srai_epi16(_mm_adds_epi16(sg07, tg07), 6);
-	__m128i mb07 = _mm_srli_epi16(_mm_mullo_epi16(u07, BLUE_U), 6); // logical shift
-	__m128i dr07 = _mm_adds_epi16(mr07, CNST_R);
-	__m128i dg07 = _mm_adds_epi16(mg07, CNST_G);
-	__m128i db07 = _mm_adds_epi16(mb07, CNST_B);
-
+	uv2rgb_sse2(_mm_unpacklo_epi8(u0f, ZERO), _mm_unpacklo_epi8(v0f, ZERO),
+	            dr, dg, db);
 	// block top,left
-	__m128i y00_0f    = _mm_load_si128(y0 + 0);
-	__m128i y00_even  = _mm_and_si128(y00_0f, Y_MASK);
-	__m128i y00_odd   = _mm_srli_epi16(y00_0f, 8);
-	__m128i dy00_even = _mm_srai_epi16(_mm_mullo_epi16(y00_even, COEF_Y), 6);
-	__m128i dy00_odd  = _mm_srai_epi16(_mm_mullo_epi16(y00_odd,  COEF_Y), 6);
-	__m128i r00_even  = _mm_adds_epi16(dr07, dy00_even);
-	__m128i g00_even  = _mm_adds_epi16(dg07, dy00_even);
-	__m128i b00_even  = _mm_adds_epi16(db07, dy00_even);
-	__m128i r00_odd   = _mm_adds_epi16(dr07, dy00_odd);
-	__m128i g00_odd   = _mm_adds_epi16(dg07, dy00_odd);
-	__m128i b00_odd   = _mm_adds_epi16(db07, dy00_odd);
-	__m128i r00_0f    = _mm_unpackhi_epi8(_mm_packus_epi16(r00_even, r00_even),
-	                                      _mm_packus_epi16(r00_odd,  r00_odd));
-	__m128i g00_0f    = _mm_unpackhi_epi8(_mm_packus_epi16(g00_even, g00_even),
-	                                      _mm_packus_epi16(g00_odd,  g00_odd));
-	__m128i b00_0f    = _mm_unpackhi_epi8(_mm_packus_epi16(b00_even, b00_even),
-	                                      _mm_packus_epi16(b00_odd,  b00_odd));
-	__m128i br00_07   = _mm_unpacklo_epi8(b00_0f, r00_0f);
-	__m128i br00_8f   = _mm_unpackhi_epi8(b00_0f, r00_0f);
-	__m128i ga00_07   = _mm_unpacklo_epi8(g00_0f, ALPHA);
-	__m128i ga00_8f   = _mm_unpackhi_epi8(g00_0f, ALPHA);
-	__m128i bgra00_03 = _mm_unpacklo_epi8(br00_07, ga00_07);
-	__m128i bgra00_47 = _mm_unpackhi_epi8(br00_07, ga00_07);
-	__m128i bgra00_8b = _mm_unpacklo_epi8(br00_8f, ga00_8f);
-	__m128i bgra00_cf = _mm_unpackhi_epi8(br00_8f, ga00_8f);
-	_mm_store_si128(out0 + 0, bgra00_03);
-	_mm_store_si128(out0 + 1, bgra00_47);
-	_mm_store_si128(out0 + 2, bgra00_8b);
-	_mm_store_si128(out0 + 3, bgra00_cf);
-
+	y2rgb_sse2(_mm_load_si128(y0 + 0), dr, dg, db, r, g, b);
+	store_sse2(out0 + 0, r, g, b, format);
 	// block bottom,left
-	__m128i y10_0f    = _mm_load_si128(y1 + 0);
-	__m128i y10_even  = _mm_and_si128(y10_0f, Y_MASK);
-	__m128i y10_odd   = _mm_srli_epi16(y10_0f, 8);
-	__m128i dy10_even = _mm_srai_epi16(_mm_mullo_epi16(y10_even, COEF_Y), 6);
-	__m128i dy10_odd  = _mm_srai_epi16(_mm_mullo_epi16(y10_odd,  COEF_Y), 6);
-	__m128i r10_even  = _mm_adds_epi16(dr07, dy10_even);
-	__m128i g10_even  = _mm_adds_epi16(dg07, dy10_even);
-	__m128i b10_even  = _mm_adds_epi16(db07, dy10_even);
-	__m128i r10_odd   = _mm_adds_epi16(dr07, dy10_odd);
-	__m128i g10_odd   = _mm_adds_epi16(dg07, dy10_odd);
-	__m128i b10_odd   = _mm_adds_epi16(db07, dy10_odd);
-	__m128i r10_0f    = _mm_unpackhi_epi8(_mm_packus_epi16(r10_even, r10_even),
-	                                      _mm_packus_epi16(r10_odd,  r10_odd));
-	__m128i g10_0f    = _mm_unpackhi_epi8(_mm_packus_epi16(g10_even, g10_even),
-	                                      _mm_packus_epi16(g10_odd,  g10_odd));
-	__m128i b10_0f    = _mm_unpackhi_epi8(_mm_packus_epi16(b10_even, b10_even),
-	                                      _mm_packus_epi16(b10_odd,  b10_odd));
-	__m128i br10_07   = _mm_unpacklo_epi8(b10_0f, r10_0f);
-	__m128i br10_8f   = _mm_unpackhi_epi8(b10_0f, r10_0f);
-	__m128i ga10_07   = _mm_unpacklo_epi8(g10_0f, ALPHA);
-	__m128i ga10_8f   = _mm_unpackhi_epi8(g10_0f, ALPHA);
-	__m128i bgra10_03 = _mm_unpacklo_epi8(br10_07, ga10_07);
-	__m128i bgra10_47 = _mm_unpackhi_epi8(br10_07, ga10_07);
-	__m128i bgra10_8b = _mm_unpacklo_epi8(br10_8f, ga10_8f);
-	__m128i bgra10_cf = _mm_unpackhi_epi8(br10_8f, ga10_8f);
-	_mm_store_si128(out1 + 0, bgra10_03);
-	_mm_store_si128(out1 + 1, bgra10_47);
-	_mm_store_si128(out1 + 2, bgra10_8b);
-	_mm_store_si128(out1 + 3, bgra10_cf);
+	y2rgb_sse2(_mm_load_si128(y1 + 0), dr, dg, db, r, g, b);
+	store_sse2(out1 + 0, r, g, b, format);
 
 	// right
-	__m128i u8f  = _mm_unpackhi_epi8(u0f, ZERO);
-	__m128i v8f  = _mm_unpackhi_epi8(v0f, ZERO);
-	__m128i mr8f = _mm_srai_epi16(_mm_mullo_epi16(v8f, RED_V), 6);
-	__m128i sg8f = _mm_mullo_epi16(v8f, GREEN_V);
-	__m128i tg8f = _mm_mullo_epi16(u8f, GREEN_U);
-	__m128i mg8f = _mm_srai_epi16(_mm_adds_epi16(sg8f, tg8f), 6);
-	__m128i mb8f = _mm_srli_epi16(_mm_mullo_epi16(u8f, BLUE_U), 6); // logical shift
-	__m128i dr8f = _mm_adds_epi16(mr8f, CNST_R);
-	__m128i dg8f = _mm_adds_epi16(mg8f, CNST_G);
-	__m128i db8f = _mm_adds_epi16(mb8f, CNST_B);
-
+	uv2rgb_sse2(_mm_unpackhi_epi8(u0f, ZERO), _mm_unpackhi_epi8(v0f, ZERO),
+	            dr, dg, db);
 	// block top,right
-	__m128i y01_0f    = _mm_load_si128(y0 + 1);
-	__m128i y01_even  = _mm_and_si128(y01_0f, Y_MASK);
-	__m128i y01_odd   = _mm_srli_epi16(y01_0f, 8);
-	__m128i dy01_even = _mm_srai_epi16(_mm_mullo_epi16(y01_even, COEF_Y), 6);
-	__m128i dy01_odd  = _mm_srai_epi16(_mm_mullo_epi16(y01_odd,  COEF_Y), 6);
-	__m128i r01_even  = _mm_adds_epi16(dr8f, dy01_even);
-	__m128i g01_even  = _mm_adds_epi16(dg8f, dy01_even);
-	__m128i b01_even  = _mm_adds_epi16(db8f, dy01_even);
-	__m128i r01_odd   = _mm_adds_epi16(dr8f, dy01_odd);
-	__m128i g01_odd   = _mm_adds_epi16(dg8f, dy01_odd);
-	__m128i b01_odd   = _mm_adds_epi16(db8f, dy01_odd);
-	__m128i r01_0f    = _mm_unpackhi_epi8(_mm_packus_epi16(r01_even, r01_even),
-	                                      _mm_packus_epi16(r01_odd,  r01_odd));
-	__m128i g01_0f    = _mm_unpackhi_epi8(_mm_packus_epi16(g01_even, g01_even),
-	                                      _mm_packus_epi16(g01_odd,  g01_odd));
-	__m128i b01_0f    = _mm_unpackhi_epi8(_mm_packus_epi16(b01_even, b01_even),
-	                                      _mm_packus_epi16(b01_odd,  b01_odd));
-	__m128i br01_07   = _mm_unpacklo_epi8(b01_0f, r01_0f);
-	__m128i br01_8f   = _mm_unpackhi_epi8(b01_0f, r01_0f);
-	__m128i ga01_07   = _mm_unpacklo_epi8(g01_0f, ALPHA);
-	__m128i ga01_8f   = _mm_unpackhi_epi8(g01_0f, ALPHA);
-	__m128i bgra01_03 = _mm_unpacklo_epi8(br01_07, ga01_07);
-	__m128i bgra01_47 = _mm_unpackhi_epi8(br01_07, ga01_07);
-	__m128i bgra01_8b = _mm_unpacklo_epi8(br01_8f, ga01_8f);
-	__m128i bgra01_cf = _mm_unpackhi_epi8(br01_8f, ga01_8f);
-	_mm_store_si128(out0 + 4, bgra01_03);
-	_mm_store_si128(out0 + 5, bgra01_47);
-	_mm_store_si128(out0 + 6, bgra01_8b);
-	_mm_store_si128(out0 + 7, bgra01_cf);
-
+	y2rgb_sse2(_mm_load_si128(y0 + 1), dr, dg, db, r, g, b);
+	store_sse2(out0 + 16, r, g, b, format);
 	// block bottom,right
-	__m128i y11_0f    = _mm_load_si128(y1 + 1);
-	__m128i y11_even  = _mm_and_si128(y11_0f, Y_MASK);
-	__m128i y11_odd   = _mm_srli_epi16(y11_0f, 8);
-	__m128i dy11_even = _mm_srai_epi16(_mm_mullo_epi16(y11_even, COEF_Y), 6);
-	__m128i dy11_odd  = _mm_srai_epi16(_mm_mullo_epi16(y11_odd,  COEF_Y), 6);
-	__m128i r11_even  = _mm_adds_epi16(dr8f, dy11_even);
-	__m128i g11_even  = _mm_adds_epi16(dg8f, dy11_even);
-	__m128i b11_even  = _mm_adds_epi16(db8f, dy11_even);
-	__m128i r11_odd   = _mm_adds_epi16(dr8f, dy11_odd);
-	__m128i g11_odd   = _mm_adds_epi16(dg8f, dy11_odd);
-	__m128i b11_odd   = _mm_adds_epi16(db8f, dy11_odd);
-	__m128i r11_0f    = _mm_unpackhi_epi8(_mm_packus_epi16(r11_even, r11_even),
-	                                      _mm_packus_epi16(r11_odd,  r11_odd));
-	__m128i g11_0f    = _mm_unpackhi_epi8(_mm_packus_epi16(g11_even, g11_even),
-	                                      _mm_packus_epi16(g11_odd,  g11_odd));
-	__m128i b11_0f    = _mm_unpackhi_epi8(_mm_packus_epi16(b11_even, b11_even),
-	                                      _mm_packus_epi16(b11_odd,  b11_odd));
-	__m128i br11_07   = _mm_unpacklo_epi8(b11_0f, r11_0f);
-	__m128i br11_8f   = _mm_unpackhi_epi8(b11_0f, r11_0f);
-	__m128i ga11_07   = _mm_unpacklo_epi8(g11_0f, ALPHA);
-	__m128i ga11_8f   = _mm_unpackhi_epi8(g11_0f, ALPHA);
-	__m128i bgra11_03 = _mm_unpacklo_epi8(br11_07, ga11_07);
-	__m128i bgra11_47 = _mm_unpackhi_epi8(br11_07, ga11_07);
-	__m128i bgra11_8b = _mm_unpacklo_epi8(br11_8f, ga11_8f);
-	__m128i bgra11_cf = _mm_unpackhi_epi8(br11_8f, ga11_8f);
-	_mm_store_si128(out1 + 4, bgra11_03);
-	_mm_store_si128(out1 + 5, bgra11_47);
-	_mm_store_si128(out1 + 6, bgra11_8b);
-	_mm_store_si128(out1 + 7, bgra11_cf);
+	y2rgb_sse2(_mm_load_si128(y1 + 1), dr, dg, db, r, g, b);
+	store_sse2(out1 + 16, r, g, b, format);
 }
 
-static inline void convertHelperSSE2(
-	const th_ycbcr_buffer& buffer, RawFrame& output)
+#endif // __SSE2__
+
+#ifdef __AVX2__
+
+// The AVX2 routines below are the same as the SSE2 versions, but process
+// twice as many pixels at once. Note that most AVX2 instructions operate
+// on the two 128-bit halves independently, so some extra shuffling is
+// needed to keep the pixels in the right order.
+
+static inline void uv2rgb_avx2(__m256i u, __m256i v,
+                               __m256i& dr, __m256i& dg, __m256i& db)
+{
+	const __m256i RED_V   = _mm256_set1_epi16( 102);
+	const __m256i GREEN_U = _mm256_set1_epi16( -25);
+	const __m256i GREEN_V = _mm256_set1_epi16( -52);
+	const __m256i BLUE_U  = _mm256_set1_epi16( 129);
+	const __m256i CNST_R  = _mm256_set1_epi16(-223);
+	const __m256i CNST_G  = _mm256_set1_epi16( 136);
+	const __m256i CNST_B  = _mm256_set1_epi16(-277);
+
+	__m256i mr = _mm256_srai_epi16(_mm256_mullo_epi16(v, RED_V), 6);
+	__m256i sg = _mm256_mullo_epi16(v, GREEN_V);
+	__m256i tg = _mm256_mullo_epi16(u, GREEN_U);
+	__m256i mg = _mm256_srai_epi16(_mm256_adds_epi16(sg, tg), 6);
+	__m256i mb = _mm256_srli_epi16(_mm256_mullo_epi16(u, BLUE_U), 6); // logical shift
+	dr = _mm256_adds_epi16(mr, CNST_R);
+	dg = _mm256_adds_epi16(mg, CNST_G);
+	db = _mm256_adds_epi16(mb, CNST_B);
+}
+
+static inline void y2rgb_avx2(__m256i y, __m256i dr, __m256i dg, __m256i db,
+                              __m256i& r, __m256i& g, __m256i& b)
+{
+	const __m256i COEF_Y = _mm256_set1_epi16(74);
+	const __m256i Y_MASK = _mm256_set1_epi16(0x00FF);
+
+	__m256i y_even  = _mm256_and_si256(y, Y_MASK);
+	__m256i y_odd   = _mm256_srli_epi16(y, 8);
+	__m256i dy_even = _mm256_srai_epi16(_mm256_mullo_epi16(y_even, COEF_Y), 6);
+	__m256i dy_odd  = _mm256_srai_epi16(_mm256_mullo_epi16(y_odd,  COEF_Y), 6);
+	__m256i r_even  = _mm256_adds_epi16(dr, dy_even);
+	__m256i g_even  = _mm256_adds_epi16(dg, dy_even);
+	__m256i b_even  = _mm256_adds_epi16(db, dy_even);
+	__m256i r_odd   = _mm256_adds_epi16(dr, dy_odd);
+	__m256i g_odd   = _mm256_adds_epi16(dg, dy_odd);
+	__m256i b_odd   = _mm256_adds_epi16(db, dy_odd);
+	r = _mm256_unpackhi_epi8(_mm256_packus_epi16(r_even, r_even),
+	                         _mm256_packus_epi16(r_odd,  r_odd));
+	g = _mm256_unpackhi_epi8(_mm256_packus_epi16(g_even, g_even),
+	                         _mm256_packus_epi16(g_odd,  g_odd));
+	b = _mm256_unpackhi_epi8(_mm256_packus_epi16(b_even, b_even),
+	                         _mm256_packus_epi16(b_odd,  b_odd));
+}
+
+// Store 32 pixels as BGRA. The low half of r, g and b contains pixels 0-15,
+// the high half pixels 16-31.
+static inline void store_avx2(uint32_t* out_, __m256i r, __m256i g, __m256i b,
+                              const SDL_PixelFormat& /*format*/)
+{
+	auto* out = reinterpret_cast<__m256i*>(out_);
+	const __m256i ALPHA = _mm256_set1_epi16(-1);
+
+	__m256i br_lo = _mm256_unpacklo_epi8(b, r);     // 0-7   | 16-23
+	__m256i br_hi = _mm256_unpackhi_epi8(b, r);     // 8-15  | 24-31
+	__m256i ga_lo = _mm256_unpacklo_epi8(g, ALPHA);
+	__m256i ga_hi = _mm256_unpackhi_epi8(g, ALPHA);
+	__m256i p0 = _mm256_unpacklo_epi8(br_lo, ga_lo); // 0-3   | 16-19
+	__m256i p1 = _mm256_unpackhi_epi8(br_lo, ga_lo); // 4-7   | 20-23
+	__m256i p2 = _mm256_unpacklo_epi8(br_hi, ga_hi); // 8-11  | 24-27
+	__m256i p3 = _mm256_unpackhi_epi8(br_hi, ga_hi); // 12-15 | 28-31
+	_mm256_store_si256(out + 0, _mm256_permute2x128_si256(p0, p1, 0x20));
+	_mm256_store_si256(out + 1, _mm256_permute2x128_si256(p2, p3, 0x20));
+	_mm256_store_si256(out + 2, _mm256_permute2x128_si256(p0, p1, 0x31));
+	_mm256_store_si256(out + 3, _mm256_permute2x128_si256(p2, p3, 0x31));
+}
+
+static inline __m256i pack16_avx2(__m256i r, __m256i g, __m256i b,
+                                  const SDL_PixelFormat& format)
+{
+	__m256i pr = _mm256_sll_epi16(_mm256_srl_epi16(r, _mm_cvtsi32_si128(format.Rloss)),
+	                              _mm_cvtsi32_si128(format.Rshift));
+	__m256i pg = _mm256_sll_epi16(_mm256_srl_epi16(g, _mm_cvtsi32_si128(format.Gloss)),
+	                              _mm_cvtsi32_si128(format.Gshift));
+	__m256i pb = _mm256_sll_epi16(_mm256_srl_epi16(b, _mm_cvtsi32_si128(format.Bloss)),
+	                              _mm_cvtsi32_si128(format.Bshift));
+	__m256i pa = _mm256_set1_epi16(int16_t(format.Amask));
+	return _mm256_or_si256(_mm256_or_si256(pr, pg), _mm256_or_si256(pb, pa));
+}
+
+static inline void store_avx2(uint16_t* out_, __m256i r, __m256i g, __m256i b,
+                              const SDL_PixelFormat& format)
+{
+	auto* out = reinterpret_cast<__m256i*>(out_);
+	const __m256i ZERO = _mm256_setzero_si256();
+
+	__m256i p_lo = pack16_avx2(_mm256_unpacklo_epi8(r, ZERO), // 0-7  | 16-23
+	                           _mm256_unpacklo_epi8(g, ZERO),
+	                           _mm256_unpacklo_epi8(b, ZERO), format);
+	__m256i p_hi = pack16_avx2(_mm256_unpackhi_epi8(r, ZERO), // 8-15 | 24-31
+	                           _mm256_unpackhi_epi8(g, ZERO),
+	                           _mm256_unpackhi_epi8(b, ZERO), format);
+	_mm256_store_si256(out + 0, _mm256_permute2x128_si256(p_lo, p_hi, 0x20));
+	_mm256_store_si256(out + 1, _mm256_permute2x128_si256(p_lo, p_hi, 0x31));
+}
+
+template<typename Pixel>
+static inline void yuv2rgb_avx2(
+	const uint8_t* u_ , const uint8_t* v_,
+	const uint8_t* y0_, const uint8_t* y1_,
+	Pixel* out0, Pixel* out1, const SDL_PixelFormat& format)
+{
+	// This routine calculates 64x2 pixels.
+	auto* u    = reinterpret_cast<const __m256i*>(u_);
+	auto* v    = reinterpret_cast<const __m256i*>(v_);
+	auto* y0   = reinterpret_cast<const __m256i*>(y0_);
+	auto* y1   = reinterpret_cast<const __m256i*>(y1_);
+
+	// Reorder the U,V values (in 64-bit units: 0,2,1,3) so that the
+	// unpack instructions below produce the U,V values for pixels
+	// 0-15 | 16-31 (lo) and 32-47 | 48-63 (hi).
+	const __m256i ZERO = _mm256_setzero_si256();
+	__m256i u_all = _mm256_permute4x64_epi64(_mm256_loadu_si256(u), 0xD8);
+	__m256i v_all = _mm256_permute4x64_epi64(_mm256_loadu_si256(v), 0xD8);
+	__m256i dr, dg, db, r, g, b;
+
+	// left
+	uv2rgb_avx2(_mm256_unpacklo_epi8(u_all, ZERO),
+	            _mm256_unpacklo_epi8(v_all, ZERO), dr, dg, db);
+	y2rgb_avx2(_mm256_loadu_si256(y0 + 0), dr, dg, db, r, g, b);
+	store_avx2(out0 + 0, r, g, b, format);
+	y2rgb_avx2(_mm256_loadu_si256(y1 + 0), dr, dg, db, r, g, b);
+	store_avx2(out1 + 0, r, g, b, format);
+
+	// right
+	uv2rgb_avx2(_mm256_unpackhi_epi8(u_all, ZERO),
+	            _mm256_unpackhi_epi8(v_all, ZERO), dr, dg, db);
+	y2rgb_avx2(_mm256_loadu_si256(y0 + 1), dr, dg, db, r, g, b);
+	store_avx2(out0 + 32, r, g, b, format);
+	y2rgb_avx2(_mm256_loadu_si256(y1 + 1), dr, dg, db, r, g, b);
+	store_avx2(out1 + 32, r, g, b, format);
+}
+
+#endif // __AVX2__
+
+#if defined(__AVX2__)
+static const int SIMD_BLOCK = 64;
+#define yuv2rgb_simd yuv2rgb_avx2
+#elif defined(__SSE2__)
+static const int SIMD_BLOCK = 32;
+#define yuv2rgb_simd yuv2rgb_sse2
+#endif
+
+#ifdef yuv2rgb_simd
+
+template<typename Pixel>
+static void convertHelperSIMD(const th_ycbcr_buffer& buffer, RawFrame& output,
+                              const SDL_PixelFormat& format)
 {
 	const int width      = buffer[0].width;
 	const int y_stride   = buffer[0].stride;
 	const int uv_stride2 = buffer[1].stride / 2;
 
-	assert((width % 32) == 0);
+	assert((width % SIMD_BLOCK) == 0);
 	assert((buffer[0].height % 2) == 0);
 
 	for (int y = 0; y < buffer[0].height; y += 2) {
@@ -232,18 +351,18 @@ static inline void convertHelperSSE2(
 		const uint8_t* pY2 = buffer[0].data + (y + 1) * y_stride;
 		const uint8_t* pCb = buffer[1].data + y * uv_stride2;
 		const uint8_t* pCr = buffer[2].data + y * uv_stride2;
-		uint32_t* out0 = output.getLinePtrDirect<uint32_t>(y + 0);
-		uint32_t* out1 = output.getLinePtrDirect<uint32_t>(y + 1);
-
-		for (int x = 0; x < width; x += 32) {
-			// convert a block of (32 x 2) pixels
-			yuv2rgb_sse2(pCb, pCr, pY1, pY2, out0, out1);
-			pCb += 16;
-			pCr += 16;
-			pY1 += 32;
-			pY2 += 32;
-			out0 += 32;
-			out1 += 32;
+		Pixel* out0 = output.getLinePtrDirect<Pixel>(y + 0);
+		Pixel* out1 = output.getLinePtrDirect<Pixel>(y + 1);
+
+		for (int x = 0; x < width; x += SIMD_BLOCK) {
+			// convert a block of (SIMD_BLOCK x 2) pixels
+			yuv2rgb_simd(pCb, pCr, pY1, pY2, out0, out1, format);
+			pCb += SIMD_BLOCK / 2;
+			pCr += SIMD_BLOCK / 2;
+			pY1 += SIMD_BLOCK;
+			pY2 += SIMD_BLOCK;
+			out0 += SIMD_BLOCK;
+			out1 += SIMD_BLOCK;
 		}
 
 		output.setLineWidth(y + 0, width);
@@ -251,7 +370,7 @@ static inline void convertHelperSSE2(
 	}
 }
 
-#endif // __SSE2__
+#else // yuv2rgb_simd
 
 static int coefs_gu[256];
 static int coefs_gv[256];
@@ -292,7 +411,11 @@ static inline Pixel calc(const SDL_PixelFormat& format,
 	if (sizeof(Pixel) == 4) {
 		return (r << 16) | (g << 8) | (b << 0);
 	} else {
-		return static_cast<Pixel>(SDL_MapRGB(&format, r, g, b));
+		// same as SDL_MapRGB(), but inlined
+		return static_cast<Pixel>(((r >> format.Rloss) << format.Rshift) |
+		                          ((g >> format.Gloss) << format.Gshift) |
+		                          ((b >> format.Bloss) << format.Bshift) |
+		                          format.Amask);
 	}
 }
 
@@ -338,21 +461,28 @@ static void convertHelper(const th_ycbcr_buffer& buffer, RawFrame& output,
 	}
 }
 
+#endif // yuv2rgb_simd
+
 void convert(const th_ycbcr_buffer& input, RawFrame& output)
 {
-	initTables();
-
 	const SDL_PixelFormat& format = output.getSDLPixelFormat();
+#ifdef yuv2rgb_simd
 	if (format.BytesPerPixel == 4) {
-#ifdef __SSE2__
-		convertHelperSSE2(input, output);
+		convertHelperSIMD<uint32_t>(input, output, format);
+	} else {
+		assert(format.BytesPerPixel == 2);
+		convertHelperSIMD<uint16_t>(input, output, format);
+	}
 #else
+	initTables();
+
+	if (format.BytesPerPixel == 4) {
 		convertHelper<uint32_t>(input, output, format);
-#endif
 	} else {
 		assert(format.BytesPerPixel == 2);
 		convertHelper<uint16_t>(input, output, format);
 	}
+#endif
 }
 
 } // namespace yuv2rgb
@@ -0,0 +1,205 @@
+#include "yuv2rgb.hh"
+#include "RawFrame.hh"
+#include "Math.hh"
+#include "MemBuffer.hh"
+#include <SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+using namespace openmsx;
+
+// Checks the output of yuv2rgb::convert() and measures its speed.
+//
+// The SIMD kernels (SSE2, AVX2) all use the same 16-bit fixed point
+// calculation. yuv2rgbFixed() below does that calculation for a single pixel,
+// the SIMD output must be identical to it. The scalar fallback (only used when
+// there are no SIMD instructions) uses more precise coefficients instead. For
+// both the output must stay close to the exact (floating point) formula.
+
+static const unsigned WIDTH  = 640;
+static const unsigned HEIGHT = 480;
+static const unsigned UV_SIZE = (WIDTH / 2) * (HEIGHT / 2);
+
+struct YUVFrame
+{
+	YUVFrame()
+		: y(WIDTH * HEIGHT), u(UV_SIZE), v(UV_SIZE)
+	{
+		buffer[0] = { int(WIDTH),     int(HEIGHT),     int(WIDTH),     y.data() };
+		buffer[1] = { int(WIDTH / 2), int(HEIGHT / 2), int(WIDTH / 2), u.data() };
+		buffer[2] = { int(WIDTH / 2), int(HEIGHT / 2), int(WIDTH / 2), v.data() };
+	}
+
+	MemBuffer<uint8_t, 64> y, u, v;
+	th_ycbcr_buffer buffer;
+};
+
+static int sat16(int x)
+{
+	return std::min(std::max(x, -32768), 32767);
+}
+
+static void yuv2rgbFixed(int y, int u, int v, int& r, int& g, int& b)
+{
+	int dr = sat16(((v * 102) >> 6) - 223);
+	int dg = sat16(((v * -52 + u * -25) >> 6) + 136);
+	int db = sat16(((u * 129) >> 6) - 277);
+	int dy = (y * 74) >> 6;
+	r = Math::clipIntToByte(sat16(dr + dy));
+	g = Math::clipIntToByte(sat16(dg + dy));
+	b = Math::clipIntToByte(sat16(db + dy));
+}
+
+static void yuv2rgbExact(int y, int u, int v, int& r, int& g, int& b)
+{
+	double dy = 1.164 * (y - 16);
+	r = Math::clipIntToByte(lrint(dy + 1.596 * (v - 128)));
+	g = Math::clipIntToByte(lrint(dy - 0.813 * (v - 128) - 0.391 * (u - 128)));
+	b = Math::clipIntToByte(lrint(dy                     + 2.018 * (u - 128)));
+}
+
+static void fill(YUVFrame& frame)
+{
+	for (unsigned i = 0; i < WIDTH * HEIGHT; ++i) frame.y[i] = rand();
+	for (unsigned i = 0; i < UV_SIZE;        ++i) frame.u[i] = rand();
+	for (unsigned i = 0; i < UV_SIZE;        ++i) frame.v[i] = rand();
+	// make sure all extreme input combinations are present
+	for (unsigned i = 0; i < 8; ++i) {
+		frame.u[i] = (i & 1) ? 255 : 0;
+		frame.v[i] = (i & 2) ? 255 : 0;
+		frame.y[2 * i + 0] = (i & 4) ? 255 : 0;
+		frame.y[2 * i + 1] = (i & 4) ? 0 : 255;
+	}
+}
+
+static SDL_PixelFormat makeFormat(int bpp, int rBits, int gBits, int bBits)
+{
+	SDL_PixelFormat format = {};
+	format.BitsPerPixel  = bpp;
+	format.BytesPerPixel = bpp / 8;
+	format.Rloss  = 8 - rBits;
+	format.Gloss  = 8 - gBits;
+	format.Bloss  = 8 - bBits;
+	format.Bshift = 0;
+	format.Gshift = bBits;
+	format.Rshift = bBits + gBits;
+	format.Rmask  = ((1 << rBits) - 1) << format.Rshift;
+	format.Gmask  = ((1 << gBits) - 1) << format.Gshift;
+	format.Bmask  = ((1 << bBits) - 1) << format.Bshift;
+	return format;
+}
+
+#ifdef __SSE2__
+static uint32_t mapRGB(const SDL_PixelFormat& format, int r, int g, int b)
+{
+	return ((r >> format.Rloss) << format.Rshift) |
+	       ((g >> format.Gloss) << format.Gshift) |
+	       ((b >> format.Bloss) << format.Bshift);
+}
+#endif
+
+// Returns the number of wrong pixels.
+template<typename Pixel>
+static unsigned check(const YUVFrame& frame, RawFrame& output)
+{
+	const SDL_PixelFormat& format = output.getSDLPixelFormat();
+	const uint32_t rgbMask = format.Rmask | format.Gmask | format.Bmask;
+
+	unsigned errors = 0;
+	for (unsigned y = 0; y < HEIGHT; ++y) {
+		const Pixel* line = output.getLinePtrDirect<Pixel>(y);
+		if (output.getLineWidthDirect(y) != WIDTH) {
+			cout << "Wrong width for line " << y << endl;
+			++errors;
+		}
+		for (unsigned x = 0; x < WIDTH; ++x) {
+			int Y = frame.y[y * WIDTH + x];
+			int U = frame.u[(y / 2) * (WIDTH / 2) + x / 2];
+			int V = frame.v[(y / 2) * (WIDTH / 2) + x / 2];
+			uint32_t actual = line[x] & rgbMask;
+			int r, g, b;
+#ifdef __SSE2__
+			yuv2rgbFixed(Y, U, V, r, g, b);
+			bool ok = actual == mapRGB(format, r, g, b);
+#else
+			// allowed deviation from the exact formula (per color
+			// component, before reducing it to the output format)
+			const int MAX_DIFF = 2;
+			yuv2rgbExact(Y, U, V, r, g, b);
+			int ar = ((actual & format.Rmask) >> format.Rshift) << format.Rloss;
+			int ag = ((actual & format.Gmask) >> format.Gshift) << format.Gloss;
+			int ab = ((actual & format.Bmask) >> format.Bshift) << format.Bloss;
+			int loss = 1 << std::max({format.Rloss, format.Gloss, format.Bloss});
+			bool ok = (abs(ar - r) < MAX_DIFF + loss) &&
+			          (abs(ag - g) < MAX_DIFF + loss) &&
+			          (abs(ab - b) < MAX_DIFF + loss);
+#endif
+			if (!ok && (errors++ < 10)) {
+				cout << "Wrong pixel at " << x << ',' << y
+				     << " for Y,U,V = " << Y << ',' << U << ',' << V
+				     << endl;
+			}
+		}
+	}
+	return errors;
+}
+
+int main()
+{
+	YUVFrame frame;
+	fill(frame);
+
+	// For reference: how far the fixed point calculation is off.
+	int maxDiff = 0;
+	for (int y = 0; y < 256; ++y) {
+		for (int u = 0; u < 256; ++u) {
+			for (int v = 0; v < 256; ++v) {
+				int fr, fg, fb, er, eg, eb;
+				yuv2rgbFixed(y, u, v, fr, fg, fb);
+				yuv2rgbExact(y, u, v, er, eg, eb);
+				maxDiff = std::max({maxDiff, abs(fr - er),
+				                    abs(fg - eg), abs(fb - eb)});
+			}
+		}
+	}
+	cout << "Maximum deviation of the fixed point calculation: "
+	     << maxDiff << endl;
+
+	struct Test { const char* name; SDL_PixelFormat format; };
+	Test tests[] = {
+		{ "32bpp",     makeFormat(32, 8, 8, 8) },
+		{ "16bpp 565", makeFormat(16, 5, 6, 5) },
+		{ "16bpp 555", makeFormat(16, 5, 5, 5) },
+	};
+	unsigned errors = 0;
+	for (auto& t : tests) {
+		RawFrame output(t.format, WIDTH, HEIGHT);
+		yuv2rgb::convert(frame.buffer, output);
+		errors += (t.format.BytesPerPixel == 4)
+		        ? check<uint32_t>(frame, output)
+		        : check<uint16_t>(frame, output);
+
+		// benchmark
+		const int REPEAT = 1000;
+		auto start = chrono::high_resolution_clock::now();
+		for (int i = 0; i < REPEAT; ++i) {
+			yuv2rgb::convert(frame.buffer, output);
+		}
+		auto stop = chrono::high_resolution_clock::now();
+		auto us = chrono::duration_cast<chrono::microseconds>(stop - start);
+		cout << t.name << ": " << double(us.count()) / REPEAT
+		     << "us per " << WIDTH << 'x' << HEIGHT << " frame" << endl;
+	}
+
+	if (errors) {
+		cout << errors << " wrong pixels" << endl;
+		return 1;
+	}
+	cout << "All ok" << endl;
+	return 0;
+}
@@ -112,10 +112,77 @@ void RamDebuggable::write(unsigned address, byte value)
 }
 
 
+// Granularity of the page map in savestates (see Ram::serialize()).
+static const unsigned PAGE_SIZE = 1024;
+
+// version 1: whole ram as one blob
+// version 2: a map with for each page whether it's filled with a single value
+//            (and which value), followed by only the non-uniform pages. Large
+//            memory mappers are typically mostly unused (filled with the
+//            initial pattern), this saves time and space when (de)compressing.
+//            In-memory archives (reverse snapshots) still use the version 1
+//            format, there the delta-compression in DeltaBlock already
+//            handles unchanged pages, and that needs a stable blob.
 template<typename Archive>
-void Ram::serialize(Archive& ar, unsigned /*version*/)
+void Ram::serialize(Archive& ar, unsigned version)
 {
-	ar.serialize_blob("ram", ram.data(), size);
+	if (!ar.needVersion() || ar.versionBelow(version, 2)) {
+		ar.serialize_blob("ram", ram.data(), size);
+		return;
+	}
+
+	// per page two bytes: 'is uniform' flag and the fill value
+	unsigned numPages = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+	MemBuffer<byte> pages(2 * numPages);
+	auto pageLen = [&](unsigned page) {
+		return std::min(PAGE_SIZE, size - page * PAGE_SIZE);
+	};
+	if (!ar.isLoader()) {
+		for (unsigned page = 0; page < numPages; ++page) {
+			const byte* p = &ram[page * PAGE_SIZE];
+			bool uniform = memcmp(p, p + 1, pageLen(page) - 1) == 0;
+			pages[2 * page + 0] = uniform;
+			pages[2 * page + 1] = uniform ? p[0] : 0;
+		}
+	}
+	ar.serialize_blob("pages", pages.data(), 2 * numPages);
+
+	size_t packedSize = 0;
+	for (unsigned page = 0; page < numPages; ++page) {
+		if (!pages[2 * page]) packedSize += pageLen(page);
+	}
+	if (packedSize == size) {
+		// no uniform pages, no need to (un)pack
+		ar.serialize_blob("ram", ram.data(), size);
+		return;
+	}
+
+	MemBuffer<byte> packed(packedSize);
+	auto copyPages = [&](bool pack) {
+		size_t pos = 0;
+		for (unsigned page = 0; page < numPages; ++page) {
+			if (pages[2 * page]) continue;
+			byte* p = &ram[page * PAGE_SIZE];
+			unsigned len = pageLen(page);
+			if (pack) {
+				memcpy(&packed[pos], p, len);
+			} else {
+				memcpy(p, &packed[pos], len);
+			}
+			pos += len;
+		}
+	};
+	if (!ar.isLoader()) copyPages(true);
+	if (packedSize) ar.serialize_blob("ram", packed.data(), packedSize);
+	if (ar.isLoader()) {
+		copyPages(false);
+		for (unsigned page = 0; page < numPages; ++page) {
+			if (pages[2 * page]) {
+				memset(&ram[page * PAGE_SIZE], pages[2 * page + 1],
+				       pageLen(page));
+			}
+		}
+	}
 }
 INSTANTIATE_SERIALIZE_METHODS(Ram);
 
@@ -3,6 +3,7 @@
 
 #include "MemBuffer.hh"
 #include "openmsx.hh"
+#include "serialize_meta.hh"
 #include <string>
 #include <memory>
 
@@ -46,6 +47,7 @@ private:
 	unsigned size; // must come before debuggable
 	const std::unique_ptr<RamDebuggable> debuggable; // can be nullptr
 };
+SERIALIZE_CLASS_VERSION(Ram, 2);
 
 } // namespace openmsx
 
@@ -19,6 +19,7 @@
 #include "StringOp.hh"
 #include "sha1.hh"
 #include "memory.hh"
+#include <algorithm>
 #include <limits>
 #include <cstring>
 
@@ -182,24 +183,29 @@ void Rom::init(MSXMotherBoard& motherBoard, const XMLElement& config,
 				"supported.");
 		}
 		try {
-			size_t size2;
-			rom = file.mmap(size2);
+			// For file-based roms, calc sha1 via File::getSha1Sum().
+			// It can possibly use the FilePool cache to avoid the
+			// calculation.
+			if (originalSha1.empty()) {
+				originalSha1 = filepool.getSha1Sum(file);
+			}
+			// Roms with the same content (e.g. the system roms of
+			// the machines created by the reverse feature) share
+			// one copy, then the file doesn't even need to be read.
+			storedRom = motherBoard.getReactor().getRomStore().get(
+				originalSha1, file);
+			size_t size2 = storedRom->size();
 			if (size2 > std::numeric_limits<decltype(size)>::max()) {
 				throw MSXException("Rom file too big: " +
 				                   file.getURL());
 			}
+			rom = storedRom->data();
 			size = unsigned(size2);
 		} catch (FileException&) {
 			throw MSXException("Error reading ROM image: " +
 					   file.getURL());
 		}
 
-		// For file-based roms, calc sha1 via File::getSha1Sum(). It can
-		// possibly use the FilePool cache to avoid the calculation.
-		if (originalSha1.empty()) {
-			originalSha1 = filepool.getSha1Sum(file);
-		}
-
 		// verify SHA1
 		if (!checkSHA1(config)) {
 			motherBoard.getMSXCliComm().printWarning(
@@ -240,15 +246,15 @@ void Rom::init(MSXMotherBoard& motherBoard, const XMLElement& config,
 					Filename(p->getData(), context),
 					std::move(patch));
 			}
-			auto patchSize = unsigned(patch->getSize());
-			if (patchSize <= size) {
-				patch->copyBlock(0, const_cast<byte*>(rom), size);
-			} else {
-				size = patchSize;
-				extendedRom.resize(size);
-				patch->copyBlock(0, extendedRom.data(), size);
-				rom = extendedRom.data();
-			}
+			// The original content can be shared with other Roms,
+			// so patch into a private copy.
+			auto newSize = std::max(size, unsigned(patch->getSize()));
+			MemBuffer<byte> patched(newSize);
+			patch->copyBlock(0, patched.data(), newSize);
+			extendedRom = std::move(patched);
+			rom = extendedRom.data();
+			size = newSize;
+			storedRom.reset();
 
 			// calculated because it's different from original
 			patchedSha1 = SHA1::calc(rom, size);
@@ -338,6 +344,7 @@ bool Rom::checkSHA1(const XMLElement& config)
 Rom::Rom(Rom&& r) noexcept
 	: rom          (std::move(r.rom))
 	, extendedRom  (std::move(r.extendedRom))
+	, storedRom    (std::move(r.storedRom))
 	, file         (std::move(r.file))
 	, originalSha1 (std::move(r.originalSha1))
 	, name         (std::move(r.name))
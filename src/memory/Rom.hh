@@ -3,6 +3,7 @@
 
 #include "File.hh"
 #include "MemBuffer.hh"
+#include "RomStore.hh"
 #include "sha1.hh"
 #include "openmsx.hh"
 #include <string>
@@ -47,6 +48,7 @@ private:
 	// !! update the move constructor when changing these members !!
 	const byte* rom;
 	MemBuffer<byte> extendedRom;
+	std::shared_ptr<const RomStore::Image> storedRom; // can be nullptr
 
 	File file; // can be a closed file
 
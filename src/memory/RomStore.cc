@@ -0,0 +1,45 @@
+#include "RomStore.hh"
+#include "File.hh"
+#include <algorithm>
+#include <cstring>
+
+namespace openmsx {
+
+RomStore::Image::Image(File& file)
+{
+	// Often the file was already mapped to calculate its sha1sum.
+	const byte* content = file.mmap(sz);
+	if (sz) {
+		buffer = MemBuffer<byte, 4096>(sz);
+		memcpy(buffer.data(), content, sz);
+	}
+	file.munmap();
+}
+
+std::shared_ptr<const RomStore::Image> RomStore::get(
+	const Sha1Sum& sha1, File& file)
+{
+	auto it = find_if(begin(images), end(images),
+		[&](const std::pair<Sha1Sum, std::weak_ptr<const Image>>& p) {
+			return p.first == sha1; });
+	if (it != end(images)) {
+		if (auto image = it->second.lock()) {
+			return image;
+		}
+	}
+
+	std::shared_ptr<const Image> image = std::make_shared<Image>(file);
+	if (it != end(images)) {
+		it->second = image;
+	} else {
+		// also forget about images that are no longer used
+		images.erase(remove_if(begin(images), end(images),
+			[](const std::pair<Sha1Sum, std::weak_ptr<const Image>>& p) {
+				return p.second.expired(); }),
+			end(images));
+		images.emplace_back(sha1, image);
+	}
+	return image;
+}
+
+} // namespace openmsx
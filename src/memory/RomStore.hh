@@ -0,0 +1,53 @@
+#ifndef ROMSTORE_HH
+#define ROMSTORE_HH
+
+#include "MemBuffer.hh"
+#include "sha1.hh"
+#include "openmsx.hh"
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace openmsx {
+
+class File;
+
+/** Content-addressed store for the (unpatched) content of ROM files,
+  * shared by all machines of a Reactor.
+  *
+  * Often the same ROM file is loaded several times: the same system ROMs
+  * in several machines, and every jump in the reverse history creates a
+  * new machine. Instead of each Rom having its own copy, they all get the
+  * same immutable (page-aligned) buffer. The store itself only keeps weak
+  * references, so a buffer is freed as soon as the last Rom using it is
+  * destroyed.
+  */
+class RomStore
+{
+public:
+	class Image
+	{
+	public:
+		explicit Image(File& file);
+		const byte* data() const { return buffer.data(); }
+		size_t size() const { return sz; }
+
+	private:
+		MemBuffer<byte, 4096> buffer;
+		size_t sz;
+	};
+
+	/** Get the content of the given file, which should have the given
+	  * sha1sum. The file is only read when no other Rom is currently
+	  * using content with this sha1sum.
+	  * @throws FileException when reading the file fails.
+	  */
+	std::shared_ptr<const Image> get(const Sha1Sum& sha1, File& file);
+
+private:
+	std::vector<std::pair<Sha1Sum, std::weak_ptr<const Image>>> images;
+};
+
+} // namespace openmsx
+
+#endif
@@ -6,9 +6,9 @@ namespace openmsx {
 template<typename Archive>
 void TrackedRam::serialize(Archive& ar, unsigned /*version*/)
 {
-	// Note: This is the exact same serialization format as the Ram class.
-	//  This allows to change from Ram to TrackedRam without having to
-	//  increase the class serialization version (of the user).
+	// Note: This is the exact same serialization format as (version 1 of)
+	//  the Ram class. This allows to change from Ram to TrackedRam without
+	//  having to increase the class serialization version (of the user).
 	bool diff = writeSinceLastReverseSnapshot || !ar.isReverseSnapshot();
 	ar.serialize_blob("ram", &ram[0], getSize(), diff);
 	if (ar.isReverseSnapshot()) writeSinceLastReverseSnapshot = false;
@@ -11,6 +11,10 @@
 #include "FileOperations.hh"
 #include "Version.hh"
 #include "Date.hh"
+#include "FileException.hh"
+#include "endian.hh"
+#include "rapidsax.hh"
+#include "snappy.hh"
 #include "cstdiop.hh" // for dup()
 #include <cstring>
 #include <limits>
@@ -254,12 +258,77 @@ void MemInputArchive::serialize_blob(const char*, void* data, size_t len, bool /
 
 ////
 
-XmlOutputArchive::XmlOutputArchive(const string& filename)
-	: root("serial")
+// Binary savestate format
+//
+// The (gzipped) XML format pays a lot of CPU time for the blobs (e.g. the
+// RAM content): they're compressed with zlib, base64 encoded, stored in
+// the XML tree and then the whole XML file is compressed with zlib again.
+// Loading reverses all these steps. In the binary format the XML document
+// only contains the (small) structure, blobs are stored as separate
+// sections in the file:
+//
+//   header:  magic "oMSXsav1", version, number of sections and the
+//            offset of the section table (all 32-bit little endian)
+//   sections
+//   table:   per section: offset, stored size, uncompressed size,
+//            compression (raw or snappy) and adler32 of the stored bytes
+//
+// Section 0 is the XML document, in there a blob is represented as
+//   <tag encoding="section">index</tag>
+// Large raw sections (blobs that don't compress well) are aligned on a page
+// boundary so that they can be used directly from a memory mapped file.
+// Small ones (e.g. a few registers) are not, that would waste up to a page
+// per blob.
+//
+// Snappy sections are decoded with snappy::uncompressChecked(), so also
+// crafted files can't make the decoder access memory out of bounds.
+
+static const char BINARY_MAGIC[8] = { 'o','M','S','X','s','a','v','1' };
+static const unsigned BINARY_VERSION = 1;
+static const size_t SECTION_ALIGN = 4096;
+static const size_t MIN_ALIGNED_SIZE = 16 * SECTION_ALIGN;
+enum { SECTION_RAW = 0, SECTION_SNAPPY = 1 };
+
+struct BinaryHeader
+{
+	char magic[8];
+	Endian::L32 version;
+	Endian::L32 numSections;
+	Endian::L32 tableOffset;
+	Endian::L32 reserved;
+};
+struct BinaryTableEntry
+{
+	Endian::L32 offset;
+	Endian::L32 storedSize;
+	Endian::L32 size;
+	Endian::L32 compression;
+	Endian::L32 checksum;
+};
+
+static const char* const XML_HEADER =
+	"<?xml version=\"1.0\" ?>\n"
+	"<!DOCTYPE openmsx-serialize SYSTEM 'openmsx-serialize.dtd'>\n";
+
+XmlOutputArchive::XmlOutputArchive(const string& filename, bool binary)
+	: file(nullptr)
+	, filePos(0)
+	, root("serial")
 {
 	root.addAttribute("openmsx_version", Version::full());
 	root.addAttribute("date_time", Date::toString(time(nullptr)));
 	root.addAttribute("platform", TARGET_PLATFORM);
+	current.push_back(&root);
+	if (binary) {
+		binFile = File(filename, File::TRUNCATE);
+		// header is written at the end, reserve space for it
+		BinaryHeader header;
+		memset(&header, 0, sizeof(header));
+		binFile.write(&header, sizeof(header));
+		filePos = sizeof(header);
+		sections.resize(1); // section 0 (XML) is also written at the end
+		return;
+	}
 	{
 		auto f = FileOperations::openFile(filename, "wb");
 		if (!f) goto error;
@@ -270,7 +339,6 @@ XmlOutputArchive::XmlOutputArchive(const string& filename)
 			close(duped_fd);
 			goto error;
 		}
-		current.push_back(&root);
 		return; // success
 		// on scope-exit 'File* f' is closed, and 'gzFile file'
 		// uses the dup()'ed file descriptor.
@@ -283,15 +351,94 @@ error:
 XmlOutputArchive::~XmlOutputArchive()
 {
 	assert(current.back() == &root);
-	const char* header =
-	    "<?xml version=\"1.0\" ?>\n"
-	    "<!DOCTYPE openmsx-serialize SYSTEM 'openmsx-serialize.dtd'>\n";
-	gzwrite(file, const_cast<char*>(header), unsigned(strlen(header)));
 	string dump = root.dump();
+	if (binFile.is_open()) {
+		try {
+			finishBinary(XML_HEADER + dump);
+		} catch (MSXException&) {
+			// Can't report errors from a destructor (write errors
+			// are also not reported for the gzipped format).
+		}
+		return;
+	}
+	gzwrite(file, const_cast<char*>(XML_HEADER), unsigned(strlen(XML_HEADER)));
 	gzwrite(file, const_cast<char*>(dump.data()), unsigned(dump.size()));
 	gzclose(file);
 }
 
+BinarySection XmlOutputArchive::writeSection(const void* data, size_t len)
+{
+	static const char zeros[SECTION_ALIGN] = {};
+
+	// Only use the compressed data when that gives a reasonable gain.
+	MemBuffer<char> buf(snappy::maxCompressedLength(len));
+	size_t compressedLen;
+	snappy::compress(static_cast<const char*>(data), len,
+	                 buf.data(), compressedLen);
+	bool compressed = compressedLen < (len - len / 8);
+	const void* stored = compressed ? buf.data() : data;
+	size_t storedSize  = compressed ? compressedLen : len;
+
+	if (!compressed && (len >= MIN_ALIGNED_SIZE)) {
+		size_t padding = (SECTION_ALIGN - filePos) & (SECTION_ALIGN - 1);
+		binFile.write(zeros, padding);
+		filePos += padding;
+	}
+	if ((filePos + storedSize) > std::numeric_limits<uint32_t>::max()) {
+		throw MSXException("Savestate too large for the binary format.");
+	}
+	BinarySection section;
+	section.offset      = uint32_t(filePos);
+	section.storedSize  = uint32_t(storedSize);
+	section.size        = uint32_t(len);
+	section.compression = compressed ? SECTION_SNAPPY : SECTION_RAW;
+	section.checksum    = uint32_t(adler32(adler32(0, nullptr, 0),
+		static_cast<const Bytef*>(stored), uInt(storedSize)));
+	binFile.write(stored, storedSize);
+	filePos += storedSize;
+	return section;
+}
+
+void XmlOutputArchive::finishBinary(const string& xml)
+{
+	sections[0] = writeSection(xml.data(), xml.size());
+
+	std::vector<BinaryTableEntry> table(sections.size());
+	for (size_t i = 0; i < sections.size(); ++i) {
+		table[i].offset      = sections[i].offset;
+		table[i].storedSize  = sections[i].storedSize;
+		table[i].size        = sections[i].size;
+		table[i].compression = sections[i].compression;
+		table[i].checksum    = sections[i].checksum;
+	}
+	binFile.write(table.data(), table.size() * sizeof(BinaryTableEntry));
+
+	BinaryHeader header;
+	memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+	header.version     = BINARY_VERSION;
+	header.numSections = uint32_t(sections.size());
+	header.tableOffset = uint32_t(filePos);
+	header.reserved    = 0;
+	binFile.seek(0);
+	binFile.write(&header, sizeof(header));
+}
+
+void XmlOutputArchive::serialize_blob(const char* tag, const void* data,
+                                      size_t len, bool diff)
+{
+	if (!binFile.is_open()) {
+		OutputArchiveBase<XmlOutputArchive>::serialize_blob(
+			tag, data, len, diff);
+		return;
+	}
+	unsigned index = unsigned(sections.size());
+	sections.push_back(writeSection(data, len));
+	beginTag(tag);
+	attribute("encoding", string("section"));
+	save(index);
+	endTag(tag);
+}
+
 void XmlOutputArchive::saveChar(char c)
 {
 	save(string(1, c));
@@ -364,11 +511,123 @@ void XmlOutputArchive::endTag(const char* tag)
 ////
 
 XmlInputArchive::XmlInputArchive(const string& filename)
-	: rootElem(XMLLoader::load(filename, "openmsx-serialize.dtd"))
+	: mapping(nullptr)
+	, mappingSize(0)
 {
+	if (!openBinary(filename)) {
+		rootElem = XMLLoader::load(filename, "openmsx-serialize.dtd");
+	}
 	elems.emplace_back(&rootElem, 0);
 }
 
+bool XmlInputArchive::openBinary(const string& filename)
+{
+	// Don't transparently uncompress, gzipped (XML) files are not binary.
+	File f;
+	try {
+		f = File(filename, "rb");
+		if (f.getSize() < sizeof(BinaryHeader)) return false;
+		char magic[sizeof(BINARY_MAGIC)];
+		f.read(magic, sizeof(magic));
+		if (memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0) return false;
+	} catch (FileException&) {
+		return false; // let XMLLoader report the error
+	}
+
+	binFile = std::move(f);
+	mapping = binFile.mmap(mappingSize);
+	auto& header = *reinterpret_cast<const BinaryHeader*>(mapping);
+	if (header.version != BINARY_VERSION) {
+		throw XMLException(StringOp::Builder() <<
+			"Unsupported binary savestate version: " << uint32_t(header.version));
+	}
+	size_t numSections = header.numSections;
+	size_t tableOffset = header.tableOffset;
+	if ((numSections == 0) ||
+	    (tableOffset > mappingSize) ||
+	    (numSections > ((mappingSize - tableOffset) / sizeof(BinaryTableEntry)))) {
+		throw XMLException("Invalid binary savestate: bad section table");
+	}
+	auto* table = reinterpret_cast<const BinaryTableEntry*>(mapping + tableOffset);
+	sections.resize(numSections);
+	for (size_t i = 0; i < numSections; ++i) {
+		auto& section = sections[i];
+		section.offset      = table[i].offset;
+		section.storedSize  = table[i].storedSize;
+		section.size        = table[i].size;
+		section.compression = table[i].compression;
+		section.checksum    = table[i].checksum;
+		if ((section.offset > mappingSize) ||
+		    (section.storedSize > (mappingSize - section.offset))) {
+			throw XMLException("Invalid binary savestate: bad section");
+		}
+	}
+
+	MemBuffer<char> xml(sections[0].size + rapidsax::EXTRA_BUFFER_SPACE);
+	readSection(0, xml.data(), sections[0].size);
+	xml[sections[0].size] = 0;
+	rootElem = XMLLoader::parse(xml.data(), filename, "openmsx-serialize.dtd");
+	return true;
+}
+
+void XmlInputArchive::readSection(unsigned index, void* data, size_t len)
+{
+	if (index >= sections.size()) {
+		throw XMLException("Invalid binary savestate: missing section");
+	}
+	const auto& section = sections[index];
+	if (section.size != len) {
+		throw XMLException(StringOp::Builder()
+			<< "Length of blob different from expected value ("
+			<< len << ')');
+	}
+	const byte* src = mapping + section.offset;
+	auto checksum = uint32_t(adler32(adler32(0, nullptr, 0),
+		src, uInt(section.storedSize)));
+	if (checksum != section.checksum) {
+		throw XMLException("Invalid binary savestate: checksum error");
+	}
+	switch (section.compression) {
+	case SECTION_RAW:
+		if (section.storedSize != len) {
+			throw XMLException("Invalid binary savestate: bad section");
+		}
+		memcpy(data, src, len);
+		break;
+	case SECTION_SNAPPY:
+		if (!snappy::uncompressChecked(
+				reinterpret_cast<const char*>(src),
+				section.storedSize,
+				static_cast<char*>(data), len)) {
+			throw XMLException("Invalid binary savestate: bad compressed section");
+		}
+		break;
+	default:
+		throw XMLException("Invalid binary savestate: unknown compression");
+	}
+}
+
+void XmlInputArchive::serialize_blob(const char* tag, void* data, size_t len,
+                                     bool diff)
+{
+	if (!binFile.is_open()) {
+		InputArchiveBase<XmlInputArchive>::serialize_blob(
+			tag, data, len, diff);
+		return;
+	}
+	beginTag(tag);
+	string encoding;
+	attribute("encoding", encoding);
+	if (encoding != "section") {
+		throw XMLException("Unsupported encoding \"" + encoding +
+		                   "\" for blob in binary savestate");
+	}
+	unsigned index;
+	load(index);
+	endTag(tag);
+	readSection(index, data, len);
+}
+
 string_ref XmlInputArchive::loadStr()
 {
 	if (!elems.back().first->getChildren().empty()) {
@@ -4,6 +4,7 @@
 #include "serialize_core.hh"
 #include "SerializeBuffer.hh"
 #include "XMLElement.hh"
+#include "File.hh"
 #include "MemBuffer.hh"
 #include "StringOp.hh"
 #include "inline.hh"
@@ -716,10 +717,26 @@ private:
 
 ////
 
+/** Location of a blob in a binary savestate, see comments in serialize.cc.
+  */
+struct BinarySection
+{
+	uint32_t offset; // in the file
+	uint32_t storedSize;
+	uint32_t size; // uncompressed
+	uint32_t compression;
+	uint32_t checksum; // adler32 of the stored bytes
+};
+
 class XmlOutputArchive final : public OutputArchiveBase<XmlOutputArchive>
 {
 public:
-	explicit XmlOutputArchive(const std::string& filename);
+	/** @param binary Write the binary container format instead of a
+	  *               gzipped XML file. Both formats can be loaded by
+	  *               XmlInputArchive.
+	  */
+	explicit XmlOutputArchive(const std::string& filename,
+	                          bool binary = false);
 	~XmlOutputArchive();
 
 	template <typename T> void saveImpl(const T& t)
@@ -741,6 +758,8 @@ public:
 	void save(int i);                  // these 3 are not strictly needed
 	void save(unsigned u);             // but having them non-inline
 	void save(unsigned long long ull); // saves quite a bit of code
+	void serialize_blob(const char* tag, const void* data, size_t len,
+	                    bool diff = true);
 
 	void beginSection() { /*nothing*/ }
 	void endSection()   { /*nothing*/ }
@@ -766,7 +785,13 @@ public:
 	void attribute(const char* name, unsigned u);
 
 private:
+	BinarySection writeSection(const void* data, size_t len);
+	void finishBinary(const std::string& xml);
+
 	gzFile file;
+	File binFile; // only open for the binary format
+	std::vector<BinarySection> sections;
+	size_t filePos;
 	XMLElement root;
 	std::vector<XMLElement*> current;
 };
@@ -802,6 +827,8 @@ public:
 	void load(unsigned long long& ull); // saves quite a bit of code
 	void load(std::string& t);
 	string_ref loadStr();
+	void serialize_blob(const char* tag, void* data, size_t len,
+	                    bool diff = true);
 
 	void skipSection(bool /*skip*/) { /*nothing*/ }
 
@@ -833,6 +860,13 @@ public:
 	int countChildren() const;
 
 private:
+	bool openBinary(const std::string& filename);
+	void readSection(unsigned index, void* data, size_t len);
+
+	File binFile; // only open for the binary format
+	const byte* mapping;
+	size_t mappingSize;
+	std::vector<BinarySection> sections;
 	XMLElement rootElem;
 	std::vector<std::pair<const XMLElement*, size_t>> elems;
 };
@@ -9,6 +9,7 @@ BooleanSetting::BooleanSetting(
 		string_ref description_, bool initialValue, SaveSetting save_)
 	: Setting(commandController_, name, description_,
 	          TclObject(toString(initialValue)), save_)
+	, boolValue(initialValue)
 {
 	auto& interp = getInterpreter();
 	setChecker([this, &interp](TclObject& newValue) {
@@ -33,5 +34,10 @@ void BooleanSetting::tabCompletion(std::vector<std::string>& tokens) const
 	Completer::completeString(tokens, values, false); // case insensitive
 }
 
+void BooleanSetting::valueChanged()
+{
+	boolValue = getValue().getBoolean(getInterpreter());
+}
+
 
 } // namespace openmsx
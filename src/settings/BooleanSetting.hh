@@ -14,11 +14,14 @@ public:
 	string_ref getTypeString() const override;
 	void tabCompletion(std::vector<std::string>& tokens) const override;
 
-	bool getBoolean() const { return getValue().getBoolean(getInterpreter()); }
+	bool getBoolean() const { return boolValue; }
 	void setBoolean(bool b) { setValue(TclObject(toString(b))); }
 
 private:
+	void valueChanged() override;
 	static string_ref toString(bool b) { return b ? "true" : "false"; }
+
+	bool boolValue; // cached getValue()
 };
 
 } // namespace openmsx
@@ -47,7 +47,10 @@ public:
 	string_ref getString() const;
 
 private:
+	void valueChanged() override;
 	string_ref toString(T e) const;
+
+	int enumValue; // cached getValue()
 };
 
 
@@ -63,6 +66,7 @@ EnumSetting<T>::EnumSetting(
 	                          std::make_move_iterator(end(map))))
 	, Setting(commandController_, name, description_,
 	          TclObject(toString(initialValue)), save_)
+	, enumValue(static_cast<int>(initialValue))
 {
 	setChecker([this](TclObject& newValue) {
 		fromStringBase(newValue.getString()); // may throw
@@ -91,12 +95,12 @@ void EnumSetting<T>::tabCompletion(std::vector<std::string>& tokens) const
 template<typename T>
 T EnumSetting<T>::getEnum() const
 {
-	return static_cast<T>(fromStringBase(getValue().getString()));
+	return static_cast<T>(enumValue);
 }
 template<> inline bool EnumSetting<bool>::getEnum() const
 {
 	// _exactly_ the same functionality as above, but suppress VS warning
-	return fromStringBase(getValue().getString()) != 0;
+	return enumValue != 0;
 }
 
 template<typename T>
@@ -111,6 +115,12 @@ string_ref EnumSetting<T>::getString() const
 	return getValue().getString();
 }
 
+template<typename T>
+void EnumSetting<T>::valueChanged()
+{
+	enumValue = fromStringBase(getValue().getString());
+}
+
 template<typename T>
 string_ref EnumSetting<T>::toString(T e) const
 {
@@ -11,6 +11,7 @@ FloatSetting::FloatSetting(CommandController& commandController_,
 	          TclObject(initialValue), SAVE)
 	, minValue(minValue_)
 	, maxValue(maxValue_)
+	, doubleValue(initialValue)
 {
 	auto& interp = getInterpreter();
 	setChecker([this, &interp](TclObject& newValue) {
@@ -39,4 +40,9 @@ void FloatSetting::setDouble(double d)
 	setValue(TclObject(d));
 }
 
+void FloatSetting::valueChanged()
+{
+	doubleValue = getValue().getDouble(getInterpreter());
+}
+
 } // namespace openmsx
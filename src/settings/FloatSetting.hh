@@ -17,12 +17,15 @@ public:
 	string_ref getTypeString() const override;
 	void additionalInfo(TclObject& result) const override;
 
-	double getDouble() const { return getValue().getDouble(getInterpreter()); }
+	double getDouble() const { return doubleValue; }
 	void setDouble (double d);
 
 private:
+	void valueChanged() override;
+
 	const double minValue;
 	const double maxValue;
+	double doubleValue; // cached getValue()
 };
 
 } // namespace openmsx
@@ -10,6 +10,7 @@ IntegerSetting::IntegerSetting(CommandController& commandController_,
 	          TclObject(initialValue), SAVE)
 	, minValue(minValue_)
 	, maxValue(maxValue_)
+	, intValue(initialValue)
 {
 	auto& interp = getInterpreter();
 	setChecker([this, &interp](TclObject& newValue) {
@@ -38,4 +39,9 @@ void IntegerSetting::setInt(int i)
 	setValue(TclObject(i));
 }
 
+void IntegerSetting::valueChanged()
+{
+	intValue = getValue().getInt(getInterpreter());
+}
+
 } // namespace openmsx
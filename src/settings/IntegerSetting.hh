@@ -17,12 +17,15 @@ public:
 	string_ref getTypeString() const override;
 	void additionalInfo(TclObject& result) const override;
 
-	int getInt() const { return getValue().getInt(getInterpreter()); }
+	int getInt() const { return intValue; }
 	void setInt(int i);
 
 private:
+	void valueChanged() override;
+
 	const int minValue;
 	const int maxValue;
+	int intValue; // cached getValue()
 };
 
 } // namespace openmsx
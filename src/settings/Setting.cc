@@ -3,6 +3,7 @@
 #include "GlobalCommandController.hh"
 #include "MSXCommandController.hh"
 #include "SettingsConfig.hh"
+#include "SettingsManager.hh"
 #include "TclObject.hh"
 #include "CliComm.hh"
 #include "XMLElement.hh"
@@ -67,6 +68,7 @@ void Setting::init()
 			}
 		}
 	}
+	valueChanged();
 	getCommandController().registerSetting(*this);
 
 	// This is needed to for example inform catapult of the new setting
@@ -101,6 +103,12 @@ void Setting::notify() const
 	//  - CliComm setting-change events (for external GUIs)
 	//  - SettingsConfig (keeps values, also of not yet created settings)
 	// This method takes care of the last 3 in this list.
+	//
+	// While a batch is active (see SettingsManager::Batch) this is
+	// postponed till the end of the batch.
+	if (getGlobalCommandController().getSettingsManager().deferNotify(*this)) {
+		return;
+	}
 	Subject<Setting>::notify();
 	TclObject val = getValue();
 	commandController.getCliComm().update(
@@ -181,6 +189,7 @@ void Setting::setValueDirect(const TclObject& newValue_)
 	checkFunc(newValue);
 	if (newValue != value) {
 		value = newValue;
+		valueChanged();
 		notify();
 	}
 
@@ -174,10 +174,22 @@ protected:
 	void init();
 	void notifyPropertyChange() const;
 
+	/** Called each time the value of this setting changed (and once from
+	  * init()). Subclasses override this to cache the value in its native
+	  * type, so that the getters don't need to convert the TclObject.
+	  * These cached values are plain members. Like the TclObject itself
+	  * they may only be read on the main thread. Code that runs on
+	  * another thread (e.g. the scale thread of FBPostProcessor) must
+	  * get a copy of the values from the main thread.
+	  */
+	virtual void valueChanged() {}
+
 private:
 	GlobalCommandController& getGlobalCommandController() const;
 	void notify() const;
 
+	friend class SettingsManager; // for notify() at the end of a batch
+
 private:
 	CommandController& commandController;
 	const std::string description;
@@ -3,8 +3,11 @@
 #include "TclObject.hh"
 #include "CommandException.hh"
 #include "XMLElement.hh"
+#include "MSXException.hh"
 #include "outer.hh"
+#include "stl.hh"
 #include "vla.hh"
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 
@@ -20,12 +23,15 @@ SettingsManager::SettingsManager(GlobalCommandController& commandController)
 	, setCompleter  (commandController)
 	, incrCompleter (commandController, *this, "incr")
 	, unsetCompleter(commandController, *this, "unset")
+	, batchCmd      (commandController)
+	, batchLevel(0)
 {
 }
 
 SettingsManager::~SettingsManager()
 {
 	assert(settings.empty());
+	assert(batchLevel == 0);
 }
 
 void SettingsManager::registerSetting(BaseSetting& setting)
@@ -39,6 +45,64 @@ void SettingsManager::unregisterSetting(BaseSetting& setting)
 	const auto& name = setting.getFullNameObj();
 	assert(settings.contains(name));
 	settings.erase(name);
+
+	if (!pendingNotifications.empty()) {
+		if (auto* s = dynamic_cast<Setting*>(&setting)) {
+			pendingNotifications.erase(
+				std::remove(begin(pendingNotifications),
+				            end(pendingNotifications), s),
+				end(pendingNotifications));
+		}
+	}
+}
+
+bool SettingsManager::deferNotify(const Setting& setting)
+{
+	if (batchLevel == 0) return false;
+	if (!contains(pendingNotifications, &setting)) {
+		pendingNotifications.push_back(&setting);
+	}
+	return true;
+}
+
+void SettingsManager::flushNotifications()
+{
+	// Observers may change (other) settings again, those are then notified
+	// immediately (we're no longer in a batch).
+	auto pending = std::move(pendingNotifications);
+	pendingNotifications.clear();
+	for (auto* setting : pending) {
+		setting->notify();
+	}
+}
+
+
+// class SettingsManager::Batch
+
+SettingsManager::Batch::Batch(SettingsManager& manager_)
+	: manager(manager_)
+	, active(true)
+{
+	++manager.batchLevel;
+}
+
+SettingsManager::Batch::~Batch()
+{
+	try {
+		end();
+	} catch (MSXException&) {
+		// ignore, can't throw from a destructor
+	}
+}
+
+void SettingsManager::Batch::end()
+{
+	if (!active) return;
+	active = false;
+	assert(manager.batchLevel > 0);
+	if (--manager.batchLevel == 0) {
+		manager.flushNotifications();
+	}
 }
 
 BaseSetting* SettingsManager::findSetting(string_ref name) const
@@ -84,6 +148,10 @@ vector<string> SettingsManager::getTabSettingNames() const
 
 void SettingsManager::loadSettings(const XMLElement& config)
 {
+	// Most settings get set twice below (once to their default and once
+	// to the loaded value), only notify the observers about the end result.
+	Batch batch(*this);
+
 	// restore default values
 	for (auto* s : settings) {
 		if (s->needLoadSave()) {
@@ -222,4 +290,34 @@ void SettingsManager::SettingCompleter::tabCompletion(vector<string>& tokens) co
 	}
 }
 
+
+// class BatchCmd
+
+SettingsManager::BatchCmd::BatchCmd(CommandController& commandController_)
+	: Command(commandController_, "settings_batch")
+{
+}
+
+void SettingsManager::BatchCmd::execute(
+	array_ref<TclObject> tokens, TclObject& result)
+{
+	if (tokens.size() != 2) {
+		throw SyntaxError();
+	}
+	auto& manager = OUTER(SettingsManager, batchCmd);
+	Batch batch(manager);
+	TclObject command = tokens[1];
+	result = command.executeCommand(getInterpreter(), true);
+	batch.end();
+}
+
+string SettingsManager::BatchCmd::help(const vector<string>& /*tokens*/) const
+{
+	return "settings_batch <script>\n"
+	       "Executes the given script, the observers of the settings that\n"
+	       "are changed by this script are only notified once at the end\n"
+	       "of the script (with the final value of each setting). Use this\n"
+	       "to change a group of related settings at once.\n";
+}
+
 } // namespace openmsx
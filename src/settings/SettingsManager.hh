@@ -7,6 +7,7 @@
 #include "hash_set.hh"
 #include "string_ref.hh"
 #include "xxhash.hh"
+#include <vector>
 
 namespace openmsx {
 
@@ -36,7 +37,34 @@ public:
 	void registerSetting  (BaseSetting& setting);
 	void unregisterSetting(BaseSetting& setting);
 
+	/** While a Batch object exists, the change notifications of settings
+	  * (observers, CliComm and SettingsConfig) are postponed. When the
+	  * (outermost) batch ends, each setting that changed is notified
+	  * exactly once, with its final value. So changing a group of related
+	  * settings only triggers one update per setting in the subsystems
+	  * that observe them, instead of one per intermediate value.
+	  * Batches can be nested. The values themselves (also the ones
+	  * returned by the typed getters) are updated immediately.
+	  */
+	class Batch {
+	public:
+		explicit Batch(SettingsManager& manager);
+		~Batch();
+		/** End the batch now. Unlike the destructor, this propagates
+		  * exceptions thrown by the observers. */
+		void end();
+	private:
+		SettingsManager& manager;
+		bool active;
+	};
+
+	/** Called by Setting::notify(). Returns true when the notification
+	  * is postponed till the end of the current batch.
+	  */
+	bool deferNotify(const Setting& setting);
+
 private:
+	void flushNotifications();
 	BaseSetting& getByName(string_ref cmd, string_ref name) const;
 	std::vector<std::string> getTabSettingNames() const;
 
@@ -67,12 +95,21 @@ private:
 	SettingCompleter incrCompleter;
 	SettingCompleter unsetCompleter;
 
+	struct BatchCmd final : Command {
+		explicit BatchCmd(CommandController& commandController);
+		void execute(array_ref<TclObject> tokens, TclObject& result) override;
+		std::string help(const std::vector<std::string>& tokens) const override;
+	} batchCmd;
+
 	struct NameFromSetting {
 		const TclObject& operator()(BaseSetting* s) const {
 			return s->getFullNameObj();
 		}
 	};
 	hash_set<BaseSetting*, NameFromSetting, XXTclHasher> settings;
+
+	std::vector<const Setting*> pendingNotifications;
+	unsigned batchLevel;
 };
 
 } // namespace openmsx
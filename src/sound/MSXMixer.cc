@@ -11,6 +11,7 @@
 #include "BooleanSetting.hh"
 #include "CommandException.hh"
 #include "AviRecorder.hh"
+#include "SharedMemoryExporter.hh"
 #include "Filename.hh"
 #include "CliComm.hh"
 #include "Math.hh"
@@ -48,6 +49,7 @@ MSXMixer::MSXMixer(Mixer& mixer_, MSXMotherBoard& motherBoard_,
 	, prevTime(getCurrentTime(), 44100)
 	, soundDeviceInfo(commandController.getMachineInfoCommand())
 	, recorder(nullptr)
+	, exporter(nullptr)
 	, synchronousCounter(0)
 {
 	hostSampleRate = 44100;
@@ -68,6 +70,9 @@ MSXMixer::~MSXMixer()
 	if (recorder) {
 		recorder->stop();
 	}
+	if (exporter) {
+		exporter->stop();
+	}
 	assert(infos.empty());
 
 	throttleManager.detach(*this);
@@ -182,6 +187,9 @@ void MSXMixer::updateStream(EmuTime::param time)
 	if (recorder) {
 		recorder->addWave(count, mixBuffer);
 	}
+	if (exporter) {
+		exporter->addWave(count, mixBuffer);
+	}
 
 	prevTime += count;
 }
@@ -654,6 +662,14 @@ void MSXMixer::setRecorder(AviRecorder* newRecorder)
 	recorder = newRecorder;
 }
 
+void MSXMixer::setExporter(SharedMemoryExporter* newExporter)
+{
+	if ((exporter != nullptr) != (newExporter != nullptr)) {
+		setSynchronousMode(newExporter != nullptr);
+	}
+	exporter = newExporter;
+}
+
 void MSXMixer::update(const Setting& setting)
 {
 	if (&setting == &masterVolume) {
@@ -23,6 +23,7 @@ class StringSetting;
 class BooleanSetting;
 class Setting;
 class AviRecorder;
+class SharedMemoryExporter;
 
 class MSXMixer final : private Schedulable, private Observer<Setting>
                      , private Observer<ThrottleManager>
@@ -97,6 +98,9 @@ public:
 	bool needStereoRecording() const;
 	void setRecorder(AviRecorder* recorder);
 
+	// Called by SharedMemoryExporter
+	void setExporter(SharedMemoryExporter* exporter);
+
 	// Returns the nominal host sample rate (not adjusted for speed setting)
 	unsigned getSampleRate() const { return hostSampleRate; }
 
@@ -160,6 +164,7 @@ private:
 	} soundDeviceInfo;
 
 	AviRecorder* recorder;
+	SharedMemoryExporter* exporter;
 	unsigned synchronousCounter;
 
 	unsigned muteCount;
@@ -198,6 +198,20 @@ inline unsigned countLeadingZeros(unsigned x)
 #endif
 }
 
+/** Count the number of trailing zero-bits in the given word.
+  * The result is undefined when the input is zero (all bits are zero).
+  */
+inline unsigned countTrailingZeros(unsigned x)
+{
+#ifdef __GNUC__
+	return __builtin_ctz(x); // undefined when x==0
+#else
+	unsigned tz = 0;
+	while (!(x & 1)) { ++tz; x >>= 1; }
+	return tz;
+#endif
+}
+
 } // namespace Math
 
 #endif // MATH_HH
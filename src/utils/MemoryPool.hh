@@ -0,0 +1,134 @@
+#ifndef MEMORYPOOL_HH
+#define MEMORYPOOL_HH
+
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+#include <cstddef>
+
+namespace openmsx {
+
+/** Allocator for blocks of a fixed size. Memory is requested from the system
+  * in large chunks, freed blocks are kept in a free list for later reuse (the
+  * memory is never returned to the system). Compared to the general purpose
+  * allocator this avoids the per-allocation bookkeeping overhead and is
+  * faster when many small objects of the same type are created and
+  * destroyed.
+  *
+  * There's one instance per (size, alignment) combination, see instance().
+  * Allocation and deallocation can happen from different threads.
+  */
+template<size_t SIZE, size_t ALIGN>
+class FixedSizePool
+{
+public:
+	static FixedSizePool& instance()
+	{
+		// Intentionally never destroyed: static objects (destructed in
+		// unspecified order at exit) may still return blocks.
+		static auto* pool = new FixedSizePool();
+		return *pool;
+	}
+
+	void* allocate()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!freeList) grow();
+		auto* result = freeList;
+		freeList = freeList->next;
+		return result;
+	}
+
+	void deallocate(void* p)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		deallocateUnlocked(p);
+	}
+
+private:
+	struct FreeBlock { FreeBlock* next; };
+	static const size_t BLOCK_SIZE =
+		((((SIZE > sizeof(FreeBlock)) ? SIZE : sizeof(FreeBlock))
+		  + ALIGN - 1) / ALIGN) * ALIGN;
+	static const size_t BLOCKS_PER_CHUNK = 256;
+	static_assert(ALIGN <= alignof(std::max_align_t),
+	              "over-aligned types are not supported");
+
+	FixedSizePool() : freeList(nullptr) {}
+
+	void grow()
+	{
+		chunks.emplace_back(new char[BLOCK_SIZE * BLOCKS_PER_CHUNK]);
+		char* chunk = chunks.back().get();
+		for (size_t i = 0; i < BLOCKS_PER_CHUNK; ++i) {
+			deallocateUnlocked(chunk + i * BLOCK_SIZE);
+		}
+	}
+
+	void deallocateUnlocked(void* p)
+	{
+		auto* block = static_cast<FreeBlock*>(p);
+		block->next = freeList;
+		freeList = block;
+	}
+
+	std::mutex mutex;
+	FreeBlock* freeList;
+	std::vector<std::unique_ptr<char[]>> chunks;
+};
+
+/** Standard-library compatible allocator that takes single objects from a
+  * FixedSizePool (so each type gets its own pool). Allocating arrays falls
+  * back to the general purpose allocator.
+  */
+template<typename T>
+class PoolAllocator
+{
+public:
+	using value_type = T;
+
+	PoolAllocator() {}
+	template<typename U> PoolAllocator(const PoolAllocator<U>&) {}
+
+	T* allocate(size_t n)
+	{
+		if (n == 1) {
+			return static_cast<T*>(
+				FixedSizePool<sizeof(T), alignof(T)>::instance().allocate());
+		}
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T* p, size_t n)
+	{
+		if (n == 1) {
+			FixedSizePool<sizeof(T), alignof(T)>::instance().deallocate(p);
+		} else {
+			::operator delete(p);
+		}
+	}
+
+	template<typename U> struct rebind { using other = PoolAllocator<U>; };
+};
+
+template<typename T, typename U>
+bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) { return true; }
+template<typename T, typename U>
+bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) { return false; }
+
+/** Like std::make_shared(), but the object (together with the shared_ptr
+  * control block) is allocated from a per-type memory pool. Meant for small
+  * objects that are created at a high rate, like events and state changes.
+  */
+template<typename T, typename... Args>
+std::shared_ptr<T> make_pooled_shared(Args&&... args)
+{
+	return std::allocate_shared<T>(
+		PoolAllocator<T>(), std::forward<Args>(args)...);
+}
+
+} // namespace openmsx
+
+#endif
@@ -47,7 +47,8 @@ bool Poller::poll(int fd)
 			{ .fd = fd, .events = POLLIN },
 			{ .fd = wakeupPipe[0], .events = POLLIN },
 		};
-		int pollResult = ::poll(fds, 2, 1000);
+		// No timeout needed, abort() wakes us up via the pipe.
+		int pollResult = ::poll(fds, 2, -1);
 		if (abortFlag) {
 			return true;
 		}
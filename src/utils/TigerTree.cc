@@ -1,6 +1,11 @@
 #include "TigerTree.hh"
+#include "FileOperations.hh"
+#include "MSXException.hh"
 #include "Math.hh"
+#include <algorithm>
 #include <map>
+#include <thread>
+#include <cstdio>
 #include <cstring>
 #include <cassert>
 
@@ -8,29 +13,126 @@ namespace openmsx {
 
 static const size_t BLOCK_SIZE = 1024;
 
+// Leaf hashes are calculated in batches of this many blocks. While one batch
+// is being hashed (in parallel), the data for the next batch is fetched.
+static const size_t BATCH_SIZE = 4096;
+// Stride between the blocks in a batch buffer. Each block needs (at least)
+// one byte in front of it that can be overwritten (see tiger_leaf()).
+static const size_t BATCH_STRIDE = BLOCK_SIZE + 8;
+// Don't bother starting threads for less blocks than this.
+static const size_t MIN_PARALLEL = 64;
+static const unsigned MAX_THREADS = 8;
+
+// Only the hashes of the nodes at (nominal) level PERSIST_LEVEL or higher
+// are stored in the cache file. Storing all nodes would give a huge file
+// (twice the number of blocks times 24 bytes), while recalculating a
+// subtree of PERSIST_LEVEL blocks is cheap.
+static const size_t PERSIST_LEVEL = 64;
+static const char PERSIST_MAGIC[8] = { 'o','M','S','X','t','t','h','1' };
+
 struct TTCacheEntry
 {
-	TTCacheEntry() : time(-1) {}
+	TTCacheEntry() : time(-1), modified(false) {}
 
 	MemBuffer<TigerHash> hash;
 	MemBuffer<bool> valid;
 	size_t numNodes;
 	time_t time;
-	size_t numNodesValid;
+	bool modified; // changed since last load/store from/to cache file
 };
 // Typically contains 0 or 1 element, and only rarely 2 or more. But we need
 // the address of existing elements to remain stable when new elements are
 // inserted. So still use std::map instead of std::vector.
 static std::map<std::pair<size_t, std::string>, TTCacheEntry> ttCache;
 
+struct PersistHeader
+{
+	char magic[8];
+	uint64_t dataSize;
+	int64_t time;
+	uint64_t numNodes;
+};
+
 static size_t calcNumNodes(size_t dataSize)
 {
 	auto numBlocks = (dataSize + BLOCK_SIZE - 1) / BLOCK_SIZE;
 	return (numBlocks == 0) ? 1 : 2 * numBlocks - 1;
 }
 
+static size_t numPersistNodes(size_t numNodes)
+{
+	// nodes PERSIST_LEVEL-1, 2*PERSIST_LEVEL-1, 3*PERSIST_LEVEL-1, ...
+	return numNodes / PERSIST_LEVEL;
+}
+
+static bool loadCacheFile(TTCacheEntry& entry, size_t dataSize,
+                          const std::string& cacheFile)
+{
+	auto num = numPersistNodes(entry.numNodes);
+	if (cacheFile.empty() || (num == 0)) return false;
+	auto file = FileOperations::openFile(cacheFile, "rb");
+	if (!file) return false;
+
+	PersistHeader header;
+	if ((fread(&header, sizeof(header), 1, file.get()) != 1) ||
+	    (memcmp(header.magic, PERSIST_MAGIC, sizeof(PERSIST_MAGIC)) != 0) ||
+	    (header.dataSize != dataSize) ||
+	    (header.time != int64_t(entry.time)) ||
+	    (header.numNodes != entry.numNodes)) {
+		return false;
+	}
+	MemBuffer<uint8_t> valid(num);
+	MemBuffer<TigerHash> hash(num);
+	if ((fread(valid.data(), 1, num, file.get()) != num) ||
+	    (fread(hash.data(), sizeof(TigerHash), num, file.get()) != num)) {
+		return false;
+	}
+	for (size_t i = 0; i < num; ++i) {
+		auto n = (i + 1) * PERSIST_LEVEL - 1;
+		entry.valid[n] = valid[i] != 0;
+		entry.hash [n] = hash[i];
+	}
+	return true;
+}
+
+static void storeCacheFile(const TTCacheEntry& entry, size_t dataSize,
+                           const std::string& cacheFile)
+{
+	auto num = numPersistNodes(entry.numNodes);
+	if (num == 0) return;
+
+	// It's only a cache, so silently ignore all errors.
+	try {
+		FileOperations::mkdirp(FileOperations::getBaseName(cacheFile));
+	} catch (MSXException&) {
+		return;
+	}
+	auto file = FileOperations::openFile(cacheFile, "wb");
+	if (!file) return;
+
+	PersistHeader header;
+	memcpy(header.magic, PERSIST_MAGIC, sizeof(PERSIST_MAGIC));
+	header.dataSize = dataSize;
+	header.time = entry.time;
+	header.numNodes = entry.numNodes;
+	MemBuffer<uint8_t> valid(num);
+	MemBuffer<TigerHash> hash(num);
+	for (size_t i = 0; i < num; ++i) {
+		auto n = (i + 1) * PERSIST_LEVEL - 1;
+		valid[i] = entry.valid[n];
+		hash [i] = entry.hash [n];
+	}
+	if ((fwrite(&header, sizeof(header), 1, file.get()) != 1) ||
+	    (fwrite(valid.data(), 1, num, file.get()) != num) ||
+	    (fwrite(hash.data(), sizeof(TigerHash), num, file.get()) != num)) {
+		file.reset();
+		FileOperations::unlink(cacheFile);
+	}
+}
+
 static TTCacheEntry& getCacheEntry(
-	TTData& data, size_t dataSize, const std::string& name)
+	TTData& data, size_t dataSize, const std::string& name,
+	const std::string& cacheFile)
 {
 	auto& result = ttCache[std::make_pair(dataSize, name)];
 	if (!data.isCacheStillValid(result.time)) { // note: has side effect
@@ -39,48 +141,150 @@ static TTCacheEntry& getCacheEntry(
 		result.valid.resize(numNodes);
 		result.numNodes = numNodes;
 		memset(result.valid.data(), 0, numNodes); // all invalid
-		result.numNodesValid = 0;
+		result.modified = false;
+		loadCacheFile(result, dataSize, cacheFile);
 	}
 	return result;
 }
 
-TigerTree::TigerTree(TTData& data_, size_t dataSize_, const std::string& name)
+TigerTree::TigerTree(TTData& data_, size_t dataSize_, const std::string& name,
+                     const std::string& cacheFile_)
 	: data(data_)
 	, dataSize(dataSize_)
-	, entry(getCacheEntry(data, dataSize, name))
+	, cacheFile(cacheFile_)
+	, entry(getCacheEntry(data, dataSize, name, cacheFile))
 {
 }
 
+TigerTree::~TigerTree()
+{
+	// Note: don't access 'data' here, it might already be destructed.
+	if (!cacheFile.empty() && entry.modified) {
+		storeCacheFile(entry, dataSize, cacheFile);
+		entry.modified = false;
+	}
+}
+
 const TigerHash& TigerTree::calcHash(const std::function<void(size_t, size_t)>& progressCallback)
 {
-	return calcHash(getTop(), progressCallback);
+	// First (in parallel) calculate all leaf hashes that are needed, then
+	// combine those in the internal nodes (that part is relatively cheap).
+	hashLeaves(progressCallback);
+	return calcHash(getTop());
 }
 
 void TigerTree::notifyChange(size_t offset, size_t len, time_t time)
 {
 	entry.time = time;
+	entry.modified = true;
 
 	assert((offset + len) <= dataSize);
 	if (len == 0) return;
 
-	if (entry.valid[getTop().n]) {
-		entry.valid[getTop().n] = false; // set sentinel
-		entry.numNodesValid--;
-	}
+	// Note: we can't stop at the first already invalid node. Nodes loaded
+	// from the cache file can be valid while (some of) their descendants
+	// are not.
+	auto top = getTop().n;
 	auto first = offset / BLOCK_SIZE;
 	auto last = (offset + len - 1) / BLOCK_SIZE;
 	assert(first <= last); // requires len != 0
 	do {
 		auto node = getLeaf(first);
-		while (entry.valid[node.n]) {
+		while (true) {
 			entry.valid[node.n] = false;
-			entry.numNodesValid--;
+			if (node.n == top) break;
 			node = getParent(node);
 		}
 	} while (++first <= last);
 }
 
-const TigerHash& TigerTree::calcHash(Node node, const std::function<void(size_t, size_t)>& progressCallback)
+void TigerTree::collectLeaves(Node node, std::vector<size_t>& leaves) const
+{
+	if (entry.valid[node.n]) return;
+	if (node.n & 1) {
+		collectLeaves(getLeftChild (node), leaves);
+		collectLeaves(getRightChild(node), leaves);
+	} else {
+		leaves.push_back(node.n);
+	}
+}
+
+static void hashBlocks(const uint8_t* buf, const size_t* leaves, size_t num,
+                       TigerHash* hash)
+{
+	for (size_t i = 0; i < num; ++i) {
+		// tiger_leaf() restores the byte it temporarily overwrites
+		auto* d = const_cast<uint8_t*>(buf + i * BATCH_STRIDE + 8);
+		tiger_leaf(d, hash[leaves[i]]);
+	}
+}
+
+void TigerTree::hashLeaves(const std::function<void(size_t, size_t)>& progressCallback)
+{
+	std::vector<size_t> leaves;
+	collectLeaves(getTop(), leaves);
+	if (!leaves.empty() && ((leaves.back() * (BLOCK_SIZE / 2) + BLOCK_SIZE) > dataSize)) {
+		// partial last block, handled by calcHash(Node)
+		leaves.pop_back();
+	}
+	auto total = leaves.size();
+	if (total == 0) return;
+
+	unsigned numThreads = std::min(
+		std::max(std::thread::hardware_concurrency(), 1u), MAX_THREADS);
+	MemBuffer<uint8_t> bufs[2];
+	auto batch = std::min(total, BATCH_SIZE);
+	bufs[0].resize(batch * BATCH_STRIDE);
+	if (total > batch) bufs[1].resize(batch * BATCH_STRIDE);
+
+	auto fetch = [&](uint8_t* buf, size_t first, size_t num) {
+		for (size_t i = 0; i < num; ++i) {
+			auto* d = data.getData(leaves[first + i] * (BLOCK_SIZE / 2),
+			                       BLOCK_SIZE);
+			memcpy(buf + i * BATCH_STRIDE + 8, d, BLOCK_SIZE);
+		}
+	};
+
+	fetch(bufs[0].data(), 0, batch);
+	unsigned cur = 0;
+	size_t done = 0;
+	while (done < total) {
+		auto num = std::min(total - done, BATCH_SIZE);
+		const uint8_t* buf = bufs[cur].data();
+		std::vector<std::thread> workers;
+		if ((numThreads > 1) && (num >= MIN_PARALLEL)) {
+			// Hash this batch in the background ...
+			auto perThread = (num + numThreads - 1) / numThreads;
+			for (size_t begin = 0; begin < num; begin += perThread) {
+				auto cnt = std::min(perThread, num - begin);
+				workers.emplace_back(hashBlocks, buf + begin * BATCH_STRIDE,
+				                     &leaves[done + begin], cnt,
+				                     entry.hash.data());
+			}
+		} else {
+			hashBlocks(buf, &leaves[done], num, entry.hash.data());
+		}
+		// ... while fetching the data for the next batch.
+		auto next = done + num;
+		if (next < total) {
+			fetch(bufs[cur ^ 1].data(), next,
+			      std::min(total - next, BATCH_SIZE));
+		}
+		for (auto& w : workers) w.join();
+
+		for (size_t i = done; i < next; ++i) {
+			entry.valid[leaves[i]] = true;
+		}
+		entry.modified = true;
+		done = next;
+		cur ^= 1;
+		if (progressCallback) {
+			progressCallback(done, total);
+		}
+	}
+}
+
+const TigerHash& TigerTree::calcHash(Node node)
 {
 	auto n = node.n;
 	if (!entry.valid[n]) {
@@ -88,8 +292,8 @@ const TigerHash& TigerTree::calcHash(Node node, const std::function<void(size_t,
 			// interior node
 			auto left  = getLeftChild (node);
 			auto right = getRightChild(node);
-			auto& h1 = calcHash(left, progressCallback);
-			auto& h2 = calcHash(right, progressCallback);
+			auto& h1 = calcHash(left);
+			auto& h2 = calcHash(right);
 			tiger_int(h1, h2, entry.hash[n]);
 		} else {
 			// leaf node
@@ -109,10 +313,7 @@ const TigerHash& TigerTree::calcHash(Node node, const std::function<void(size_t,
 			}
 		}
 		entry.valid[n] = true;
-		entry.numNodesValid++;
-		if (progressCallback) {
-			progressCallback(entry.numNodesValid, entry.numNodes);
-		}
+		entry.modified = true;
 	}
 	return entry.hash[n];
 }
@@ -34,6 +34,7 @@
 #include <cstdint>
 #include <ctime>
 #include <functional>
+#include <vector>
 
 namespace openmsx {
 
@@ -74,10 +75,20 @@ class TigerTree
 public:
 	/** Create TigerTree calculator for the given (abstract) data block
 	 * of given size.
+	 * @param cacheFile When not empty, the (partially) calculated tree
+	 *   is stored in this file on destruction, and it's reloaded from
+	 *   there when the data wasn't modified in the mean time. This way
+	 *   the (expensive) calculation can be skipped in a later session.
 	 */
-	TigerTree(TTData& data, size_t dataSize, const std::string& name);
+	TigerTree(TTData& data, size_t dataSize, const std::string& name,
+	          const std::string& cacheFile = "");
+	~TigerTree();
 
 	/** Calculate the hash value.
+	 * The leaf hashes are calculated in parallel (on multiple threads),
+	 * though the data itself is still only fetched from the calling
+	 * thread. Also the progress callback is only called from the calling
+	 * thread.
 	 */
 	const TigerHash& calcHash(const std::function<void(size_t, size_t)>& progressCallback);
 
@@ -101,10 +112,13 @@ private:
 	Node getLeftChild(Node node) const;
 	Node getRightChild(Node node) const;
 
-	const TigerHash& calcHash(Node node, const std::function<void(size_t, size_t)>& progressCallback);
+	void collectLeaves(Node node, std::vector<size_t>& leaves) const;
+	void hashLeaves(const std::function<void(size_t, size_t)>& progressCallback);
+	const TigerHash& calcHash(Node node);
 
 	TTData& data;
 	const size_t dataSize;
+	const std::string cacheFile;
 	TTCacheEntry& entry;
 };
 
@@ -49,6 +49,12 @@ public:
 	bool operator> (const Sha1Sum& other) const { return  (other <  *this); }
 	bool operator>=(const Sha1Sum& other) const { return !(*this <  other); }
 
+	/** A sha1sum is already uniformly distributed, so (a part of) it can
+	  * directly be used as hash value, e.g. for a hash_map. */
+	struct Hasher {
+		uint32_t operator()(const Sha1Sum& sum) const { return sum.a[0]; }
+	};
+
 	friend std::ostream& operator<<(std::ostream& os, const Sha1Sum& sum) {
 		os << sum.toString();
 		return os;
@@ -222,6 +222,62 @@ void uncompress(const char* input, size_t inLen,
 }
 
 
+bool uncompressChecked(const char* input, size_t inLen,
+                       char* output, size_t outLen)
+{
+	// Same decoding as above, but every length and offset is checked
+	// against the input and output buffers. Reading a few bytes past an
+	// opcode is still fine: it stays within the scratch bytes.
+	if (inLen < SCRATCH_SIZE) return false;
+	const char* ip = input;
+	const char* ipLimit = input + inLen - SCRATCH_SIZE;
+	char* op = output;
+	char* opLimit = output + outLen;
+
+	while (ip < ipLimit) {
+		unsigned char c = *ip++;
+		size_t outLeft = opLimit - op;
+		if ((c & 0x3) == LITERAL) {
+			size_t literalLen = (c >> 2) + 1;
+			if (literalLen >= 61) {
+				size_t literalLenLen = literalLen - 60;
+				literalLen = size_t(loadNBytes(ip, unsigned(literalLenLen))) + 1;
+				ip += literalLenLen;
+				if (ip > ipLimit) return false;
+			}
+			if ((literalLen > size_t(ipLimit - ip)) ||
+			    (literalLen > outLeft)) {
+				return false;
+			}
+			memcpy(op, ip, literalLen);
+			op += literalLen;
+			ip += literalLen;
+		} else {
+			uint32_t entry = charTable[c];
+			unsigned trailerLen = entry >> 11;
+			if (trailerLen > size_t(ipLimit - ip)) return false;
+			uint32_t trailer = loadNBytes(ip, trailerLen);
+			size_t length = entry & 0xff;
+			ip += trailerLen;
+
+			size_t offset = (entry & 0x700) + trailer;
+			if ((offset == 0) || (offset > size_t(op - output)) ||
+			    (length > outLeft)) {
+				return false;
+			}
+			const char* src = op - offset;
+			if (offset >= length) {
+				memcpy(op, src, length);
+			} else {
+				incrementalCopy(src, op, length);
+			}
+			op += length;
+		}
+	}
+	return (ip == ipLimit) && (op == opLimit);
+}
+
+
 /////////////////
 
 // Any hash function will produce a valid compressed bitstream, but a good hash
@@ -52,7 +52,8 @@
 //   would return an error on invalid input, this code will crash on
 //   such input (but that shouldn't happen because we only feed input
 //   that was previously produced by the compression routine (and always
-//   keeping that compressed block in memory).
+//   keeping that compressed block in memory). For input that comes from
+//   a file use uncompressChecked() instead.
 // The motivation for this rewrite is to:
 // - Reduce code duplication between the snappy code and the rest of
 //   openMSX.
@@ -71,6 +72,11 @@ namespace snappy {
 	              char* output, size_t& outLen);
 	void uncompress(const char* input, size_t inLen,
 	                char* output, size_t outLen);
+	/** Like uncompress(), but safe on damaged or crafted input: returns
+	  * false (possibly after writing to 'output') when the input doesn't
+	  * decode to exactly 'outLen' bytes. */
+	bool uncompressChecked(const char* input, size_t inLen,
+	                       char* output, size_t outLen);
 	size_t maxCompressedLength(size_t inLen);
 }
 
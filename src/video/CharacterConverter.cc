@@ -12,7 +12,10 @@ TODO:
 #include "VDPVRAM.hh"
 #include "build-info.hh"
 #include "components.hh"
+#include "likely.hh"
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 
 #ifdef __SSE2__
 #include "emmintrin.h" // SSE2
@@ -26,15 +29,97 @@ CharacterConverter<Pixel>::CharacterConverter(
 	: vdp(vdp_), vram(vdp.getVRAM()), palFg(palFg_), palBg(palBg_)
 {
 	modeBase = 0; // not strictly needed, but avoids Coverity warning
+	generation = 1;
+	std::fill(std::begin(cacheTag), std::end(cacheTag), 0);
+	std::fill(std::begin(textColors), std::end(textColors), 0);
 }
 
 template <class Pixel>
 void CharacterConverter<Pixel>::setDisplayMode(DisplayMode mode)
 {
+	// The layout of the cache depends on the display mode.
+	if (mode.getBase() != modeBase) flushCache();
 	modeBase = mode.getBase();
 	assert(modeBase < 0x0C);
 }
 
+template <class Pixel>
+void CharacterConverter<Pixel>::flushCache()
+{
+	if (unlikely(++generation == 0)) {
+		// Wrapped around, make sure no old entry becomes valid again.
+		std::fill(std::begin(cacheTag), std::end(cacheTag), 0);
+		generation = 1;
+	}
+}
+
+template <class Pixel>
+inline void CharacterConverter<Pixel>::invalidate(unsigned index, unsigned num)
+{
+	// 'generation' is never zero
+	std::fill_n(&cacheTag[index], num, 0);
+}
+
+template <class Pixel>
+void CharacterConverter<Pixel>::updateVRAM(unsigned address)
+{
+	switch (modeBase) {
+	case DisplayMode::GRAPHIC1:
+		if (vram.patternTable.isInside(address)) {
+			invalidate(address & 0x7FF, 1);
+		}
+		if (vram.colorTable.isInside(address)) {
+			// One color byte is shared by 8 characters.
+			unsigned index = address & 0x3F;
+			if (index < 32) invalidate(index * 64, 64);
+		}
+		break;
+	case DisplayMode::GRAPHIC2:
+	case DisplayMode::GRAPHIC3:
+		// When the tables are mirrored, one VRAM address maps to
+		// multiple table positions. That's rare, so then simply
+		// drop the whole cache.
+		if (vram.patternTable.isInside(address)) {
+			if (vram.patternTable.isContinuous(0x1FFF)) {
+				invalidate(address & 0x1FFF, 1);
+			} else {
+				flushCache();
+			}
+		}
+		if (vram.colorTable.isInside(address)) {
+			if (vram.colorTable.isContinuous(0x1FFF)) {
+				invalidate(address & 0x1FFF, 1);
+			} else {
+				flushCache();
+			}
+		}
+		break;
+	case DisplayMode::TEXT1:
+	case DisplayMode::TEXT2:
+		if (vram.patternTable.isInside(address)) {
+			unsigned index = address & 0x7FF;
+			invalidate(index | 0x000, 1);
+			invalidate(index | 0x800, 1); // blinking variant
+		}
+		break;
+	default:
+		// other modes don't use the cache
+		break;
+	}
+}
+
+template <class Pixel>
+inline void CharacterConverter<Pixel>::checkTextColors(
+	Pixel fg0, Pixel bg0, Pixel fg1, Pixel bg1)
+{
+	if ((textColors[0] != fg0) || (textColors[1] != bg0) ||
+	    (textColors[2] != fg1) || (textColors[3] != bg1)) {
+		textColors[0] = fg0; textColors[1] = bg0;
+		textColors[2] = fg1; textColors[3] = bg1;
+		flushCache();
+	}
+}
+
 template <class Pixel>
 void CharacterConverter<Pixel>::convertLine(Pixel* linePtr, int line)
 {
@@ -242,10 +327,12 @@ void CharacterConverter<Pixel>::renderText1(
 {
 	Pixel fg = palFg[vdp.getForegroundColor()];
 	Pixel bg = palFg[vdp.getBackgroundColor()];
+	checkTextColors(fg, bg, fg, bg);
 
 	// 8 * 256 is small enough to always be contiguous
+	unsigned line7 = (line + vdp.getVerticalScroll()) & 7;
 	const byte* patternArea = vram.patternTable.getReadArea(0, 256 * 8);
-	patternArea += (line + vdp.getVerticalScroll()) & 7;
+	patternArea += line7;
 
 	// Note: Because line width is not a power of two, reading an entire line
 	//       from a VRAM pointer returned by readArea will not wrap the index
@@ -254,8 +341,14 @@ void CharacterConverter<Pixel>::renderText1(
 	unsigned nameEnd = nameStart + 40;
 	for (unsigned name = nameStart; name < nameEnd; ++name) {
 		unsigned charcode = vram.nameTable.readNP((name + 0xC00) | (~0u << 12));
-		unsigned pattern = patternArea[charcode * 8];
-		draw6(pixelPtr, fg, bg, pattern);
+		unsigned index = charcode * 8 + line7;
+		if (unlikely(cacheTag[index] != generation)) {
+			Pixel* p = cache[index];
+			draw6(p, fg, bg, patternArea[charcode * 8]);
+			cacheTag[index] = generation;
+		}
+		memcpy(pixelPtr, cache[index], 6 * sizeof(Pixel));
+		pixelPtr += 6;
 	}
 }
 
@@ -298,10 +391,12 @@ void CharacterConverter<Pixel>::renderText2(
 		blinkFg = plainFg;
 		blinkBg = plainBg;
 	}
+	checkTextColors(plainFg, plainBg, blinkFg, blinkBg);
 
 	// 8 * 256 is small enough to always be contiguous
+	unsigned line7 = (line + vdp.getVerticalScroll()) & 7;
 	const byte* patternArea = vram.patternTable.getReadArea(0, 256 * 8);
-	patternArea += (line + vdp.getVerticalScroll()) & 7;
+	patternArea += line7;
 
 	unsigned colorStart = (line / 8) * (80 / 8);
 	unsigned nameStart  = (line / 8) * 80;
@@ -310,38 +405,20 @@ void CharacterConverter<Pixel>::renderText2(
 			(colorStart + i) | (~0u << 9));
 		const byte* nameArea = vram.nameTable.getReadArea(
 			(nameStart + 8 * i) | (~0u << 12), 8);
-		draw6(pixelPtr,
-		      (colorPattern & 0x80) ? blinkFg : plainFg,
-		      (colorPattern & 0x80) ? blinkBg : plainBg,
-		      patternArea[nameArea[0] * 8]);
-		draw6(pixelPtr,
-		      (colorPattern & 0x40) ? blinkFg : plainFg,
-		      (colorPattern & 0x40) ? blinkBg : plainBg,
-		      patternArea[nameArea[1] * 8]);
-		draw6(pixelPtr,
-		      (colorPattern & 0x20) ? blinkFg : plainFg,
-		      (colorPattern & 0x20) ? blinkBg : plainBg,
-		      patternArea[nameArea[2] * 8]);
-		draw6(pixelPtr,
-		      (colorPattern & 0x10) ? blinkFg : plainFg,
-		      (colorPattern & 0x10) ? blinkBg : plainBg,
-		      patternArea[nameArea[3] * 8]);
-		draw6(pixelPtr,
-		      (colorPattern & 0x08) ? blinkFg : plainFg,
-		      (colorPattern & 0x08) ? blinkBg : plainBg,
-		      patternArea[nameArea[4] * 8]);
-		draw6(pixelPtr,
-		      (colorPattern & 0x04) ? blinkFg : plainFg,
-		      (colorPattern & 0x04) ? blinkBg : plainBg,
-		      patternArea[nameArea[5] * 8]);
-		draw6(pixelPtr,
-		      (colorPattern & 0x02) ? blinkFg : plainFg,
-		      (colorPattern & 0x02) ? blinkBg : plainBg,
-		      patternArea[nameArea[6] * 8]);
-		draw6(pixelPtr,
-		      (colorPattern & 0x01) ? blinkFg : plainFg,
-		      (colorPattern & 0x01) ? blinkBg : plainBg,
-		      patternArea[nameArea[7] * 8]);
+		for (unsigned j = 0; j < 8; ++j) {
+			bool blink = ((colorPattern << j) & 0x80) != 0;
+			unsigned charcode = nameArea[j];
+			unsigned index = (blink ? 0x800 : 0) | (charcode * 8) | line7;
+			if (unlikely(cacheTag[index] != generation)) {
+				Pixel* p = cache[index];
+				draw6(p, blink ? blinkFg : plainFg,
+				         blink ? blinkBg : plainBg,
+				         patternArea[charcode * 8]);
+				cacheTag[index] = generation;
+			}
+			memcpy(pixelPtr, cache[index], 6 * sizeof(Pixel));
+			pixelPtr += 6;
+		}
 	}
 }
 
@@ -353,51 +430,48 @@ const byte* CharacterConverter<Pixel>::getNamePtr(int line, int scroll)
 	return vram.nameTable.getReadArea(
 		((line / 8) * 32) | ((scroll & 0x20) ? 0x8000 : 0), 32);
 }
+template <class Pixel>
+inline void CharacterConverter<Pixel>::fillCache8(
+	unsigned index, Pixel fg, Pixel bg, byte pattern)
+{
+	// Cache entries are always aligned, so no need for the 'partial'
+	// administration of draw8().
+	Pixel* p = cache[index];
+	uint32_t dummy = 0;
+	draw8(p, fg, bg, pattern, false, dummy);
+	cacheTag[index] = generation;
+}
+
 template <class Pixel>
 void CharacterConverter<Pixel>::renderGraphic1(
 	Pixel* __restrict pixelPtr, int line)
 {
-	bool misAligned = false; // initialize with dummy
-	uint32_t partial = 0;    // values to avoid warning
-#ifdef __arm__
-	misAligned = sizeof(Pixel) == 2 && (reinterpret_cast<uintptr_t>(pixelPtr) & 3);
-	if (misAligned) pixelPtr--;
-	partial = *pixelPtr;
-#endif
-
+	unsigned line7 = line & 7;
 	const byte* patternArea = vram.patternTable.getReadArea(0, 256 * 8);
-	patternArea += line & 7;
+	patternArea += line7;
 	const byte* colorArea = vram.colorTable.getReadArea(0, 256 / 8);
 
 	int scroll = vdp.getHorizontalScrollHigh();
 	const byte* namePtr = getNamePtr(line, scroll);
 	for (unsigned n = 0; n < 32; ++n) {
 		unsigned charcode = namePtr[scroll & 0x1F];
-		unsigned pattern = patternArea[charcode * 8];
-		unsigned color = colorArea[charcode / 8];
-		Pixel fg = palFg[color >> 4];
-		Pixel bg = palFg[color & 0x0F];
-		draw8(pixelPtr, fg, bg, pattern, misAligned, partial);
+		unsigned index = charcode * 8 + line7;
+		if (unlikely(cacheTag[index] != generation)) {
+			unsigned pattern = patternArea[charcode * 8];
+			unsigned color = colorArea[charcode / 8];
+			fillCache8(index, palFg[color >> 4], palFg[color & 0x0F],
+			           pattern);
+		}
+		memcpy(pixelPtr, cache[index], 8 * sizeof(Pixel));
+		pixelPtr += 8;
 		if (!(++scroll & 0x1F)) namePtr = getNamePtr(line, scroll);
 	}
-
-#ifdef __arm__
-	if (misAligned) *pixelPtr = static_cast<Pixel>(partial);
-#endif
 }
 
 template <class Pixel>
 void CharacterConverter<Pixel>::renderGraphic2(
 	Pixel* __restrict pixelPtr, int line)
 {
-	bool misAligned = false; // initialize with dummy
-	uint32_t partial = 0;    // values to avoid warning
-#ifdef __arm__
-	misAligned = sizeof(Pixel) == 2 && (reinterpret_cast<uintptr_t>(pixelPtr) & 3);
-	if (misAligned) pixelPtr--;
-	partial = *pixelPtr;
-#endif
-
 	int quarter8 = (((line / 8) * 32) & ~0xFF) * 8;
 	int line7 = line & 7;
 	int scroll = vdp.getHorizontalScrollHigh();
@@ -413,11 +487,15 @@ void CharacterConverter<Pixel>::renderGraphic2(
 		const byte* colorArea   = vram.colorTable  .getReadArea(quarter8, 8 * 256) + line7;
 		for (unsigned n = 0; n < 32; ++n) {
 			unsigned charCode8 = namePtr[n] * 8;
-			unsigned pattern = patternArea[charCode8];
-			unsigned color   = colorArea  [charCode8];
-			Pixel fg = palFg[color >> 4];
-			Pixel bg = palFg[color & 0x0F];
-			draw8(pixelPtr, fg, bg, pattern, misAligned, partial);
+			unsigned index = quarter8 | charCode8 | line7;
+			if (unlikely(cacheTag[index] != generation)) {
+				unsigned pattern = patternArea[charCode8];
+				unsigned color   = colorArea  [charCode8];
+				fillCache8(index, palFg[color >> 4],
+				           palFg[color & 0x0F], pattern);
+			}
+			memcpy(pixelPtr, cache[index], 8 * sizeof(Pixel));
+			pixelPtr += 8;
 		}
 	} else {
 		// Slower variant, also works when:
@@ -428,18 +506,18 @@ void CharacterConverter<Pixel>::renderGraphic2(
 		for (unsigned n = 0; n < 32; ++n) {
 			unsigned charCode8 = namePtr[scroll & 0x1F] * 8;
 			unsigned index = charCode8 | baseLine;
-			unsigned pattern = vram.patternTable.readNP(index);
-			unsigned color   = vram.colorTable  .readNP(index);
-			Pixel fg = palFg[color >> 4];
-			Pixel bg = palFg[color & 0x0F];
-			draw8(pixelPtr, fg, bg, pattern, misAligned, partial);
+			unsigned cacheIndex = index & (CACHE_SIZE - 1);
+			if (unlikely(cacheTag[cacheIndex] != generation)) {
+				unsigned pattern = vram.patternTable.readNP(index);
+				unsigned color   = vram.colorTable  .readNP(index);
+				fillCache8(cacheIndex, palFg[color >> 4],
+				           palFg[color & 0x0F], pattern);
+			}
+			memcpy(pixelPtr, cache[cacheIndex], 8 * sizeof(Pixel));
+			pixelPtr += 8;
 			if (!(++scroll & 0x1F)) namePtr = getNamePtr(line, scroll);
 		}
 	}
-
-#ifdef __arm__
-	if (misAligned) *pixelPtr = static_cast<Pixel>(partial);
-#endif
 }
 
 template <class Pixel>
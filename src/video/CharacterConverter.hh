@@ -2,6 +2,7 @@
 #define CHARACTERCONVERTER_HH
 
 #include "openmsx.hh"
+#include "aligned.hh"
 
 namespace openmsx {
 
@@ -41,6 +42,18 @@ public:
 	  */
 	void setDisplayMode(DisplayMode mode);
 
+	/** Inform this class about a VRAM write (just before it is committed).
+	  * Cached pattern lines that depend on that address are invalidated.
+	  * @param address The VRAM address that will change.
+	  */
+	void updateVRAM(unsigned address);
+
+	/** Invalidate all cached pattern lines. Must be called when the
+	  * palette changes, or when the VRAM changes in another way than
+	  * through updateVRAM() (e.g. table base changes).
+	  */
+	void flushCache();
+
 private:
 	inline void renderText1   (Pixel* pixelPtr, int line);
 	inline void renderText1Q  (Pixel* pixelPtr, int line);
@@ -55,6 +68,9 @@ private:
 	                       int mask, int patternQuarter);
 
 	const byte* getNamePtr(int line, int scroll);
+	inline void invalidate(unsigned index, unsigned num);
+	inline void fillCache8(unsigned index, Pixel fg, Pixel bg, byte pattern);
+	inline void checkTextColors(Pixel fg0, Pixel bg0, Pixel fg1, Pixel bg1);
 
 	VDP& vdp;
 	VDPVRAM& vram;
@@ -63,6 +79,23 @@ private:
 	const Pixel* const palBg;
 
 	unsigned modeBase;
+
+	/** Cache of converted pattern lines (8 host pixels per entry, text
+	  * modes only use 6). Indexed by the position of the line in the
+	  * pattern table (Graphic 1, Text 1/2) or in the pattern and color
+	  * table (Graphic 2/3). In Text 2 mode the blink attribute selects
+	  * the upper half of the cache. An entry is valid when its tag equals
+	  * the current generation.
+	  */
+	static const unsigned CACHE_SIZE = 0x2000;
+	ALIGNED(Pixel cache[CACHE_SIZE][8], 16)
+	unsigned cacheTag[CACHE_SIZE];
+	unsigned generation;
+
+	/** Text mode colors (foreground and background for normal and
+	  * blinking characters) the cached text mode entries are drawn with.
+	  */
+	Pixel textColors[4];
 };
 
 } // namespace openmsx
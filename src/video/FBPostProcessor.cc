@@ -6,6 +6,8 @@
 #include "Scaler.hh"
 #include "ScalerFactory.hh"
 #include "OutputSurface.hh"
+#include "SDLOffScreenSurface.hh"
+#include "Display.hh"
 #include "IntegerSetting.hh"
 #include "FloatSetting.hh"
 #include "BooleanSetting.hh"
@@ -14,10 +16,12 @@
 #include "aligned.hh"
 #include "random.hh"
 #include "xrange.hh"
+#include "memory.hh"
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #ifdef __SSE2__
 #include <emmintrin.h>
 #endif
@@ -240,6 +244,12 @@ FBPostProcessor<Pixel>::FBPostProcessor(MSXMotherBoard& motherBoard_,
 		canDoInterlace_)
 	, noiseShift(screen.getHeight())
 	, pixelOps(screen.getSDLFormat())
+	, scaleHorStretch(0.0f)
+	, scaleRequested(false)
+	, scaleQuit(false)
+	, frameCounter(0)
+	, scaledFrame(0)
+	, scaledValid(false)
 {
 	scaleAlgorithm = RenderSettings::NO_SCALER;
 	scaleFactor = unsigned(-1);
@@ -253,6 +263,14 @@ FBPostProcessor<Pixel>::FBPostProcessor(MSXMotherBoard& motherBoard_,
 template <class Pixel>
 FBPostProcessor<Pixel>::~FBPostProcessor()
 {
+	if (scaleThread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(scaleMutex);
+			scaleQuit = true;
+		}
+		scaleCond.notify_all();
+		scaleThread.join();
+	}
 	renderSettings.getNoiseSetting().detach(*this);
 }
 
@@ -269,6 +287,9 @@ void FBPostProcessor<Pixel>::paint(OutputSurface& output)
 
 	if (!paintFrame) return;
 
+	// Don't change the scaler while the scale thread is using it.
+	waitScaleThread();
+
 	// New scaler algorithm selected?
 	auto algo = renderSettings.getScaleAlgorithm();
 	unsigned factor = renderSettings.getScaleFactor();
@@ -278,9 +299,57 @@ void FBPostProcessor<Pixel>::paint(OutputSurface& output)
 		currScaler = ScalerFactory<Pixel>::createScaler(
 			PixelOperations<Pixel>(output.getSDLFormat()),
 			renderSettings);
+		scaledValid = false;
+	}
+	// The scale thread doesn't read the settings itself, see
+	// Scaler::updateSettings().
+	currScaler->updateSettings();
+
+	float horStretch = renderSettings.getHorizontalStretch();
+	// Superimposed frames belong to other post processors, those can
+	// change at any time. Laserdisc (!canDoInterlace) immediately
+	// recycles the painted frame.
+	bool pipeline = renderSettings.getRenderPipeline() && canDoInterlace &&
+	                !superImposeVideoFrame && !superImposeVdpFrame &&
+	                (&output == &screen);
+	if (pipeline) {
+		if (!scaledSurface) {
+			// Use the pixel format of the output, for SDLGL-FBxx
+			// that's different from the format of the SDL surface.
+			SDL_PixelFormat format = output.getSDLFormat();
+			SDL_Surface proto = *output.getSDLSurface();
+			proto.format = &format;
+			scaledSurface = make_unique<SDLOffScreenSurface>(proto);
+			scaledValid = false;
+		}
+		if (!scaledValid) {
+			scaleFrame(*scaledSurface, horStretch, nullptr);
+			scaledFrame = frameCounter;
+			scaledValid = true;
+		}
+		copyScaledFrame(output);
+		if (scaledFrame != frameCounter) {
+			// Scale the new frame in the background, it will be
+			// shown on the next paint. Make sure there is a next
+			// paint, also when the emulation is paused.
+			scaledFrame = frameCounter;
+			startScaleThread(horStretch);
+			getDisplay().repaintDelayed(100 * 1000); // 10fps
+		}
+	} else {
+		scaledSurface.reset();
+		scaleFrame(output, horStretch, superImposeVideoFrame);
 	}
 
-	// Scale image.
+	drawNoise(output);
+
+	output.flushFrameBuffer(); // for SDLGL-FBxx
+}
+
+template <class Pixel>
+void FBPostProcessor<Pixel>::scaleFrame(
+	OutputSurface& output, float horStretch, const RawFrame* superImpose)
+{
 	const unsigned srcHeight = paintFrame->getHeight();
 	const unsigned dstHeight = output.getHeight();
 
@@ -311,13 +380,12 @@ void FBPostProcessor<Pixel>::paint(OutputSurface& output)
 		//fprintf(stderr, "post processing lines %d-%d: %d\n",
 		//	srcStartY, srcEndY, lineWidth );
 		output.lock();
-		float horStretch = renderSettings.getHorizontalStretch();
 		unsigned inWidth = unsigned(horStretch + 0.5f);
 		std::unique_ptr<ScalerOutput<Pixel>> dst(
 			StretchScalerOutputFactory<Pixel>::create(
 				output, pixelOps, inWidth));
 		currScaler->scaleImage(
-			*paintFrame, superImposeVideoFrame,
+			*paintFrame, superImpose,
 			srcStartY, srcEndY, lineWidth, // source
 			*dst, dstStartY, dstEndY); // dest
 
@@ -325,16 +393,74 @@ void FBPostProcessor<Pixel>::paint(OutputSurface& output)
 		srcStartY = srcEndY;
 		dstStartY = dstEndY;
 	}
+}
 
-	drawNoise(output);
+template <class Pixel>
+void FBPostProcessor<Pixel>::copyScaledFrame(OutputSurface& output)
+{
+	assert(output.getWidth()  == scaledSurface->getWidth());
+	assert(output.getHeight() == scaledSurface->getHeight());
+	unsigned w = output.getWidth();
+	output.lock();
+	scaledSurface->lock();
+	for (auto y : xrange(output.getHeight())) {
+		memcpy(output.getLinePtrDirect<Pixel>(y),
+		       scaledSurface->getLinePtrDirect<Pixel>(y),
+		       w * sizeof(Pixel));
+	}
+}
 
-	output.flushFrameBuffer(); // for SDLGL-FBxx
+template <class Pixel>
+void FBPostProcessor<Pixel>::startScaleThread(float horStretch)
+{
+	if (!scaleThread.joinable()) {
+		scaleThread = std::thread([this]() { scaleThreadMain(); });
+	}
+	{
+		std::lock_guard<std::mutex> lock(scaleMutex);
+		assert(!scaleRequested);
+		scaleHorStretch = horStretch;
+		scaleRequested = true;
+	}
+	scaleCond.notify_all();
+}
+
+template <class Pixel>
+void FBPostProcessor<Pixel>::waitScaleThread()
+{
+	std::unique_lock<std::mutex> lock(scaleMutex);
+	scaleCond.wait(lock, [&]() { return !scaleRequested; });
+}
+
+template <class Pixel>
+void FBPostProcessor<Pixel>::scaleThreadMain()
+{
+	std::unique_lock<std::mutex> lock(scaleMutex);
+	while (true) {
+		scaleCond.wait(lock, [&]() { return scaleRequested || scaleQuit; });
+		if (scaleQuit) return;
+		float horStretch = scaleHorStretch;
+		lock.unlock();
+		// Only reads the frames in lastFrames[] (and objects that
+		// refer to them), those remain unchanged until the next call
+		// to rotateFrames(), and that waits for us. Settings are not
+		// read: horStretch and the values copied into the scaler
+		// (in paint()) were taken when this frame was queued.
+		scaleFrame(*scaledSurface, horStretch, nullptr);
+		lock.lock();
+		scaleRequested = false;
+		scaleCond.notify_all();
+	}
 }
 
 template <class Pixel>
 std::unique_ptr<RawFrame> FBPostProcessor<Pixel>::rotateFrames(
 	std::unique_ptr<RawFrame> finishedFrame, EmuTime::param time)
 {
+	// The scale thread might still be reading the current frames.
+	waitScaleThread();
+	++frameCounter;
+
 	auto& generator = global_urng(); // fast (non-cryptographic) random numbers
 	std::uniform_int_distribution<int> distribution(0, NOISE_SHIFT / 16 - 1);
 	for (auto y : xrange(screen.getHeight())) {
@@ -4,6 +4,9 @@
 #include "PostProcessor.hh"
 #include "RenderSettings.hh"
 #include "PixelOperations.hh"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace openmsx {
@@ -31,6 +34,13 @@ public:
 		std::unique_ptr<RawFrame> finishedFrame, EmuTime::param time) override;
 
 private:
+	void scaleFrame(OutputSurface& output, float horStretch,
+	                const RawFrame* superImpose);
+	void copyScaledFrame(OutputSurface& output);
+	void startScaleThread(float horStretch);
+	void waitScaleThread();
+	void scaleThreadMain();
+
 	void preCalcNoise(float factor);
 	void drawNoise(OutputSurface& output);
 	void drawNoiseLine(Pixel* buf, signed char* noise,
@@ -56,6 +66,25 @@ private:
 	std::vector<unsigned> noiseShift;
 
 	PixelOperations<Pixel> pixelOps;
+
+	/** When the "render_pipeline" setting is enabled, a frame is scaled
+	  * into this off-screen surface by 'scaleThread' while the emulation
+	  * continues. It gets copied to the output on the next paint().
+	  */
+	std::unique_ptr<OutputSurface> scaledSurface;
+	std::thread scaleThread;
+	std::mutex scaleMutex;
+	std::condition_variable scaleCond;
+	float scaleHorStretch;  // parameter for the scale thread
+	bool scaleRequested;    // the scale thread is (about to start) working
+	bool scaleQuit;         // the scale thread should stop
+	// the members above are protected by 'scaleMutex'
+
+	/** Incremented for each new frame (in rotateFrames()). */
+	unsigned frameCounter;
+	/** Value of 'frameCounter' for the frame in 'scaledSurface'. */
+	unsigned scaledFrame;
+	bool scaledValid;
 };
 
 } // namespace openmsx
@@ -179,8 +179,10 @@ void PixelRenderer::frameStart(EmuTime::param time)
 			if (rasterizer->isRecording()) {
 				renderFrame = true;
 			} else {
-				renderFrame = realTime.timeLeft(
-					unsigned(finishFrameDuration), time);
+				// Skip as many frames as the governor asks for,
+				// and more when we're still lagging behind.
+				renderFrame = (frameSkipCounter > int(realTime.getFrameSkip())) &&
+				               realTime.timeLeft(unsigned(finishFrameDuration), time);
 			}
 			if (renderFrame) {
 				frameSkipCounter = 0;
@@ -496,14 +498,20 @@ void PixelRenderer::updateVRAM(unsigned offset, EmuTime::param time)
 		//	vdp.getTicksThisFrame(time) / VDP::TICKS_PER_LINE);
 		renderUntil(time);
 	}
+	// Also when not rendering this frame, otherwise cached pattern data
+	// could get out of date.
+	rasterizer->updateVRAMCache(offset);
 }
 
 void PixelRenderer::updateWindow(bool /*enabled*/, EmuTime::param /*time*/)
 {
-	// The bitmapVisibleWindow has moved to a different area.
-	// This update is redundant: Renderer will be notified in another way
-	// as well (updateDisplayEnabled or updateNameBase, for example).
+	// The bitmapVisibleWindow, the color table or the pattern table has
+	// moved to a different area (or the VRAM content was rearranged).
+	// For rendering this update is redundant: Renderer will be notified
+	// in another way as well (updateDisplayEnabled or updateNameBase, for
+	// example). But the cached pattern data is no longer valid.
 	// TODO: Can this be used as the main update method instead?
+	rasterizer->flushVRAMCache();
 }
 
 void PixelRenderer::sync(EmuTime::param time, bool force)
@@ -9,6 +9,7 @@
 #include "RenderSettings.hh"
 #include "RawFrame.hh"
 #include "AviRecorder.hh"
+#include "SharedMemoryExporter.hh"
 #include "CliComm.hh"
 #include "MSXMotherBoard.hh"
 #include "Reactor.hh"
@@ -35,14 +36,15 @@ PostProcessor::PostProcessor(MSXMotherBoard& motherBoard_,
 	, screen(screen_)
 	, paintFrame(nullptr)
 	, recorder(nullptr)
+	, exporter(nullptr)
 	, superImposeVideoFrame(nullptr)
 	, superImposeVdpFrame(nullptr)
 	, interleaveCount(0)
 	, lastFramesCount(0)
 	, maxWidth(maxWidth_)
 	, height(height_)
-	, display(display_)
 	, canDoInterlace(canDoInterlace_)
+	, display(display_)
 	, lastRotate(motherBoard_.getCurrentTime())
 	, eventDistributor(motherBoard_.getReactor().getEventDistributor())
 {
@@ -73,6 +75,9 @@ PostProcessor::~PostProcessor()
 			"during recording.");
 		recorder->stop();
 	}
+	if (exporter) {
+		exporter->stop();
+	}
 }
 
 CliComm& PostProcessor::getCliComm()
@@ -190,6 +195,9 @@ std::unique_ptr<RawFrame> PostProcessor::rotateFrames(
 			assert(!recorder);
 		}
 	}
+	if (exporter && needRecord()) {
+		exporter->addImage(paintFrame, time);
+	}
 
 	// Return recycled frame to the caller
 	if (canDoInterlace) {
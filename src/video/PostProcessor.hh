@@ -18,6 +18,7 @@ class DoubledFrame;
 class Deflicker;
 class SuperImposedFrame;
 class AviRecorder;
+class SharedMemoryExporter;
 class CliComm;
 class EventDistributor;
 
@@ -76,6 +77,12 @@ public:
 	  */
 	bool isRecording() const { return recorder != nullptr; }
 
+	/** Start/stop exporting frames to shared memory.
+	  * @param exporter_ Finished frames are also pushed to this
+	  *                  SharedMemoryExporter. Can be nullptr.
+	  */
+	void setExporter(SharedMemoryExporter* exporter_) { exporter = exporter_; }
+
 	/** Get the number of bits per pixel for the pixels in these frames.
 	  * @return Possible values are 15, 16 or 32
 	  */
@@ -103,6 +110,8 @@ protected:
 		OutputSurface& screen, const std::string& videoSource,
 		unsigned maxWidth, unsigned height, bool canDoInterlace);
 
+	Display& getDisplay() { return display; }
+
 	/** Render settings */
 	RenderSettings& renderSettings;
 
@@ -133,6 +142,9 @@ protected:
 	/** Video recorder, nullptr when not recording. */
 	AviRecorder* recorder;
 
+	/** Shared memory exporter, nullptr when not exporting. */
+	SharedMemoryExporter* exporter;
+
 	/** Video frame on which to superimpose the (VDP) output.
 	  * nullptr when not superimposing. */
 	const RawFrame* superImposeVideoFrame;
@@ -143,18 +155,18 @@ protected:
 	int maxWidth; // we lazily create RawFrame objects in lastFrames[]
 	int height;   // these two vars remember how big those should be
 
-private:
-	// Schedulable
-	void executeUntil(EmuTime::param time) override;
-
-	Display& display;
-
 	/** Laserdisc cannot do interlace (better: the current implementation
 	  * is not interlaced). In that case some internal stuff can be done
 	  * with less buffers.
 	  */
 	const bool canDoInterlace;
 
+private:
+	// Schedulable
+	void executeUntil(EmuTime::param time) override;
+
+	Display& display;
+
 	EmuTime lastRotate;
 	EventDistributor& eventDistributor;
 };
@@ -104,6 +104,17 @@ public:
 	  */
 	virtual bool isRecording() const = 0;
 
+	/** Informs the rasterizer that a VRAM address is about to change.
+	  * Cached data that was derived from this address must be dropped.
+	  * @param address The VRAM address that will change.
+	  */
+	virtual void updateVRAMCache(unsigned address) = 0;
+
+	/** Drop all cached data that was derived from VRAM content. Called
+	  * when the VRAM tables move or when VRAM changes in bulk.
+	  */
+	virtual void flushVRAMCache() = 0;
+
 protected:
 	Rasterizer() {}
 };
@@ -186,6 +186,15 @@ RenderSettings::RenderSettings(CommandController& commandController)
 		"Useful on (100Hz+) lightboost enabled monitors to reduce "
 		"motion blur and double frame artifacts.",
 		false)
+
+	, renderPipelineSetting(commandController,
+		"render_pipeline",
+		"Scale the MSX frames on a separate thread, in parallel with "
+		"the emulation. This reduces the time the emulation waits for "
+		"rendering, at the cost of one frame extra display latency. "
+		"This setting only has effect for the SDL and SDLGL-FBxx "
+		"renderers.",
+		false)
 {
 	brightnessSetting.attach(*this);
 	contrastSetting  .attach(*this);
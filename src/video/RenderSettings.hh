@@ -169,6 +169,11 @@ public:
 		return interleaveBlackFrameSetting.getBoolean();
 	}
 
+	/** Scale frames on a separate thread (one frame extra latency)? */
+	bool getRenderPipeline() const {
+		return renderPipelineSetting.getBoolean();
+	}
+
 	/** Apply brightness, contrast and gamma transformation on the input
 	  * color component. The component is expected to be in the range
 	  * [0.0 .. 1.0] but it's not an error if it lays outside of this range.
@@ -225,6 +230,7 @@ private:
 	FloatSetting horizontalStretchSetting;
 	FloatSetting pointerHideDelaySetting;
 	BooleanSetting interleaveBlackFrameSetting;
+	BooleanSetting renderPipelineSetting;
 
 	float brightness;
 	float contrast;
@@ -129,6 +129,7 @@ void SDLRasterizer<Pixel>::reset()
 	// Init renderer state.
 	setDisplayMode(vdp.getDisplayMode());
 	spriteConverter.setTransparency(vdp.getTransparency());
+	characterConverter.flushCache();
 
 	resetPalette();
 }
@@ -246,6 +247,7 @@ void SDLRasterizer<Pixel>::setPalette(int index, int grb)
 	palFg[index + 16] = newColor;
 	palBg[index     ] = newColor;
 	bitmapConverter.palette16Changed();
+	characterConverter.flushCache();
 
 	precalcColorIndex0(vdp.getDisplayMode(), vdp.getTransparency(),
 	                   vdp.isSuperimposing(), vdp.getBackgroundColor());
@@ -410,6 +412,7 @@ void SDLRasterizer<Pixel>::precalcColorIndex0(DisplayMode mode,
 		if (palFg[0] != c) {
 			palFg[0] = c;
 			bitmapConverter.palette16Changed();
+			characterConverter.flushCache();
 		}
 	} else {
 		// TODO: superimposing
@@ -418,6 +421,7 @@ void SDLRasterizer<Pixel>::precalcColorIndex0(DisplayMode mode,
 			palFg[ 0] = palBg[tpIndex >> 2];
 			palFg[16] = palBg[tpIndex &  3];
 			bitmapConverter.palette16Changed();
+			characterConverter.flushCache();
 		}
 	}
 }
@@ -675,6 +679,18 @@ bool SDLRasterizer<Pixel>::isRecording() const
 	return postProcessor->isRecording();
 }
 
+template <class Pixel>
+void SDLRasterizer<Pixel>::updateVRAMCache(unsigned address)
+{
+	characterConverter.updateVRAM(address);
+}
+
+template <class Pixel>
+void SDLRasterizer<Pixel>::flushVRAMCache()
+{
+	characterConverter.flushCache();
+}
+
 template <class Pixel>
 void SDLRasterizer<Pixel>::update(const Setting& setting)
 {
@@ -684,6 +700,7 @@ void SDLRasterizer<Pixel>::update(const Setting& setting)
 	    (&setting == &renderSettings.getColorMatrixSetting())) {
 		precalcPalette();
 		resetPalette();
+		characterConverter.flushCache();
 	}
 }
 
@@ -61,6 +61,8 @@ public:
 		int displayX, int displayY,
 		int displayWidth, int displayHeight) override;
 	bool isRecording() const override;
+	void updateVRAMCache(unsigned address) override;
+	void flushVRAMCache() override;
 
 private:
 	inline void renderBitmapLine(Pixel* buf, unsigned vramLine);
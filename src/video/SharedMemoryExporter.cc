@@ -0,0 +1,406 @@
+#include "SharedMemoryExporter.hh"
+#include "Reactor.hh"
+#include "MSXMotherBoard.hh"
+#include "CommandException.hh"
+#include "Display.hh"
+#include "PostProcessor.hh"
+#include "FrameSource.hh"
+#include "MSXMixer.hh"
+#include "TclObject.hh"
+#include "StringOp.hh"
+#include "outer.hh"
+#include "unreachable.hh"
+#include "build-info.hh"
+#include <SDL.h>
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using std::string;
+using std::vector;
+
+namespace openmsx {
+
+static const unsigned DEFAULT_SLOTS = 4;
+static const unsigned MAX_SLOTS = 64;
+
+// Pixel data starts on a cache line boundary.
+static const size_t DATA_ALIGN = 64;
+static size_t alignUp(size_t n) { return (n + DATA_ALIGN - 1) & ~(DATA_ALIGN - 1); }
+static const size_t HEADER_SIZE = alignUp(sizeof(SharedMemoryExporter::Header));
+static const size_t SLOT_HEADER_SIZE = alignUp(sizeof(SharedMemoryExporter::SlotHeader));
+
+SharedMemoryExporter::SharedMemoryExporter(Reactor& reactor_)
+	: reactor(reactor_)
+	, shmCommand(reactor.getCommandController())
+	, mixer(nullptr)
+	, mapping(nullptr)
+	, mappingSize(0)
+	, frameCount(0)
+{
+}
+
+SharedMemoryExporter::~SharedMemoryExporter()
+{
+	assert(shmName.empty());
+}
+
+void SharedMemoryExporter::start(const string& name, unsigned width,
+                                 unsigned height, unsigned numSlots,
+                                 bool exportAudio)
+{
+#ifdef _WIN32
+	(void)name; (void)width; (void)height; (void)numSlots; (void)exportAudio;
+	throw CommandException(
+		"Shared memory export is not supported on this platform.");
+#else
+	stop();
+	MSXMotherBoard* motherBoard = reactor.getMotherBoard();
+	if (!motherBoard) {
+		throw CommandException("No active MSX machine.");
+	}
+	// Same as for the record command: only the active video source will
+	// actually send frames.
+	vector<PostProcessor*> newPostProcessors;
+	for (auto* l : reactor.getDisplay().getAllLayers()) {
+		if (auto* pp = dynamic_cast<PostProcessor*>(l)) {
+			newPostProcessors.push_back(pp);
+		}
+	}
+	if (newPostProcessors.empty()) {
+		throw CommandException(
+			"Current renderer doesn't support shared memory export.");
+	}
+	// any source is fine because they all have the same bpp
+	unsigned bpp = newPostProcessors.front()->getBpp();
+	unsigned pixelSize = (bpp == 32) ? 4 : 2;
+	unsigned pitch = width * pixelSize;
+
+	MSXMixer* newMixer = exportAudio ? &motherBoard->getMSXMixer() : nullptr;
+	unsigned sampleRate = newMixer ? newMixer->getSampleRate() : 0;
+	// Room for 200ms of audio per frame, that's plenty even when frames
+	// are skipped.
+	unsigned maxSamples = sampleRate / 5;
+
+	size_t slotSize = alignUp(SLOT_HEADER_SIZE + height * pitch +
+	                          maxSamples * 2 * sizeof(int16_t));
+	size_t size = HEADER_SIZE + numSlots * slotSize;
+
+	int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd == -1) {
+		throw CommandException(
+			"Couldn't create shared memory object " + name + ": " +
+			strerror(errno));
+	}
+	void* ptr = MAP_FAILED;
+	if (ftruncate(fd, size) == 0) {
+		ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+		           fd, 0);
+	}
+	int error = errno;
+	close(fd); // the mapping stays valid
+	if (ptr == MAP_FAILED) {
+		shm_unlink(name.c_str());
+		throw CommandException(
+			"Couldn't map shared memory object " + name + ": " +
+			strerror(error));
+	}
+
+	// only change state when all errors are checked for
+	shmName = name;
+	mapping = static_cast<uint8_t*>(ptr);
+	mappingSize = size;
+	frameCount = 0;
+	audioBuf.clear();
+
+	auto* header = new (mapping) Header();
+	header->headerSize = HEADER_SIZE;
+	header->numSlots = numSlots;
+	header->slotSize = slotSize;
+	header->width = width;
+	header->height = height;
+	header->bpp = bpp;
+	header->pitch = pitch;
+	header->redMask = header->greenMask = header->blueMask = 0; // 1st frame
+	header->sampleRate = sampleRate;
+	header->maxSamples = maxSamples;
+	header->emuTimeFreq = MAIN_FREQ;
+	header->seq.store(0, std::memory_order_relaxed);
+	for (unsigned i = 0; i < numSlots; ++i) {
+		auto* slot = new (mapping + HEADER_SIZE + i * slotSize) SlotHeader();
+		slot->seq.store(0, std::memory_order_relaxed);
+	}
+	// The magic is written last, consumers can poll for it.
+	std::atomic_thread_fence(std::memory_order_release);
+	memcpy(header->magic, "oMSXshm1", sizeof(header->magic));
+
+	postProcessors = std::move(newPostProcessors);
+	for (auto* pp : postProcessors) {
+		pp->setExporter(this);
+	}
+	mixer = newMixer;
+	if (mixer) mixer->setExporter(this);
+#endif
+}
+
+void SharedMemoryExporter::stop()
+{
+	for (auto* pp : postProcessors) {
+		pp->setExporter(nullptr);
+	}
+	postProcessors.clear();
+	if (mixer) {
+		mixer->setExporter(nullptr);
+		mixer = nullptr;
+	}
+	if (shmName.empty()) return;
+#ifndef _WIN32
+	// Consumers that still have the object mapped keep on seeing the
+	// last frames, new consumers can't open it anymore.
+	munmap(mapping, mappingSize);
+	shm_unlink(shmName.c_str());
+#endif
+	mapping = nullptr;
+	mappingSize = 0;
+	shmName.clear();
+}
+
+void SharedMemoryExporter::addWave(unsigned num, int16_t* data)
+{
+	// The mixer always produces stereo samples.
+	audioBuf.insert(end(audioBuf), data, data + 2 * num);
+}
+
+template<typename Pixel>
+void SharedMemoryExporter::copyFrame(FrameSource& frame, uint8_t* dst)
+{
+	auto* header = reinterpret_cast<Header*>(mapping);
+	for (unsigned y = 0; y < header->height; ++y) {
+		auto* buf = reinterpret_cast<Pixel*>(dst);
+		const Pixel* line;
+		switch (header->height) {
+		case 240:
+			line = frame.getLinePtr320_240(y, buf);
+			break;
+		case 480:
+			line = frame.getLinePtr640_480(y, buf);
+			break;
+		case 720:
+			line = frame.getLinePtr960_720(y, buf);
+			break;
+		default:
+			UNREACHABLE; line = nullptr;
+		}
+		// Often the line is scaled directly into the shared memory,
+		// only copy when an internal buffer was returned.
+		if (line != buf) memcpy(buf, line, header->pitch);
+		dst += header->pitch;
+	}
+}
+
+void SharedMemoryExporter::addImage(FrameSource* frame, EmuTime::param time)
+{
+	assert(mapping);
+	auto* header = reinterpret_cast<Header*>(mapping);
+	uint64_t seq = ++frameCount;
+	uint8_t* slotPtr = mapping + header->headerSize +
+	                   (seq % header->numSlots) * size_t(header->slotSize);
+	auto* slot = reinterpret_cast<SlotHeader*>(slotPtr);
+
+	if (header->redMask == 0) {
+		const auto& format = frame->getSDLPixelFormat();
+		header->redMask   = format.Rmask;
+		header->greenMask = format.Gmask;
+		header->blueMask  = format.Bmask;
+	}
+
+	// Mark the slot as 'being written'.
+	slot->seq.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	uint8_t* pixels = slotPtr + SLOT_HEADER_SIZE;
+	switch (header->bpp) {
+#if HAVE_16BPP
+	case 15:
+	case 16:
+		copyFrame<uint16_t>(*frame, pixels);
+		break;
+#endif
+#if HAVE_32BPP
+	case 32:
+		copyFrame<uint32_t>(*frame, pixels);
+		break;
+#endif
+	default:
+		UNREACHABLE;
+	}
+
+	unsigned samples = 0;
+	unsigned dropped = 0;
+	if (mixer) {
+		mixer->updateStream(time);
+		unsigned available = unsigned(audioBuf.size() / 2);
+		samples = std::min(available, header->maxSamples);
+		dropped = available - samples;
+		memcpy(pixels + header->height * header->pitch, audioBuf.data(),
+		       samples * 2 * sizeof(int16_t));
+		audioBuf.clear();
+	}
+	slot->emuTime = (time - EmuTime::zero).length();
+	slot->numSamples = samples;
+	slot->droppedSamples = dropped;
+
+	// Publish.
+	slot->seq.store(seq, std::memory_order_release);
+	header->seq.store(seq, std::memory_order_release);
+}
+
+void SharedMemoryExporter::processStart(array_ref<TclObject> tokens, TclObject& result)
+{
+	string name = "/openmsx";
+	unsigned width = 320;
+	unsigned height = 240;
+	unsigned numSlots = DEFAULT_SLOTS;
+	bool exportAudio = false;
+
+	vector<string> arguments;
+	for (unsigned i = 2; i < tokens.size(); ++i) {
+		string_ref token = tokens[i].getString();
+		if (token.starts_with('-')) {
+			if (token == "-audio") {
+				exportAudio = true;
+			} else if (token == "-doublesize") {
+				width = 640;
+				height = 480;
+			} else if (token == "-triplesize") {
+				width = 960;
+				height = 720;
+			} else if (token == "-slots") {
+				if (++i == tokens.size()) {
+					throw CommandException("Missing argument");
+				}
+				int n = tokens[i].getInt(reactor.getInterpreter());
+				if ((n < 2) || (n > int(MAX_SLOTS))) {
+					throw CommandException(
+						"Number of slots must be in range 2-" +
+						StringOp::toString(MAX_SLOTS));
+				}
+				numSlots = n;
+			} else {
+				throw CommandException("Invalid option: " + token);
+			}
+		} else {
+			arguments.push_back(token.str());
+		}
+	}
+	switch (arguments.size()) {
+	case 0:
+		// nothing
+		break;
+	case 1:
+		name = arguments[0];
+		break;
+	default:
+		throw SyntaxError();
+	}
+	if (!StringOp::startsWith(name, '/')) name = '/' + name;
+
+	if (!shmName.empty()) {
+		result.setString("Already exporting to " + shmName);
+	} else {
+		start(name, width, height, numSlots, exportAudio);
+		result.setString("Exporting to shared memory object " + name);
+	}
+}
+
+void SharedMemoryExporter::processStop(array_ref<TclObject> tokens)
+{
+	if (tokens.size() != 2) {
+		throw SyntaxError();
+	}
+	stop();
+}
+
+void SharedMemoryExporter::status(array_ref<TclObject> tokens, TclObject& result) const
+{
+	if (tokens.size() != 2) {
+		throw SyntaxError();
+	}
+	result.addListElement("status");
+	if (!shmName.empty()) {
+		result.addListElement("exporting");
+		result.addListElement("name");
+		result.addListElement(shmName);
+		result.addListElement("frames");
+		result.addListElement(int(frameCount));
+	} else {
+		result.addListElement("idle");
+	}
+}
+
+// class SharedMemoryExporter::Cmd
+
+SharedMemoryExporter::Cmd::Cmd(CommandController& commandController_)
+	: Command(commandController_, "shm_export")
+{
+}
+
+void SharedMemoryExporter::Cmd::execute(array_ref<TclObject> tokens, TclObject& result)
+{
+	if (tokens.size() < 2) {
+		throw CommandException("Missing argument");
+	}
+	auto& exporter = OUTER(SharedMemoryExporter, shmCommand);
+	const string_ref subcommand = tokens[1].getString();
+	if (subcommand == "start") {
+		exporter.processStart(tokens, result);
+	} else if (subcommand == "stop") {
+		exporter.processStop(tokens);
+	} else if (subcommand == "status") {
+		exporter.status(tokens, result);
+	} else {
+		throw SyntaxError();
+	}
+}
+
+string SharedMemoryExporter::Cmd::help(const vector<string>& /*tokens*/) const
+{
+	return "Publishes each finished frame (and optionally the audio) in a "
+	       "POSIX shared memory object, for use by external programs.\n"
+	       "shm_export start             Export to shared memory object '/openmsx'\n"
+	       "shm_export start <name>      Export to given shared memory object\n"
+	       "shm_export stop              Stop exporting\n"
+	       "shm_export status            Query export state\n"
+	       "\n"
+	       "The start subcommand also accepts the options:\n"
+	       "  -audio                   also export the mixed audio\n"
+	       "  -doublesize, -triplesize export 640x480 or 960x720 frames "
+	       "instead of 320x240\n"
+	       "  -slots <n>               size of the frame ring buffer (default 4)\n"
+	       "See the manual for the layout of the shared memory object.";
+}
+
+void SharedMemoryExporter::Cmd::tabCompletion(vector<string>& tokens) const
+{
+	if (tokens.size() == 2) {
+		static const char* const cmds[] = {
+			"start", "stop", "status",
+		};
+		completeString(tokens, cmds);
+	} else if ((tokens.size() >= 3) && (tokens[1] == "start")) {
+		static const char* const options[] = {
+			"-audio", "-doublesize", "-triplesize", "-slots",
+		};
+		completeString(tokens, options);
+	}
+}
+
+} // namespace openmsx
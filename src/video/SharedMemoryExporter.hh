@@ -0,0 +1,100 @@
+#ifndef SHAREDMEMORYEXPORTER_HH
+#define SHAREDMEMORYEXPORTER_HH
+
+#include "Command.hh"
+#include "EmuTime.hh"
+#include "array_ref.hh"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+class Reactor;
+class PostProcessor;
+class FrameSource;
+class MSXMixer;
+class TclObject;
+
+/** Publishes the finished frames (and optionally the mixed audio) of the
+  * active machine in a POSIX shared memory object, so that external
+  * processes (streaming, monitoring, ...) can consume them without any
+  * encoding step and without going via the filesystem.
+  *
+  * The shared memory object starts with a Header, followed by 'numSlots'
+  * slots of 'slotSize' bytes each. Frame number 'n' (starting from 1) is
+  * written to slot 'n % numSlots'. Each slot starts with a SlotHeader,
+  * followed by the pixel data (height lines of 'pitch' bytes) and then
+  * the audio samples (16-bit signed, interleaved stereo).
+  *
+  * Synchronization uses sequence numbers: while a slot is being written its
+  * 'seq' field is 0, afterwards it's set to the frame number and finally
+  * Header::seq is set to that same number. A consumer reads Header::seq,
+  * reads (or copies) the corresponding slot and then checks that the slot
+  * 'seq' field didn't change in the mean time.
+  */
+class SharedMemoryExporter
+{
+public:
+	struct Header {
+		char magic[8]; // "oMSXshm1"
+		uint32_t headerSize;
+		uint32_t numSlots;
+		uint32_t slotSize;
+		uint32_t width;
+		uint32_t height;
+		uint32_t bpp; // 15, 16 or 32
+		uint32_t pitch; // in bytes
+		uint32_t redMask;
+		uint32_t greenMask;
+		uint32_t blueMask;
+		uint32_t sampleRate; // 0 when audio is not exported
+		uint32_t maxSamples; // audio capacity of a slot (stereo samples)
+		uint64_t emuTimeFreq; // unit of SlotHeader::emuTime
+		std::atomic<uint64_t> seq; // number of last published frame
+	};
+	struct SlotHeader {
+		std::atomic<uint64_t> seq; // frame number, 0 while writing
+		uint64_t emuTime;
+		uint32_t numSamples; // stereo samples, following the pixels
+		uint32_t droppedSamples; // didn't fit in this slot
+	};
+
+	explicit SharedMemoryExporter(Reactor& reactor);
+	~SharedMemoryExporter();
+
+	void addWave(unsigned num, int16_t* data);
+	void addImage(FrameSource* frame, EmuTime::param time);
+	void stop();
+
+private:
+	void start(const std::string& name, unsigned width, unsigned height,
+	           unsigned numSlots, bool exportAudio);
+	template<typename Pixel> void copyFrame(FrameSource& frame, uint8_t* dst);
+
+	void processStart(array_ref<TclObject> tokens, TclObject& result);
+	void processStop (array_ref<TclObject> tokens);
+	void status(array_ref<TclObject> tokens, TclObject& result) const;
+
+	Reactor& reactor;
+
+	struct Cmd final : Command {
+		explicit Cmd(CommandController& commandController);
+		void execute(array_ref<TclObject> tokens, TclObject& result) override;
+		std::string help(const std::vector<std::string>& tokens) const override;
+		void tabCompletion(std::vector<std::string>& tokens) const override;
+	} shmCommand;
+
+	std::vector<int16_t> audioBuf;
+	std::vector<PostProcessor*> postProcessors;
+	MSXMixer* mixer;
+	std::string shmName; // empty when not exporting
+	uint8_t* mapping;
+	size_t mappingSize;
+	uint64_t frameCount;
+};
+
+} // namespace openmsx
+
+#endif
@@ -22,6 +22,7 @@ SpriteChecker::SpriteChecker(VDP& vdp_, RenderSettings& renderSettings,
 	: vdp(vdp_), vram(vdp.getVRAM())
 	, limitSpritesSetting(renderSettings.getLimitSpritesSetting())
 	, frameStartTime(time)
+	, lineIndexValid(false)
 {
 	vram.spriteAttribTable.setObserver(this);
 	vram.spritePatternTable.setObserver(this);
@@ -36,6 +37,7 @@ void SpriteChecker::reset(EmuTime::param time)
 	frameStart(time);
 
 	updateSpritesMethod = &SpriteChecker::updateSprites1;
+	lineIndexValid = false;
 }
 
 static inline SpriteChecker::SpritePattern doublePattern(SpriteChecker::SpritePattern a)
@@ -78,6 +80,23 @@ inline SpriteChecker::SpritePattern SpriteChecker::calculatePatternPlanar(
 	return !vdp.isSpriteMag() ? pattern : doublePattern(pattern);
 }
 
+void SpriteChecker::buildLineIndex(
+	const byte* yPtr, unsigned stride, int stopY, int magSize)
+{
+	for (auto& m : lineIndex) m = 0;
+	int sprite = 0;
+	for (/**/; sprite < 32; ++sprite) {
+		int y = yPtr[stride * sprite];
+		if (y == stopY) break;
+		uint32_t bit = 0x80000000 >> sprite;
+		for (int i = 0; i < magSize; ++i) {
+			lineIndex[(y + i) & 0xFF] |= bit;
+		}
+	}
+	numSprites = sprite;
+	lineIndexValid = true;
+}
+
 void SpriteChecker::updateSprites1(int limit)
 {
 	if (vdp.spritesEnabledFast()) {
@@ -97,21 +116,12 @@ void SpriteChecker::updateSprites1(int limit)
 
 inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 {
-	// This implementation contains a double for-loop. The outer loop goes
-	// over the sprites, the inner loop over the to-be-checked lines. This
-	// is not the order in which the real VDP performs this operation: the
-	// real VDP renders line-per-line and for each line checks all 32
-	// sprites.
-	//
-	// Though this 'reverse' order allows to skip over very large regions
-	// of the inner loop: we only have to process the lines were a
-	// particular sprite is actually visible. I measured this makes this
-	// routine 4x-5x faster!
-	//
-	// This routine also needs to detect the sprite number of the 'first'
-	// 5th-sprite-condition. With 'first' meaning the first line where this
-	// condition occurs. Because our loops are swapped compared to the real
-	// VDP, we need some extra fixup logic to correctly detect this.
+	// Like the real VDP, this goes line-per-line and for each line over
+	// the sprites in order. But instead of checking all 32 sprites for
+	// each line, the sprite-line index is used to only visit the sprites
+	// that are actually visible on that line. That index only has to be
+	// rebuilt when the Y-coordinates or the sprite size change, which is
+	// much less often than once per checked line.
 
 	// Calculate display line.
 	// This is the line sprites are checked at; the line they are displayed
@@ -126,33 +136,34 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 	const byte* attributePtr = vram.spriteAttribTable.getReadArea(0, 32 * 4);
 	byte patternIndexMask = size == 16 ? 0xFC : 0xFF;
 	int fifthSpriteNum  = -1;  // no 5th sprite detected yet
-	int fifthSpriteLine = 999; // larger than any possible valid line
 
-	int sprite = 0;
-	for (/**/; sprite < 32; ++sprite) {
-		int y = attributePtr[4 * sprite + 0];
-		if (y == 208) break;
-
-		for (int line = minLine; line < maxLine; ++line) {
-			// Calculate line number within the sprite.
-			int displayLine = line + displayDelta;
-			int spriteLine = (displayLine - y) & 0xFF;
-			if (spriteLine >= magSize) {
-				// Skip ahead till sprite becomes visible.
-				line += 256 - spriteLine - 1; // -1 because of for-loop
-				continue;
-			}
+	if (!lineIndexValid) {
+		buildLineIndex(attributePtr, 4, 208, magSize);
+	}
+	for (int line = minLine; line < maxLine; ++line) {
+		int displayLine = line + displayDelta;
+		uint32_t visible = lineIndex[displayLine & 0xFF];
+		while (visible) {
+			int sprite = Math::countLeadingZeros(visible);
+			visible &= ~(0x80000000 >> sprite);
 
 			int visibleIndex = spriteCount[line];
 			if (visibleIndex == 4) {
-				// Find earliest line where this condition occurs.
-				if (line < fifthSpriteLine) {
-					fifthSpriteLine = line;
+				// Lines are checked in order, so the first time this
+				// condition occurs is also the earliest line.
+				if (fifthSpriteNum == -1) {
 					fifthSpriteNum = sprite;
 				}
-				if (limitSprites) continue;
+				// All following sprites on this line are skipped
+				// as well.
+				if (limitSprites) break;
 			}
 
+			// Calculate line number within the sprite.
+			int y = attributePtr[4 * sprite + 0];
+			int spriteLine = (displayLine - y) & 0xFF;
+			assert(spriteLine < magSize);
+
 			SpriteInfo& sip = spriteBuffer[line][visibleIndex];
 			int patternIndex = attributePtr[4 * sprite + 2] & patternIndexMask;
 			if (mag) spriteLine /= 2;
@@ -165,6 +176,7 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 			spriteCount[line] = visibleIndex + 1;
 		}
 	}
+	int sprite = numSprites;
 
 	// Update status register.
 	byte status = vdp.getStatusReg0();
@@ -267,7 +279,7 @@ void SpriteChecker::updateSprites2(int limit)
 
 inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 {
-	// See comment in checkSprites1() about order of inner and outer loops.
+	// See comment in checkSprites1() about the sprite-line index.
 
 	// Calculate display line.
 	// This is the line sprites are checked at; the line they are displayed
@@ -281,41 +293,39 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 	int magSize = (mag + 1) * size;
 	int patternIndexMask = (size == 16) ? 0xFC : 0xFF;
 	int ninthSpriteNum  = -1;  // no 9th sprite detected yet
-	int ninthSpriteLine = 999; // larger than any possible valid line
 
 	// Because it gave a measurable performance boost, we duplicated the
 	// code for planar and non-planar modes.
-	int sprite = 0;
 	if (planar) {
 		const byte* attributePtr0;
 		const byte* attributePtr1;
 		vram.spriteAttribTable.getReadAreaPlanar(
 			512, 32 * 4, attributePtr0, attributePtr1);
+		if (!lineIndexValid) {
+			buildLineIndex(attributePtr0, 2, 216, magSize);
+		}
 		// TODO: Verify CC implementation.
-		for (/**/; sprite < 32; ++sprite) {
-			int y = attributePtr0[2 * sprite + 0];
-			if (y == 216) break;
-
-			for (int line = minLine; line < maxLine; ++line) {
-				// Calculate line number within the sprite.
-				int displayLine = line + displayDelta;
-				int spriteLine = (displayLine - y) & 0xFF;
-				if (spriteLine >= magSize) {
-					// Skip ahead till sprite is visible.
-					line += 256 - spriteLine - 1;
-					continue;
-				}
+		for (int line = minLine; line < maxLine; ++line) {
+			int displayLine = line + displayDelta;
+			uint32_t visible = lineIndex[displayLine & 0xFF];
+			while (visible) {
+				int sprite = Math::countLeadingZeros(visible);
+				visible &= ~(0x80000000 >> sprite);
 
 				int visibleIndex = spriteCount[line];
 				if (visibleIndex == 8) {
-					// Find earliest line where this condition occurs.
-					if (line < ninthSpriteLine) {
-						ninthSpriteLine = line;
+					// Earliest line, see checkSprites1().
+					if (ninthSpriteNum == -1) {
 						ninthSpriteNum = sprite;
 					}
-					if (limitSprites) continue;
+					if (limitSprites) break;
 				}
 
+				// Calculate line number within the sprite.
+				int y = attributePtr0[2 * sprite + 0];
+				int spriteLine = (displayLine - y) & 0xFF;
+				assert(spriteLine < magSize);
+
 				if (mag) spriteLine /= 2;
 				int colorIndex = (~0u << 10) | (sprite * 16 + spriteLine);
 				byte colorAttrib =
@@ -339,31 +349,31 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 	} else {
 		const byte* attributePtr0 =
 			vram.spriteAttribTable.getReadArea(512, 32 * 4);
+		if (!lineIndexValid) {
+			buildLineIndex(attributePtr0, 4, 216, magSize);
+		}
 		// TODO: Verify CC implementation.
-		for (/**/; sprite < 32; ++sprite) {
-			int y = attributePtr0[4 * sprite + 0];
-			if (y == 216) break;
-
-			for (int line = minLine; line < maxLine; ++line) {
-				// Calculate line number within the sprite.
-				int displayLine = line + displayDelta;
-				int spriteLine = (displayLine - y) & 0xFF;
-				if (spriteLine >= magSize) {
-					// Skip ahead till sprite is visible.
-					line += 256 - spriteLine - 1;
-					continue;
-				}
+		for (int line = minLine; line < maxLine; ++line) {
+			int displayLine = line + displayDelta;
+			uint32_t visible = lineIndex[displayLine & 0xFF];
+			while (visible) {
+				int sprite = Math::countLeadingZeros(visible);
+				visible &= ~(0x80000000 >> sprite);
 
 				int visibleIndex = spriteCount[line];
 				if (visibleIndex == 8) {
-					// Find earliest line where this condition occurs.
-					if (line < ninthSpriteLine) {
-						ninthSpriteLine = line;
+					// Earliest line, see checkSprites1().
+					if (ninthSpriteNum == -1) {
 						ninthSpriteNum = sprite;
 					}
-					if (limitSprites) continue;
+					if (limitSprites) break;
 				}
 
+				// Calculate line number within the sprite.
+				int y = attributePtr0[4 * sprite + 0];
+				int spriteLine = (displayLine - y) & 0xFF;
+				assert(spriteLine < magSize);
+
 				if (mag) spriteLine /= 2;
 				int colorIndex = (~0u << 10) | (sprite * 16 + spriteLine);
 				byte colorAttrib =
@@ -393,6 +403,8 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 		}
 	}
 
+	int sprite = numSprites;
+
 	// Update status register.
 	byte status = vdp.getStatusReg0();
 	if (ninthSpriteNum != -1) {
@@ -501,6 +513,8 @@ void SpriteChecker::serialize(Archive& ar, unsigned version)
 		// first (partial) frame after loadstate.
 		for (auto& c : spriteCount) c = 0;
 		// content of spriteBuffer[] doesn't matter if spriteCount[] is 0
+
+		lineIndexValid = false;
 	}
 	ar.serialize("collisionX", collisionX);
 	ar.serialize("collisionY", collisionY);
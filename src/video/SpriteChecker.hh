@@ -138,7 +138,8 @@ public:
 	inline void updateSpriteSizeMag(byte sizeMag, EmuTime::param time) {
 		(void)sizeMag;
 		sync(time);
-		// TODO: Precalc something?
+		// The number of lines covered by each sprite changes.
+		lineIndexValid = false;
 	}
 
 	/** Informs the sprite checker of a vertical scroll change.
@@ -237,12 +238,16 @@ public:
 
 	// VRAMObserver implementation:
 
-	void updateVRAM(unsigned /*offset*/, EmuTime::param time) override {
+	void updateVRAM(unsigned offset, EmuTime::param time) override {
 		checkUntil(time);
+		if (lineIndexValid && affectsLineIndex(offset)) {
+			lineIndexValid = false;
+		}
 	}
 
 	void updateWindow(bool /*enabled*/, EmuTime::param time) override {
 		sync(time);
+		lineIndexValid = false;
 	}
 
 	template<typename Archive>
@@ -252,6 +257,7 @@ private:
 	/** Calculate 'updateSpritesMethod' and 'planar'.
 	  */
 	inline void setDisplayMode(DisplayMode mode) {
+		lineIndexValid = false;
 		switch (mode.getSpriteMode(vdp.isMSX1VDP())) {
 		case 0:
 			updateSpritesMethod = nullptr;
@@ -270,6 +276,31 @@ private:
 		}
 	}
 
+	/** Can a VRAM write (at the given offset in the sprite attribute
+	  * window) change the contents of the sprite-line index? Only the
+	  * Y-coordinates are used to build the index. Writes to the sprite
+	  * pattern table never affect it.
+	  */
+	inline bool affectsLineIndex(unsigned offset) const {
+		if (updateSpritesMethod == &SpriteChecker::updateSprites1) {
+			return ((offset & 3) == 0) && (offset < 32 * 4);
+		}
+		// In planar modes the offset does not directly correspond to a
+		// position in the table, simply assume it's a Y-coordinate.
+		return planar ||
+		       (((offset & 3) == 0) && (512 <= offset) && (offset < 512 + 32 * 4));
+	}
+
+	/** (Re)build the sprite-line index from the Y-coordinates of the
+	  * sprite attribute table.
+	  * @param yPtr Pointer to the Y-coordinate of sprite 0.
+	  * @param stride Distance between the Y-coordinates of two sprites.
+	  * @param stopY Y-coordinate that marks the end of the sprite list.
+	  * @param magSize Height of the sprites in lines.
+	  */
+	void buildLineIndex(const byte* yPtr, unsigned stride, int stopY,
+	                    int magSize);
+
 	/** Calculate sprite patterns for sprite mode 1.
 	  */
 	void updateSprites1(int limit);
@@ -364,6 +395,25 @@ private:
 	  */
 	uint8_t spriteCount[313];
 
+	/** For each (sprite) display line [0..256), a bit mask of the
+	  * sprites that are (vertically) visible on that line. Bit 31 is
+	  * sprite 0, bit 30 sprite 1 and so on. This only depends on the
+	  * Y-coordinates in the sprite attribute table and on the sprite
+	  * size, so it is only rebuilt when one of those changes (instead of
+	  * scanning the whole attribute table for every checked line).
+	  */
+	uint32_t lineIndex[256];
+
+	/** Number of sprites before the terminating Y-coordinate
+	  * (208 or 216), or 32 if there is none. Only valid together with
+	  * lineIndex.
+	  */
+	int numSprites;
+
+	/** Is the content of lineIndex and numSprites up-to-date?
+	  */
+	bool lineIndexValid;
+
 	/** Is current display mode planar or not?
 	  * TODO: Introduce separate update methods for planar/nonplanar modes.
 	  */
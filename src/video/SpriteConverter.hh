@@ -9,6 +9,12 @@ TODO:
 #include "SpriteChecker.hh"
 #include "DisplayMode.hh"
 #include "openmsx.hh"
+#include "aligned.hh"
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace openmsx {
 
@@ -150,6 +156,9 @@ public:
 		// Lines without any sprites are very common in most programs.
 		if (visibleIndex == 0) return;
 
+#ifdef __SSE2__
+		drawMode2SSE<MODE>(visibleSprites, visibleIndex, minX, maxX, pixelPtr);
+#else
 		for (int i = visibleIndex - 1; i >= 0; --i) {
 			const SpriteChecker::SpriteInfo& info = visibleSprites[i];
 			int x = info.x;
@@ -191,9 +200,131 @@ public:
 				pattern <<= 1;
 			}
 		}
+#endif
 	}
 
 private:
+#ifdef __SSE2__
+	/** Expand a sprite pattern to 32 byte-masks: byte n is 0xFF when
+	  * bit (31 - n) of the pattern is set, otherwise it's 0x00.
+	  */
+	static inline void expandPattern(
+		SpriteChecker::SpritePattern pattern, __m128i& lo, __m128i& hi)
+	{
+		// bytes of the pattern (b3 is the leftmost): b0 b1 b2 b3
+		__m128i t = _mm_cvtsi32_si128(pattern);
+		t = _mm_unpacklo_epi8 (t, t); // b0 b0 b1 b1 b2 b2 b3 b3
+		t = _mm_unpacklo_epi16(t, t); // b0 x4 b1 x4 b2 x4 b3 x4
+		t = _mm_shuffle_epi32(t, _MM_SHUFFLE(0, 1, 2, 3)); // b3 .. b0
+		const __m128i bits = _mm_set_epi8(
+			0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80,
+			0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80);
+		lo = _mm_unpacklo_epi32(t, t); // b3 x8 b2 x8
+		hi = _mm_unpackhi_epi32(t, t); // b1 x8 b0 x8
+		lo = _mm_cmpeq_epi8(_mm_and_si128(lo, bits), bits);
+		hi = _mm_cmpeq_epi8(_mm_and_si128(hi, bits), bits);
+	}
+
+	/** SSE2 version of drawMode2().
+	  * First all sprites are blended 32 pixels at a time into a line of
+	  * color indices (including the OR-ing of CC=1 sprites), only then
+	  * those color indices are converted to host pixels. Bit 7 of a
+	  * color index marks pixels that are covered by a sprite.
+	  */
+	template <unsigned MODE>
+	void drawMode2SSE(const SpriteChecker::SpriteInfo* visibleSprites,
+	                  int visibleIndex, int minX, int maxX,
+	                  Pixel* __restrict pixelPtr) __restrict
+	{
+		memset(&lineBuf[minX], 0, maxX - minX);
+
+		bool anyDrawn = false;
+		for (int i = visibleIndex - 1; i >= 0; --i) {
+			const SpriteChecker::SpriteInfo& info = visibleSprites[i];
+			int x = info.x;
+			SpriteChecker::SpritePattern pattern = info.pattern;
+			// Clip sprite pattern to render range.
+			if (!clipPattern(x, pattern, minX, maxX)) continue;
+			byte c = info.colorAttrib & 0x0F;
+			if (c == 0 && transparency) continue;
+			if (!pattern) continue;
+
+			__m128i mask0, mask1;
+			expandPattern(pattern, mask0, mask1);
+			__m128i col0 = _mm_set1_epi8(0x80 | c);
+			__m128i col1 = col0;
+			// Merge in any following CC=1 sprites.
+			for (int j = i + 1; /*sentinel*/; ++j) {
+				const SpriteChecker::SpriteInfo& info2 =
+					visibleSprites[j];
+				if (!(info2.colorAttrib & 0x40)) break;
+				// Align pattern of sprite j with 'x'.
+				int shift = x - info2.x;
+				if ((shift <= -32) || (32 <= shift)) continue;
+				SpriteChecker::SpritePattern pattern2 = (shift >= 0)
+					? (info2.pattern << shift)
+					: (info2.pattern >> -shift);
+				if (!pattern2) continue;
+				__m128i m0, m1;
+				expandPattern(pattern2, m0, m1);
+				__m128i c2 = _mm_set1_epi8(info2.colorAttrib & 0x0F);
+				col0 = _mm_or_si128(col0, _mm_and_si128(m0, c2));
+				col1 = _mm_or_si128(col1, _mm_and_si128(m1, c2));
+			}
+
+			// Overdraw: the sprites are visited from low to high
+			// priority. Note that 'lineBuf' has room for 32 pixels
+			// past 'maxX', the clipped pattern leaves those unchanged.
+			byte* dst = &lineBuf[x];
+			__m128i d0 = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst +  0));
+			__m128i d1 = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst + 16));
+			d0 = _mm_or_si128(_mm_andnot_si128(mask0, d0),
+			                  _mm_and_si128(mask0, col0));
+			d1 = _mm_or_si128(_mm_andnot_si128(mask1, d1),
+			                  _mm_and_si128(mask1, col1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst +  0), d0);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), d1);
+			anyDrawn = true;
+		}
+		if (!anyDrawn) return;
+
+		// Convert color indices to host pixels, skip over 16 pixels
+		// at a time when none of them is covered by a sprite.
+		for (int x0 = minX; x0 < maxX; x0 += 16) {
+			__m128i b = _mm_loadu_si128(
+				reinterpret_cast<__m128i*>(&lineBuf[x0]));
+			unsigned covered = _mm_movemask_epi8(b);
+			int n = maxX - x0;
+			if (n < 16) covered &= (1 << n) - 1;
+			while (covered) {
+				int x = x0 + Math::countTrailingZeros(covered);
+				covered &= covered - 1;
+				byte color = lineBuf[x] & 0x0F;
+				if (MODE == DisplayMode::GRAPHIC5) {
+					Pixel pixL = palette[color >> 2];
+					Pixel pixR = palette[color & 3];
+					pixelPtr[x * 2 + 0] = pixL;
+					pixelPtr[x * 2 + 1] = pixR;
+				} else {
+					Pixel pix = palette[color];
+					if (MODE == DisplayMode::GRAPHIC6) {
+						pixelPtr[x * 2 + 0] = pix;
+						pixelPtr[x * 2 + 1] = pix;
+					} else {
+						pixelPtr[x] = pix;
+					}
+				}
+			}
+		}
+	}
+
+	/** Color indices of one line of sprite pixels, used by
+	  * drawMode2SSE(). The extra 32 bytes allow to always blend a
+	  * complete (32 pixels wide) sprite.
+	  */
+	ALIGNED(byte lineBuf[256 + 32], 16);
+#endif
+
 	SpriteChecker& spriteChecker;
 
 	/** The current sprite palette.
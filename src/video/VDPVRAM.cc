@@ -94,6 +94,12 @@ void VDPVRAM::PhysicalVRAMDebuggable::write(
 	vram.cpuWrite(address, value, time);
 }
 
+DirtyTracker* VDPVRAM::PhysicalVRAMDebuggable::getDirtyTracker()
+{
+	auto& vram = OUTER(VDPVRAM, physicalVRAMDebug);
+	return &vram.dirtyTracker;
+}
+
 
 // class VDPVRAM
 
@@ -110,6 +116,7 @@ static unsigned bufferSize(unsigned size)
 VDPVRAM::VDPVRAM(VDP& vdp_, unsigned size, EmuTime::param time)
 	: vdp(vdp_)
 	, data(vdp_.getDeviceConfig2(), bufferSize(size))
+	, dirtyTracker(bufferSize(size))
 	, logicalVRAMDebug (vdp)
 	, physicalVRAMDebug(vdp, size)
 	#ifdef DEBUG
@@ -148,6 +155,7 @@ void VDPVRAM::clear()
 		// give the same value.
 		memset(&data[actualSize], 0xFF, data.getSize() - actualSize);
 	}
+	dirtyTracker.markAll();
 }
 
 void VDPVRAM::updateDisplayMode(DisplayMode mode, bool cmdBit, EmuTime::param time)
@@ -211,6 +219,8 @@ void VDPVRAM::updateVRMode(bool newVRmode, EmuTime::param time)
 	}
 	vrMode = newVRmode;
 	setSizeMask(time);
+	// Sprite attributes will move around (even if the window didn't).
+	spriteAttribTable.observer->updateWindow(true, time);
 
 	if (vrMode) {
 		// switch from VR=0 to VR=1
@@ -223,6 +233,9 @@ void VDPVRAM::updateVRMode(bool newVRmode, EmuTime::param time)
 			std::swap(data[i], data[swapAddr(i)]);
 		}
 	}
+	dirtyTracker.markAll();
+	// The content of the whole VRAM moved around.
+	bitmapVisibleWindow.observer->updateWindow(true, time);
 }
 
 void VDPVRAM::setRenderer(Renderer* newRenderer, EmuTime::param time)
@@ -236,9 +249,13 @@ void VDPVRAM::setRenderer(Renderer* newRenderer, EmuTime::param time)
 	// TODO: If it is a good idea to send an initial sync,
 	//       then call setObserver before setMask.
 	bitmapVisibleWindow.setObserver(renderer);
+	// Only interested in window changes of these two (e.g. to invalidate
+	// cached pattern data), individual writes come via the window above.
+	colorTable.setObserver(renderer);
+	patternTable.setObserver(renderer);
 }
 
-void VDPVRAM::change4k8kMapping(bool mapping8k)
+void VDPVRAM::change4k8kMapping(bool mapping8k, EmuTime::param time)
 {
 	/* Sources:
 	 *  - http://www.msx.org/forumtopicl8624.html
@@ -282,6 +299,9 @@ void VDPVRAM::change4k8kMapping(bool mapping8k)
 	 * even in 4K mode, all 16K of VRAM can be accessed. The only
 	 * difference is in what addresses are used to store data.
 	 */
+	// Sprite attributes will move around.
+	spriteAttribTable.observer->updateWindow(true, time);
+
 	byte tmp[0x4000];
 	if (mapping8k) {
 		// from 8k/16k to 4k mapping
@@ -305,6 +325,10 @@ void VDPVRAM::change4k8kMapping(bool mapping8k)
 		}
 	}
 	memcpy(&data[0], tmp, sizeof(tmp));
+	dirtyTracker.markAll();
+
+	// The content of the whole VRAM moved around.
+	bitmapVisibleWindow.observer->updateWindow(true, time);
 }
 
 
@@ -5,6 +5,7 @@
 #include "VDP.hh"
 #include "VDPCmdEngine.hh"
 #include "SimpleDebuggable.hh"
+#include "DirtyTracker.hh"
 #include "Ram.hh"
 #include "Math.hh"
 #include "openmsx.hh"
@@ -535,7 +536,7 @@ public:
 	/** TMS99x8 VRAM can be mapped in two ways.
 	  * See implementation for more details.
 	  */
-	void change4k8kMapping(bool mapping8k);
+	void change4k8kMapping(bool mapping8k, EmuTime::param time);
 
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
@@ -557,6 +558,7 @@ private:
 		spritePatternTable.notify(address, time);
 
 		data[address] = value;
+		dirtyTracker.mark(address);
 		#ifdef DEBUG
 		vramTime = time;
 		#endif
@@ -570,9 +572,12 @@ private:
 		assert(!bitmapCacheWindow.hasObserver());
 		assert(!nameTable.hasObserver());
 
-		// in the past GLRasterizer observed these two, now there are none
-		assert(!colorTable.hasObserver());
-		assert(!patternTable.hasObserver());
+		// The renderer observes these two only to get notified about
+		// window changes (see setRenderer()). Individual writes are
+		// already reported through bitmapVisibleWindow, which spans
+		// the whole VRAM, so no need to notify them here.
+		// colorTable.notify(address, time);
+		// patternTable.notify(address, time);
 
 		/* TODO:
 		There seems to be a significant difference between subsystem sync
@@ -597,6 +602,10 @@ private:
 	  */
 	Ram data;
 
+	/** Which parts of 'data' were written, see 'debug subscribe'.
+	  */
+	DirtyTracker dirtyTracker;
+
 	/** Debuggable with mode dependend view on the vram
 	  *   Screen7/8 are not interleaved in this mode.
 	  *   This debuggable is also at least 128kB in size (it possibly
@@ -619,6 +628,7 @@ private:
 		PhysicalVRAMDebuggable(VDP& vdp, unsigned actualSize);
 		byte read(unsigned address, EmuTime::param time) override;
 		void write(unsigned address, byte value, EmuTime::param time) override;
+		DirtyTracker* getDirtyTracker() override;
 	} physicalVRAMDebug;
 
 	// TODO: Renderer field can be removed, if updateDisplayMode
@@ -19,12 +19,20 @@ RGBTriplet3xScaler<Pixel>::RGBTriplet3xScaler(
 	, scanline(pixelOps_)
 	, settings(renderSettings)
 {
+	updateSettings();
+}
+
+template <class Pixel>
+void RGBTriplet3xScaler<Pixel>::updateSettings()
+{
+	blurFactor     = settings.getBlurFactor();
+	scanlineFactor = settings.getScanlineFactor();
 }
 
 template <class Pixel>
 void RGBTriplet3xScaler<Pixel>::calcBlur(unsigned& c1, unsigned& c2)
 {
-	c1 = settings.getBlurFactor();
+	c1 = blurFactor;
 	c2 = (3 * 256) - (2 * c1);
 }
 
@@ -100,7 +108,6 @@ void RGBTriplet3xScaler<Pixel>::doScale1(FrameSource& src,
 
 	unsigned dstWidth = dst.getWidth();
 	unsigned tmpWidth = dstWidth / 3;
-	int scanlineFactor = settings.getScanlineFactor();
 	unsigned y = dstStartY;
 	auto* srcLine = src.getLinePtr(srcStartY++, srcWidth, buf);
 	auto* dstLine0 = dst.acquireLine(y + 0);
@@ -151,7 +158,6 @@ void RGBTriplet3xScaler<Pixel>::doScale2(FrameSource& src,
 
 	unsigned dstWidth = dst.getWidth();
 	unsigned tmpWidth = dstWidth / 3;
-	int scanlineFactor = settings.getScanlineFactor();
 	for (unsigned srcY = srcStartY, dstY = dstStartY; dstY < dstEndY;
 	     srcY += 2, dstY += 3) {
 		auto* srcLine0 = src.getLinePtr(srcY + 0, srcWidth, buf);
@@ -316,7 +322,6 @@ void RGBTriplet3xScaler<Pixel>::scaleBlank1to3(
 {
 	unsigned c1, c2;
 	calcBlur(c1, c2);
-	int scanlineFactor = settings.getScanlineFactor();
 
 	unsigned dstWidth  = dst.getWidth();
 	unsigned dstHeight = dst.getHeight();
@@ -364,7 +369,6 @@ void RGBTriplet3xScaler<Pixel>::scaleBlank2to3(
 {
 	unsigned c1, c2;
 	calcBlur(c1, c2);
-	int scanlineFactor = settings.getScanlineFactor();
 	unsigned dstWidth = dst.getWidth();
 	for (unsigned srcY = srcStartY, dstY = dstStartY;
 	     dstY < dstEndY; srcY += 2, dstY += 3) {
@@ -19,6 +19,8 @@ public:
 	RGBTriplet3xScaler(const PixelOperations<Pixel>& pixelOps,
 	                   const RenderSettings& renderSettings);
 
+	void updateSettings() override;
+
 protected:
 	void scaleImage(FrameSource& src, const RawFrame* superImpose,
 		unsigned srcStartY, unsigned srcEndY, unsigned srcWidth,
@@ -93,6 +95,8 @@ private:
 	PixelOperations<Pixel> pixelOps;
 	Scanline<Pixel> scanline;
 	const RenderSettings& settings;
+	int blurFactor;     // copied from 'settings' in updateSettings()
+	int scanlineFactor;
 };
 
 } // namespace openmsx
@@ -15,6 +15,14 @@ template<typename Pixel> class Scaler
 public:
 	virtual ~Scaler() {}
 
+	/** Take over the current values of the (render) settings this scaler
+	  * depends on. Settings may only be read from the main thread, while
+	  * scaleImage() may run on the scale thread of FBPostProcessor. So the
+	  * values are copied here (on the main thread) before a frame is
+	  * scaled.
+	  */
+	virtual void updateSettings() {}
+
 	/** Scales the image in the given area, which must consist of lines which
 	  * are all equally wide.
 	  * Scaling factor depends on the concrete scaler.
@@ -29,6 +29,14 @@ Simple2xScaler<Pixel>::Simple2xScaler(
 	, mult3(pixelOps)
 	, scanline(pixelOps)
 {
+	updateSettings();
+}
+
+template <class Pixel>
+void Simple2xScaler<Pixel>::updateSettings()
+{
+	blurFactor     = settings.getBlurFactor();
+	scanlineFactor = settings.getScanlineFactor();
 }
 
 template <class Pixel>
@@ -36,8 +44,6 @@ void Simple2xScaler<Pixel>::scaleBlank1to2(
 		FrameSource& src, unsigned srcStartY, unsigned srcEndY,
 		ScalerOutput<Pixel>& dst, unsigned dstStartY, unsigned dstEndY)
 {
-	int scanlineFactor = settings.getScanlineFactor();
-
 	unsigned dstHeight = dst.getHeight();
 	unsigned stopDstY = (dstEndY == dstHeight)
 	                  ? dstEndY : dstEndY - 2;
@@ -400,8 +406,7 @@ void Simple2xScaler<Pixel>::scale1x1to2x2(FrameSource& src,
 	ScalerOutput<Pixel>& dst, unsigned dstStartY, unsigned dstEndY)
 {
 	VLA_SSE_ALIGNED(Pixel, buf, srcWidth);
-	int blur = settings.getBlurFactor();
-	int scanlineFactor = settings.getScanlineFactor();
+	int blur = blurFactor;
 
 	unsigned dstY = dstStartY;
 	auto* srcLine = src.getLinePtr(srcStartY++, srcWidth, buf);
@@ -438,8 +443,7 @@ void Simple2xScaler<Pixel>::scale1x1to1x2(FrameSource& src,
 	ScalerOutput<Pixel>& dst, unsigned dstStartY, unsigned dstEndY)
 {
 	VLA_SSE_ALIGNED(Pixel, buf, srcWidth);
-	int blur = settings.getBlurFactor();
-	int scanlineFactor = settings.getScanlineFactor();
+	int blur = blurFactor;
 
 	unsigned dstY = dstStartY;
 	auto* srcLine = src.getLinePtr(srcStartY++, srcWidth, buf);
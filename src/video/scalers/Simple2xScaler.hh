@@ -22,6 +22,8 @@ public:
 		const PixelOperations<Pixel>& pixelOps,
 		RenderSettings& renderSettings);
 
+	void updateSettings() override;
+
 private:
 	void scaleImage(FrameSource& src, const RawFrame* superImpose,
 		unsigned srcStartY, unsigned srcEndY, unsigned srcWidth,
@@ -44,6 +46,8 @@ private:
 	              size_t srcWidth);
 
 	RenderSettings& settings;
+	int blurFactor;     // copied from 'settings' in updateSettings()
+	int scanlineFactor;
 	PixelOperations<Pixel> pixelOps;
 
 	Multiply32<Pixel> mult1;
@@ -42,11 +42,19 @@ Simple3xScaler<Pixel>::Simple3xScaler(
 	, blur_1on3(make_unique<Blur_1on3<Pixel>>(pixelOps_))
 	, settings(settings_)
 {
+	updateSettings();
 }
 
 template <class Pixel>
 Simple3xScaler<Pixel>::~Simple3xScaler() = default;
 
+template <class Pixel>
+void Simple3xScaler<Pixel>::updateSettings()
+{
+	blurFactor     = settings.getBlurFactor();
+	scanlineFactor = settings.getScanlineFactor();
+}
+
 template <typename Pixel>
 void Simple3xScaler<Pixel>::doScale1(FrameSource& src,
 	unsigned srcStartY, unsigned /*srcEndY*/, unsigned srcWidth,
@@ -54,7 +62,6 @@ void Simple3xScaler<Pixel>::doScale1(FrameSource& src,
 	PolyLineScaler<Pixel>& scale)
 {
 	VLA_SSE_ALIGNED(Pixel, buf, srcWidth);
-	int scanlineFactor = settings.getScanlineFactor();
 	unsigned dstWidth = dst.getWidth();
 	unsigned y = dstStartY;
 	auto* srcLine = src.getLinePtr(srcStartY++, srcWidth, buf);
@@ -101,7 +108,6 @@ void Simple3xScaler<Pixel>::doScale2(FrameSource& src,
 	PolyLineScaler<Pixel>& scale)
 {
 	VLA_SSE_ALIGNED(Pixel, buf, srcWidth);
-	int scanlineFactor = settings.getScanlineFactor();
 	unsigned dstWidth = dst.getWidth();
 	for (unsigned srcY = srcStartY, dstY = dstStartY; dstY < dstEndY;
 	     srcY += 2, dstY += 3) {
@@ -146,7 +152,7 @@ void Simple3xScaler<Pixel>::scale1x1to3x3(FrameSource& src,
 		unsigned srcStartY, unsigned srcEndY, unsigned srcWidth,
 		ScalerOutput<Pixel>& dst, unsigned dstStartY, unsigned dstEndY)
 {
-	if (unsigned blur = settings.getBlurFactor() / 3) {
+	if (unsigned blur = blurFactor / 3) {
 		blur_1on3->setBlur(blur);
 		PolyScaleRef<Pixel, Blur_1on3<Pixel>> op(*blur_1on3);
 		doScale1(src, srcStartY, srcEndY, srcWidth,
@@ -247,7 +253,6 @@ void Simple3xScaler<Pixel>::scaleBlank1to3(
 		FrameSource& src, unsigned srcStartY, unsigned srcEndY,
 		ScalerOutput<Pixel>& dst, unsigned dstStartY, unsigned dstEndY)
 {
-	int scanlineFactor = settings.getScanlineFactor();
 
 	unsigned dstHeight = dst.getHeight();
 	unsigned stopDstY = (dstEndY == dstHeight)
@@ -274,7 +279,6 @@ void Simple3xScaler<Pixel>::scaleBlank2to3(
 		FrameSource& src, unsigned srcStartY, unsigned /*srcEndY*/,
 		ScalerOutput<Pixel>& dst, unsigned dstStartY, unsigned dstEndY)
 {
-	int scanlineFactor = settings.getScanlineFactor();
 	for (unsigned srcY = srcStartY, dstY = dstStartY;
 	     dstY < dstEndY; srcY += 2, dstY += 3) {
 		Pixel color0 = src.getLineColor<Pixel>(srcY + 0);
@@ -20,6 +20,8 @@ public:
 	               const RenderSettings& renderSettings);
 	~Simple3xScaler();
 
+	void updateSettings() override;
+
 private:
 	void scaleImage(FrameSource& src, const RawFrame* superImpose,
 		unsigned srcStartY, unsigned srcEndY, unsigned srcWidth,
@@ -83,6 +85,8 @@ private:
 	std::unique_ptr<Blur_1on3<Pixel>> blur_1on3;
 
 	const RenderSettings& settings;
+	int blurFactor;     // copied from 'settings' in updateSettings()
+	int scanlineFactor;
 };
 
 } // namespace openmsx
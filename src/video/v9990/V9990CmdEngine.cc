@@ -11,7 +11,12 @@
 #include "serialize.hh"
 #include "likely.hh"
 #include "unreachable.hh"
+#include <algorithm>
 #include <iostream>
+#include <cassert>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace openmsx {
 
@@ -585,6 +590,40 @@ inline void V9990CmdEngine::V9990Bpp8::psetColor(
 	vram.writeVRAMDirect(addr, result);
 }
 
+inline void V9990CmdEngine::V9990Bpp8::logOpSpan(
+	const byte* src, byte* dst, unsigned num,
+	byte mask, const byte* lut, byte op)
+{
+	if ((op & 0x0F) != 0x0C) {
+		for (unsigned i = 0; i < num; ++i) {
+			byte newColor = logOp(lut, src[i], dst[i]);
+			dst[i] = (dst[i] & ~mask) | (newColor & mask);
+		}
+		return;
+	}
+	// IMP and TIMP (by far the most common operations) don't need the
+	// lookup table: transparent (=zero) source pixels are simply masked.
+	bool transp = (op & 0x10) != 0;
+	unsigned i = 0;
+#ifdef __SSE2__
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i mask16 = _mm_set1_epi8(char(mask));
+	for (/**/; (i + 16) <= num; i += 16) {
+		auto* d16 = reinterpret_cast<__m128i*>(dst + i);
+		__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		__m128i d = _mm_loadu_si128(d16);
+		__m128i m = transp ? _mm_andnot_si128(_mm_cmpeq_epi8(s, zero), mask16)
+		                   : mask16;
+		_mm_storeu_si128(d16, _mm_or_si128(_mm_andnot_si128(m, d),
+		                                   _mm_and_si128(m, s)));
+	}
+#endif
+	for (/**/; i < num; ++i) {
+		byte m = (transp && (src[i] == 0)) ? 0 : mask;
+		dst[i] = (dst[i] & ~m) | (src[i] & m);
+	}
+}
+
 // 16 bpp -------------------------------------------------------------
 inline unsigned V9990CmdEngine::V9990Bpp16::getPitch(unsigned width)
 {
@@ -657,6 +696,62 @@ inline void V9990CmdEngine::V9990Bpp16::psetColor(
 	vram.writeVRAMDirect(addr + 0x40000, result >> 8);
 }
 
+inline void V9990CmdEngine::V9990Bpp16::logOpSpan(
+	const byte* srcLo, const byte* srcHi,
+	byte* dstLo, byte* dstHi, unsigned num,
+	word mask, const byte* lut, byte op)
+{
+	bool transp = (op & 0x10) != 0;
+	if ((op & 0x0F) != 0x0C) {
+		for (unsigned i = 0; i < num; ++i) {
+			word srcColor = srcLo[i] + srcHi[i] * 256;
+			word dstColor = dstLo[i] + dstHi[i] * 256;
+			word newColor = logOp(lut, srcColor, dstColor, transp);
+			word result = (dstColor & ~mask) | (newColor & mask);
+			dstLo[i] = result & 0xFF;
+			dstHi[i] = result >> 8;
+		}
+		return;
+	}
+	// IMP and TIMP, see V9990Bpp8::logOpSpan(). A pixel is only
+	// transparent when both its bytes are zero.
+	byte maskLo = mask & 0xFF;
+	byte maskHi = mask >> 8;
+	unsigned i = 0;
+#ifdef __SSE2__
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i maskLo16 = _mm_set1_epi8(char(maskLo));
+	const __m128i maskHi16 = _mm_set1_epi8(char(maskHi));
+	for (/**/; (i + 16) <= num; i += 16) {
+		auto* dLo16 = reinterpret_cast<__m128i*>(dstLo + i);
+		auto* dHi16 = reinterpret_cast<__m128i*>(dstHi + i);
+		__m128i sLo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcLo + i));
+		__m128i sHi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcHi + i));
+		__m128i dLo = _mm_loadu_si128(dLo16);
+		__m128i dHi = _mm_loadu_si128(dHi16);
+		__m128i mLo = maskLo16;
+		__m128i mHi = maskHi16;
+		if (transp) {
+			__m128i t = _mm_and_si128(_mm_cmpeq_epi8(sLo, zero),
+			                          _mm_cmpeq_epi8(sHi, zero));
+			mLo = _mm_andnot_si128(t, mLo);
+			mHi = _mm_andnot_si128(t, mHi);
+		}
+		_mm_storeu_si128(dLo16, _mm_or_si128(_mm_andnot_si128(mLo, dLo),
+		                                     _mm_and_si128(mLo, sLo)));
+		_mm_storeu_si128(dHi16, _mm_or_si128(_mm_andnot_si128(mHi, dHi),
+		                                     _mm_and_si128(mHi, sHi)));
+	}
+#endif
+	for (/**/; i < num; ++i) {
+		bool skip = transp && (srcLo[i] == 0) && (srcHi[i] == 0);
+		byte mLo = skip ? 0 : maskLo;
+		byte mHi = skip ? 0 : maskHi;
+		dstLo[i] = (dstLo[i] & ~mLo) | (srcLo[i] & mLo);
+		dstHi[i] = (dstHi[i] & ~mHi) | (srcHi[i] & mHi);
+	}
+}
+
 // ====================================================================
 /** Constructor
   */
@@ -927,6 +1022,100 @@ EmuDuration V9990CmdEngine::getTiming(const unsigned table[4][3][4]) const
 	return Clock<V9990DisplayTiming::UC_TICKS_PER_SECOND>::duration(x);
 }
 
+unsigned V9990CmdEngine::getStepsUntil(
+	EmuDuration::param delta, EmuTime::param limit) const
+{
+	// Number of iterations of
+	//    while (engineTime < limit) engineTime += delta;
+	assert(engineTime < limit);
+	if (delta == EmuDuration::zero) return unsigned(-1);
+	uint64_t remaining = (limit - engineTime).length();
+	uint64_t steps = (remaining + delta.length() - 1) / delta.length();
+	return unsigned(std::min<uint64_t>(steps, unsigned(-1)));
+}
+
+static inline bool spansOverlap(unsigned addr1, unsigned num1,
+                                unsigned addr2, unsigned num2)
+{
+	return (addr1 < (addr2 + num2)) && (addr2 < (addr1 + num1));
+}
+
+// Returns the (Bx-linear) VRAM address of a run of 'num' pixels starting at
+// (x, y), going left to right. Or -1 when the run can't be handled as a
+// single block: pixels smaller than a byte, or the run wraps around the end
+// of the line or the end of VRAM.
+template<typename Mode>
+int V9990CmdEngine::getSpanAddress(
+	unsigned x, unsigned y, unsigned pitch, unsigned num)
+{
+	if (Mode::BITS_PER_PIXEL < 8) return -1;
+	unsigned bytes = Mode::BITS_PER_PIXEL / 8;
+	unsigned px = x & (pitch - 1);
+	if ((px + num) > pitch) return -1;
+	unsigned addr = ((px + y * pitch) * bytes) & 0x7FFFF;
+	if ((addr + num * bytes) > 0x80000) return -1;
+	return addr;
+}
+
+// Same as calling Mode::pset() for 'num' pixels, with the source pixels
+// read from VRAM. Source and destination should either be identical or
+// not overlap at all.
+template<typename Mode>
+void V9990CmdEngine::copySpan(
+	unsigned src, unsigned dst, unsigned num, const byte* lut)
+{
+	byte* vramData = vram.getWriteBackdoor();
+	if (Mode::BITS_PER_PIXEL == 16) {
+		unsigned s = src / 2;
+		unsigned d = dst / 2;
+		V9990Bpp16::logOpSpan(vramData + s, vramData + s + 0x40000,
+		                      vramData + d, vramData + d + 0x40000,
+		                      num, WM, lut, LOG);
+	} else {
+		// Consecutive pixels alternate between the two VRAM banks, so
+		// handle the even and the odd pixels as two separate runs.
+		for (unsigned p = 0; p < 2; ++p) {
+			unsigned s = V9990VRAM::transformBx(src + p);
+			unsigned d = V9990VRAM::transformBx(dst + p);
+			byte mask = (d & 0x40000) ? (WM >> 8) : (WM & 0xFF);
+			V9990Bpp8::logOpSpan(vramData + s, vramData + d,
+			                     (num + 1 - p) / 2, mask, lut, LOG);
+		}
+	}
+}
+
+// Same as calling Mode::psetColor() for 'num' pixels.
+template<typename Mode>
+void V9990CmdEngine::colorSpan(
+	unsigned dst, unsigned num, const word* colors, const byte* lut)
+{
+	assert(num <= 2048);
+	byte* vramData = vram.getWriteBackdoor();
+	if (Mode::BITS_PER_PIXEL == 16) {
+		byte lo[2048], hi[2048];
+		for (unsigned i = 0; i < num; ++i) {
+			lo[i] = colors[i] & 0xFF;
+			hi[i] = colors[i] >> 8;
+		}
+		unsigned d = dst / 2;
+		V9990Bpp16::logOpSpan(lo, hi, vramData + d, vramData + d + 0x40000,
+		                      num, WM, lut, LOG);
+	} else {
+		byte buf[1024];
+		for (unsigned p = 0; p < 2; ++p) {
+			unsigned d = V9990VRAM::transformBx(dst + p);
+			bool high = (d & 0x40000) != 0;
+			unsigned n = (num + 1 - p) / 2;
+			for (unsigned i = 0; i < n; ++i) {
+				word color = colors[p + 2 * i];
+				buf[i] = high ? (color >> 8) : (color & 0xFF);
+			}
+			byte mask = high ? (WM >> 8) : (WM & 0xFF);
+			V9990Bpp8::logOpSpan(buf, vramData + d, n, mask, lut, LOG);
+		}
+	}
+}
+
 
 // STOP
 void V9990CmdEngine::startSTOP(EmuTime::param time)
@@ -1020,19 +1209,31 @@ void V9990CmdEngine::startLMMV(EmuTime::param time)
 template<typename Mode>
 void V9990CmdEngine::executeLMMV(EmuTime::param limit)
 {
-	// TODO can be optimized a lot
-
 	auto delta = getTiming(LMMV_TIMING);
 	unsigned pitch = Mode::getPitch(vdp.getImageWidth());
 	int dx = (ARG & DIX) ? -1 : 1;
 	int dy = (ARG & DIY) ? -1 : 1;
 	const byte* lut = Mode::getLogOpLUT(LOG);
 	while (engineTime < limit) {
-		engineTime += delta;
-		Mode::psetColor(vram, DX, DY, pitch, fgCol, WM, lut, LOG);
+		// Handle (the rest of) the current line in one go, but not
+		// further than the time limit allows.
+		unsigned num = std::min<unsigned>(ANX, getStepsUntil(delta, limit));
+		engineTime += delta * num;
+		int dst = (dx > 0) ? getSpanAddress<Mode>(DX, DY, pitch, num) : -1;
+		if (dst != -1) {
+			word colors[2048];
+			std::fill_n(colors, num, fgCol);
+			colorSpan<Mode>(dst, num, colors, lut);
+			DX += num;
+		} else {
+			for (unsigned i = 0; i < num; ++i) {
+				Mode::psetColor(vram, DX, DY, pitch, fgCol, WM, lut, LOG);
+				DX += dx;
+			}
+		}
 
-		DX += dx;
-		if (!--(ANX)) {
+		ANX -= num;
+		if (!ANX) {
 			DX -= (NX * dx);
 			DY += dy;
 			if (!--(ANY)) {
@@ -1112,22 +1313,35 @@ void V9990CmdEngine::startLMMM(EmuTime::param time)
 template<typename Mode>
 void V9990CmdEngine::executeLMMM(EmuTime::param limit)
 {
-	// TODO can be optimized a lot
-
 	auto delta = getTiming(LMMM_TIMING);
 	unsigned pitch = Mode::getPitch(vdp.getImageWidth());
 	int dx = (ARG & DIX) ? -1 : 1;
 	int dy = (ARG & DIY) ? -1 : 1;
 	const byte* lut = Mode::getLogOpLUT(LOG);
 	while (engineTime < limit) {
-		engineTime += delta;
-		auto src = Mode::point(vram, SX, SY, pitch);
-		src = Mode::shift(src, SX, DX);
-		Mode::pset(vram, DX, DY, pitch, src, WM, lut, LOG);
+		// See executeLMMV().
+		unsigned num = std::min<unsigned>(ANX, getStepsUntil(delta, limit));
+		engineTime += delta * num;
+		int src = (dx > 0) ? getSpanAddress<Mode>(SX, SY, pitch, num) : -1;
+		int dst = (dx > 0) ? getSpanAddress<Mode>(DX, DY, pitch, num) : -1;
+		unsigned bytes = num * Mode::BITS_PER_PIXEL / 8;
+		if ((src != -1) && (dst != -1) &&
+		    ((src == dst) || !spansOverlap(src, bytes, dst, bytes))) {
+			copySpan<Mode>(src, dst, num, lut);
+			DX += num;
+			SX += num;
+		} else {
+			for (unsigned i = 0; i < num; ++i) {
+				auto s = Mode::point(vram, SX, SY, pitch);
+				s = Mode::shift(s, SX, DX);
+				Mode::pset(vram, DX, DY, pitch, s, WM, lut, LOG);
+				DX += dx;
+				SX += dx;
+			}
+		}
 
-		DX += dx;
-		SX += dx;
-		if (!--(ANX)) {
+		ANX -= num;
+		if (!ANX) {
 			DX -= (NX * dx);
 			SX -= (NX * dx);
 			DY += dy;
@@ -1207,15 +1421,12 @@ void V9990CmdEngine::startCMMM(EmuTime::param time)
 template<typename Mode>
 void V9990CmdEngine::executeCMMM(EmuTime::param limit)
 {
-	// TODO can be optimized a lot
-
 	auto delta = getTiming(CMMM_TIMING);
 	unsigned pitch = Mode::getPitch(vdp.getImageWidth());
 	int dx = (ARG & DIX) ? -1 : 1;
 	int dy = (ARG & DIY) ? -1 : 1;
 	const byte* lut = Mode::getLogOpLUT(LOG);
-	while (engineTime < limit) {
-		engineTime += delta;
+	auto nextColor = [&]() -> word {
 		if (!bitsLeft) {
 			data = vram.readVRAMBx(srcAddress++);
 			bitsLeft = 8;
@@ -1223,12 +1434,41 @@ void V9990CmdEngine::executeCMMM(EmuTime::param limit)
 		--bitsLeft;
 		bool bit = (data & 0x80) != 0;
 		data <<= 1;
+		return bit ? fgCol : bgCol;
+	};
+	while (engineTime < limit) {
+		// See executeLMMV().
+		unsigned num = std::min<unsigned>(ANX, getStepsUntil(delta, limit));
+		engineTime += delta * num;
+		int dst = (dx > 0) ? getSpanAddress<Mode>(DX, DY, pitch, num) : -1;
+		if (dst != -1) {
+			// All character data for this run is fetched up front, so
+			// the run itself should not overwrite it.
+			unsigned nbRead = (num > bitsLeft) ? (num - bitsLeft + 7) / 8 : 0;
+			unsigned src = srcAddress & 0x7FFFF;
+			unsigned bytes = num * Mode::BITS_PER_PIXEL / 8;
+			if (((src + nbRead) > 0x80000) ||
+			    spansOverlap(src, nbRead, dst, bytes)) {
+				dst = -1;
+			}
+		}
+		if (dst != -1) {
+			word colors[2048];
+			for (unsigned i = 0; i < num; ++i) {
+				colors[i] = nextColor();
+			}
+			colorSpan<Mode>(dst, num, colors, lut);
+			DX += num;
+		} else {
+			for (unsigned i = 0; i < num; ++i) {
+				word color = nextColor();
+				Mode::psetColor(vram, DX, DY, pitch, color, WM, lut, LOG);
+				DX += dx;
+			}
+		}
 
-		word color = bit ? fgCol : bgCol;
-		Mode::psetColor(vram, DX, DY, pitch, color, WM, lut, LOG);
-
-		DX += dx;
-		if (!--(ANX)) {
+		ANX -= num;
+		if (!ANX) {
 			DX -= (NX * dx);
 			DY += dy;
 			if (!--(ANY)) {
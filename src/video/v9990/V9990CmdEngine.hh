@@ -182,6 +182,9 @@ private:
 		static inline void psetColor(
 			V9990VRAM& vram, unsigned x, unsigned y, unsigned pitch,
 			word color, word mask, const byte* lut, byte op);
+		static inline void logOpSpan(
+			const byte* src, byte* dst, unsigned num,
+			byte mask, const byte* lut, byte op);
 	};
 
 	class V9990Bpp16 {
@@ -203,6 +206,10 @@ private:
 		static inline void psetColor(
 			V9990VRAM& vram, unsigned x, unsigned y, unsigned pitch,
 			word color, word mask, const byte* lut, byte op);
+		static inline void logOpSpan(
+			const byte* srcLo, const byte* srcHi,
+			byte* dstLo, byte* dstHi, unsigned num,
+			word mask, const byte* lut, byte op);
 	};
 
 	void startSTOP  (EmuTime::param time);
@@ -242,6 +249,16 @@ private:
 	                        void executePSET (EmuTime::param limit);
 	                        void executeADVN (EmuTime::param limit);
 
+	/** Row based helpers for the LMMM, LMMV and CMMM commands. Only used
+	  * in 8bpp and 16bpp modes, for left-to-right runs of pixels.
+	  */
+	template<typename Mode> static int getSpanAddress(
+		unsigned x, unsigned y, unsigned pitch, unsigned num);
+	template<typename Mode> void copySpan(
+		unsigned src, unsigned dst, unsigned num, const byte* lut);
+	template<typename Mode> void colorSpan(
+		unsigned dst, unsigned num, const word* colors, const byte* lut);
+
 	RenderSettings& settings;
 
 	/** Only call reportV9990Command() when this setting is turned on
@@ -314,6 +331,7 @@ private:
 
 	void setCommandMode();
 	EmuDuration getTiming(const unsigned table[4][3][4]) const;
+	unsigned getStepsUntil(EmuDuration::param delta, EmuTime::param limit) const;
 
 	inline unsigned getWrappedNX() const {
 		return NX ? NX : 2048;
@@ -83,8 +83,10 @@ void V9990PixelRenderer::frameStart(EmuTime::param time)
 			if (rasterizer->isRecording()) {
 				drawFrame = true;
 			} else {
-				drawFrame = realTime.timeLeft(
-					unsigned(finishFrameDuration), time);
+				// Skip as many frames as the governor asks for,
+				// and more when we're still lagging behind.
+				drawFrame = (frameSkipCounter > int(realTime.getFrameSkip())) &&
+				             realTime.timeLeft(unsigned(finishFrameDuration), time);
 			}
 			if (drawFrame) {
 				frameSkipCounter = 0;